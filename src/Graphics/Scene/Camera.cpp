@@ -83,6 +83,7 @@ void Camera::overwriteViewMatrix(const glm::mat4 &viewMatrix) {
     modelMatrix = viewMatrix;
     viewProjMat = projMat * modelMatrix;
     inverseViewProjMat = glm::inverse(viewProjMat);
+    updateFrustumPlanes();
     recalcModelMat = false;
 
     glm::mat3 rotationMatrix(viewMatrix);
@@ -239,8 +240,7 @@ void Camera::updateCamera() {
     if (recalcFrustum || recalcModelMat) {
         viewProjMat = projMat * modelMatrix;
         inverseViewProjMat = glm::inverse(viewProjMat);
-    }
-    if (recalcFrustum) {
+        // The planes are extracted from the view projection matrix, so they also change with the view.
         updateFrustumPlanes();
     }
     recalcFrustum = recalcModelMat = false;
@@ -350,4 +350,12 @@ bool Camera::isVisible(const glm::vec3 &vert) const {
     return true;
 }
 
+void Camera::computeVisibilityMask(const AABB3Batch& aabbs, VisibilityMask& visibilityMask) const {
+    sgl::computeVisibilityMask(frustumPlanes, 6, aabbs, visibilityMask);
+}
+
+void Camera::computeVisibilityMask(const SphereBatch& spheres, VisibilityMask& visibilityMask) const {
+    sgl::computeVisibilityMask(frustumPlanes, 6, spheres, visibilityMask);
+}
+
 }
@@ -33,6 +33,7 @@
 #include <Math/Math.hpp>
 #include <Math/Geometry/AABB3.hpp>
 #include <Math/Geometry/Plane.hpp>
+#include <Math/Geometry/GeometryBatch.hpp>
 #include <Math/Geometry/AABB2.hpp>
 #include <Math/Geometry/Sphere.hpp>
 
@@ -131,10 +132,15 @@ public:
     }
 
     /// For frustum culling
+    /// The six frustum planes (near, far, left, right, bottom, top) in world space with normals pointing inwards.
+    inline const Plane* getFrustumPlanes() { updateCamera(); return frustumPlanes; }
     [[nodiscard]] virtual bool isVisible(const AABB3& bound) const;
     [[nodiscard]] virtual bool isVisible(const Sphere& bound) const;
     [[nodiscard]] virtual bool isVisible(const glm::vec2 &vert) const;
     [[nodiscard]] virtual bool isVisible(const glm::vec3 &vert) const;
+    /// Batched frustum culling; sets one bit per AABB/sphere (@see GeometryBatch.hpp).
+    void computeVisibilityMask(const AABB3Batch& aabbs, VisibilityMask& visibilityMask) const;
+    void computeVisibilityMask(const SphereBatch& spheres, VisibilityMask& visibilityMask) const;
 
     /// AABB of a slice of the view frustum in distance planeDistance
     AABB2 getAABB2(float planeDistance = -1.0f);
@@ -0,0 +1,240 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include <tracy/Tracy.hpp>
+
+#include <Math/Geometry/Plane.hpp>
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Parallel/RadixSort.hpp>
+#include "CullingBvh.hpp"
+
+namespace sgl {
+
+/// Inserts two zero bits after each of the lower 10 bits of the passed value.
+static inline uint32_t expandBitsMorton(uint32_t value) {
+    value = (value * 0x00010001u) & 0xFF0000FFu;
+    value = (value * 0x00000101u) & 0x0F00F00Fu;
+    value = (value * 0x00000011u) & 0xC30C30C3u;
+    value = (value * 0x00000005u) & 0x49249249u;
+    return value;
+}
+
+void CullingBvh::build(const std::vector<AABB3>& objectAabbs, uint32_t _maxLeafSize) {
+    ZoneScoped;
+
+    maxLeafSize = std::max(_maxLeafSize, 1u);
+    nodes.clear();
+    leafNodeIndices.clear();
+    const auto numObjects = uint32_t(objectAabbs.size());
+    objectIndices.resize(numObjects);
+    sortedObjectAabbs.resize(numObjects);
+    if (numObjects == 0) {
+        return;
+    }
+
+    AABB3 centerAabb;
+    for (const AABB3& aabb : objectAabbs) {
+        centerAabb.combine(aabb.getCenter());
+    }
+    glm::vec3 centerScale = centerAabb.getDimensions();
+    for (int i = 0; i < 3; i++) {
+        centerScale[i] = centerScale[i] > 0.0f ? 1023.0f / centerScale[i] : 0.0f;
+    }
+
+    std::vector<uint32_t> mortonCodes(numObjects);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, numObjects), [&](auto const& r) {
+        for (auto objectIdx = r.begin(); objectIdx != r.end(); objectIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numObjects, objectAabbs, centerAabb, centerScale, mortonCodes) default(none)
+#endif
+    for (uint32_t objectIdx = 0; objectIdx < numObjects; objectIdx++) {
+#endif
+        glm::vec3 gridPosition = (objectAabbs[objectIdx].getCenter() - centerAabb.min) * centerScale;
+        auto x = uint32_t(glm::clamp(gridPosition.x, 0.0f, 1023.0f));
+        auto y = uint32_t(glm::clamp(gridPosition.y, 0.0f, 1023.0f));
+        auto z = uint32_t(glm::clamp(gridPosition.z, 0.0f, 1023.0f));
+        mortonCodes[objectIdx] = (expandBitsMorton(x) << 2) | (expandBitsMorton(y) << 1) | expandBitsMorton(z);
+        objectIndices[objectIdx] = objectIdx;
+    }
+#ifdef USE_TBB
+    });
+#endif
+    radixSortKeyValuePairs(mortonCodes, objectIndices, 30);
+
+    nodes.reserve(2 * ((numObjects + maxLeafSize - 1) / maxLeafSize));
+    buildRecursive(mortonCodes, 0, numObjects);
+    refit(objectAabbs);
+}
+
+uint32_t CullingBvh::buildRecursive(const std::vector<uint32_t>& mortonCodes, uint32_t begin, uint32_t end) {
+    auto nodeIdx = uint32_t(nodes.size());
+    nodes.emplace_back();
+    nodes[nodeIdx].objectsBegin = begin;
+    nodes[nodeIdx].objectsEnd = end;
+    if (end - begin <= maxLeafSize) {
+        leafNodeIndices.push_back(nodeIdx);
+        return nodeIdx;
+    }
+
+    // Split at the highest bit in which the Morton codes of the range differ.
+    uint32_t split;
+    uint32_t firstCode = mortonCodes[begin];
+    uint32_t lastCode = mortonCodes[end - 1];
+    if (firstCode == lastCode) {
+        split = begin + (end - begin) / 2;
+    } else {
+        uint32_t highestBit = 31;
+        while (((firstCode ^ lastCode) >> highestBit) == 0) {
+            highestBit--;
+        }
+        const uint32_t bitMask = 1u << highestBit;
+        split = uint32_t(std::partition_point(
+                mortonCodes.begin() + begin, mortonCodes.begin() + end,
+                [bitMask](uint32_t code) { return (code & bitMask) == 0; }) - mortonCodes.begin());
+    }
+
+    buildRecursive(mortonCodes, begin, split);
+    uint32_t rightChildIdx = buildRecursive(mortonCodes, split, end);
+    nodes[nodeIdx].rightChildIdx = rightChildIdx;
+    return nodeIdx;
+}
+
+void CullingBvh::refit(const std::vector<AABB3>& objectAabbs) {
+    ZoneScoped;
+
+    const size_t numObjects = objectIndices.size();
+    if (objectAabbs.size() != numObjects) {
+        sgl::Logfile::get()->writeError(
+                "Error in CullingBvh::refit: The number of objects differs from the number used for building.");
+        return;
+    }
+
+    const size_t numLeafNodes = leafNodeIndices.size();
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numLeafNodes), [&](auto const& r) {
+        for (auto leafIdx = r.begin(); leafIdx != r.end(); leafIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numLeafNodes, objectAabbs) default(none)
+#endif
+    for (size_t leafIdx = 0; leafIdx < numLeafNodes; leafIdx++) {
+#endif
+        CullingBvhNode& node = nodes[leafNodeIndices[leafIdx]];
+        node.aabb = AABB3();
+        for (uint32_t i = node.objectsBegin; i < node.objectsEnd; i++) {
+            sortedObjectAabbs[i] = objectAabbs[objectIndices[i]];
+            node.aabb.combine(sortedObjectAabbs[i]);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    // Children are stored after their parents, so a reverse pass visits all children first.
+    for (size_t nodeIdx = nodes.size(); nodeIdx > 0; nodeIdx--) {
+        CullingBvhNode& node = nodes[nodeIdx - 1];
+        if (!node.isLeaf()) {
+            node.aabb = nodes[nodeIdx].aabb;
+            node.aabb.combine(nodes[node.rightChildIdx].aabb);
+        }
+    }
+}
+
+void CullingBvh::cullFrustum(const Plane* planes, int numPlanes, std::vector<uint32_t>& visibleObjects) const {
+    ZoneScoped;
+
+    if (nodes.empty()) {
+        return;
+    }
+    numPlanes = std::min(numPlanes, 32);
+
+    /*
+     * Returns the planes of planeMask the AABB is not completely inside of, or INVALID_PLANE_MASK if it is completely
+     * outside of one of the planes.
+     */
+    const uint64_t INVALID_PLANE_MASK = ~uint64_t(0);
+    auto testAabb = [&](const AABB3& aabb, uint32_t planeMask) {
+        glm::vec3 center = aabb.getCenter();
+        glm::vec3 extent = aabb.getExtent();
+        for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+            if ((planeMask & (1u << planeIdx)) == 0) {
+                continue;
+            }
+            const Plane& plane = planes[planeIdx];
+            float centerDist = plane.getDistance(center);
+            float radius = std::abs(plane.a) * extent.x + std::abs(plane.b) * extent.y + std::abs(plane.c) * extent.z;
+            if (centerDist + radius < 0.0f) {
+                return INVALID_PLANE_MASK;
+            }
+            if (centerDist - radius >= 0.0f) {
+                planeMask &= ~(1u << planeIdx);
+            }
+        }
+        return uint64_t(planeMask);
+    };
+
+    std::vector<std::pair<uint32_t, uint32_t>> nodeStack;
+    nodeStack.emplace_back(0, numPlanes == 32 ? ~0u : (1u << numPlanes) - 1u);
+    while (!nodeStack.empty()) {
+        auto [nodeIdx, parentPlaneMask] = nodeStack.back();
+        nodeStack.pop_back();
+        const CullingBvhNode& node = nodes[nodeIdx];
+        uint64_t planeMask = testAabb(node.aabb, parentPlaneMask);
+        if (planeMask == INVALID_PLANE_MASK) {
+            continue;
+        }
+        if (planeMask == 0) {
+            // The subtree is completely inside.
+            visibleObjects.insert(
+                    visibleObjects.end(), objectIndices.begin() + node.objectsBegin,
+                    objectIndices.begin() + node.objectsEnd);
+        } else if (node.isLeaf()) {
+            for (uint32_t i = node.objectsBegin; i < node.objectsEnd; i++) {
+                if (testAabb(sortedObjectAabbs[i], uint32_t(planeMask)) != INVALID_PLANE_MASK) {
+                    visibleObjects.push_back(objectIndices[i]);
+                }
+            }
+        } else {
+            // Push the right child first so that the objects are output in the order of the hierarchy.
+            nodeStack.emplace_back(node.rightChildIdx, uint32_t(planeMask));
+            nodeStack.emplace_back(nodeIdx + 1, uint32_t(planeMask));
+        }
+    }
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_CULLINGBVH_HPP
+#define SGL_CULLINGBVH_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <Math/Geometry/AABB3.hpp>
+
+namespace sgl {
+
+class Plane;
+
+/**
+ * A node of @see CullingBvh. The nodes are stored in depth-first order, i.e., the left child of an inner node
+ * directly follows its parent, and all nodes of a subtree reference a contiguous range of objects.
+ */
+struct DLL_OBJECT CullingBvhNode {
+    AABB3 aabb;
+    /// The range of the objects in the subtree in @see CullingBvh::getObjectIndices.
+    uint32_t objectsBegin = 0, objectsEnd = 0;
+    /// Index of the right child. The left child is the next node. 0 for leaf nodes.
+    uint32_t rightChildIdx = 0;
+
+    [[nodiscard]] inline bool isLeaf() const { return rightChildIdx == 0; }
+};
+
+/**
+ * A bounding volume hierarchy over the AABBs of the objects of a scene for hierarchical frustum culling.
+ * The hierarchy is built from the Morton codes of the AABB centers (LBVH). If the objects move only moderately,
+ * the topology can be kept and only the bounding boxes refitted (@see refit), which is much cheaper than a rebuild.
+ */
+class DLL_OBJECT CullingBvh {
+public:
+    /**
+     * Builds the hierarchy.
+     * @param objectAabbs The world space AABBs of the objects.
+     * @param maxLeafSize The maximum number of objects per leaf node.
+     */
+    void build(const std::vector<AABB3>& objectAabbs, uint32_t maxLeafSize = 4);
+    /**
+     * Updates the bounding boxes of all nodes without changing the topology of the hierarchy. The number of objects
+     * must be the same as when calling @see build. The leaf nodes are refitted in parallel.
+     */
+    void refit(const std::vector<AABB3>& objectAabbs);
+
+    /**
+     * Appends the indices of all objects intersecting the space on the positive side of all planes to visibleObjects.
+     * Planes that contain a node completely are not tested for its subtree anymore, and subtrees completely inside
+     * are appended without testing the individual objects. The output is in the order of the hierarchy.
+     * @param planes The planes to test against, e.g., @see Camera::getFrustumPlanes. At most 32 planes are supported.
+     * @param numPlanes The number of planes (usually 6).
+     * @param visibleObjects The list to append the indices of the visible objects to.
+     */
+    void cullFrustum(const Plane* planes, int numPlanes, std::vector<uint32_t>& visibleObjects) const;
+
+    [[nodiscard]] inline size_t getNumObjects() const { return objectIndices.size(); }
+    [[nodiscard]] inline const std::vector<CullingBvhNode>& getNodes() const { return nodes; }
+    /// The object indices in the order of the hierarchy.
+    [[nodiscard]] inline const std::vector<uint32_t>& getObjectIndices() const { return objectIndices; }
+    /// The object AABBs in the order of the hierarchy.
+    [[nodiscard]] inline const std::vector<AABB3>& getSortedObjectAabbs() const { return sortedObjectAabbs; }
+
+private:
+    uint32_t buildRecursive(const std::vector<uint32_t>& mortonCodes, uint32_t begin, uint32_t end);
+
+    uint32_t maxLeafSize = 4;
+    std::vector<CullingBvhNode> nodes;
+    std::vector<uint32_t> leafNodeIndices;
+    std::vector<uint32_t> objectIndices;
+    std::vector<AABB3> sortedObjectAabbs;
+};
+
+}
+
+#endif //SGL_CULLINGBVH_HPP
@@ -0,0 +1,325 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SGL_OCCLUSION_BUFFER_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SGL_OCCLUSION_BUFFER_NEON
+#endif
+
+#include <tracy/Tracy.hpp>
+
+#include <Math/Geometry/AABB3.hpp>
+#include "OcclusionBuffer.hpp"
+
+namespace sgl {
+
+/// Vertices with a smaller clip space w coordinate are considered to be behind the camera.
+static const float MIN_CLIP_W = 1e-5f;
+
+OcclusionBuffer::OcclusionBuffer(int width, int height) {
+    resize(width, height);
+}
+
+void OcclusionBuffer::resize(int _width, int _height) {
+    width = std::max(_width, 1);
+    height = std::max(_height, 1);
+    rowPitch = (width + 3) / 4 * 4;
+    depthBuffer.resize(size_t(rowPitch) * size_t(height));
+    std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+}
+
+void OcclusionBuffer::clear(const glm::mat4& _viewProjectionMatrix, bool _isDepthRangeZeroOne) {
+    viewProjectionMatrix = _viewProjectionMatrix;
+    isDepthRangeZeroOne = _isDepthRangeZeroOne;
+    std::fill(depthBuffer.begin(), depthBuffer.end(), FLT_MAX);
+}
+
+void OcclusionBuffer::rasterizeOccluder(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const glm::mat4& modelMatrix) {
+    ZoneScoped;
+
+    // Transform the vertices to screen space once. A screen space w of -1 marks vertices in front of the near plane,
+    // which lies at z = 0 in clip space for the [0, 1] depth range and at z = -w for the [-1, 1] depth range.
+    const glm::mat4 modelViewProjectionMatrix = viewProjectionMatrix * modelMatrix;
+    const auto widthFloat = float(width);
+    const auto heightFloat = float(height);
+    std::vector<glm::vec4> screenPositions(vertexPositions.size());
+    for (size_t vertexIdx = 0; vertexIdx < vertexPositions.size(); vertexIdx++) {
+        const glm::vec3& p = vertexPositions[vertexIdx];
+        glm::vec4 clipPosition = modelViewProjectionMatrix * glm::vec4(p.x, p.y, p.z, 1.0f);
+        float nearClipZ = isDepthRangeZeroOne ? 0.0f : -clipPosition.w;
+        if (clipPosition.w < MIN_CLIP_W || clipPosition.z < nearClipZ) {
+            screenPositions[vertexIdx] = glm::vec4(0.0f, 0.0f, 0.0f, -1.0f);
+            continue;
+        }
+        float invW = 1.0f / clipPosition.w;
+        screenPositions[vertexIdx] = glm::vec4(
+                (clipPosition.x * invW * 0.5f + 0.5f) * widthFloat,
+                (clipPosition.y * invW * 0.5f + 0.5f) * heightFloat,
+                clipPosition.z * invW, 1.0f);
+    }
+
+    const size_t numIndices = triangleIndices.size() - triangleIndices.size() % 3;
+    for (size_t i = 0; i < numIndices; i += 3) {
+        uint32_t i0 = triangleIndices[i], i1 = triangleIndices[i + 1], i2 = triangleIndices[i + 2];
+        if (i0 >= screenPositions.size() || i1 >= screenPositions.size() || i2 >= screenPositions.size()) {
+            continue;
+        }
+        const glm::vec4& v0 = screenPositions[i0];
+        const glm::vec4& v1 = screenPositions[i1];
+        const glm::vec4& v2 = screenPositions[i2];
+        if (v0.w < 0.0f || v1.w < 0.0f || v2.w < 0.0f) {
+            continue;
+        }
+        rasterizeTriangle(glm::vec3(v0.x, v0.y, v0.z), glm::vec3(v1.x, v1.y, v1.z), glm::vec3(v2.x, v2.y, v2.z));
+    }
+}
+
+void OcclusionBuffer::rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1In, const glm::vec3& v2In) {
+    // Use a counter-clockwise winding (in a y-up coordinate system) for both faces.
+    float area = (v1In.x - v0.x) * (v2In.y - v0.y) - (v1In.y - v0.y) * (v2In.x - v0.x);
+    if (!(std::abs(area) > 0.0f)) {
+        return;
+    }
+    const glm::vec3& v1 = area > 0.0f ? v1In : v2In;
+    const glm::vec3& v2 = area > 0.0f ? v2In : v1In;
+    area = std::abs(area);
+
+    // Range of the pixels whose centers lie in the bounding box of the triangle.
+    float minX = std::min(v0.x, std::min(v1.x, v2.x));
+    float maxX = std::max(v0.x, std::max(v1.x, v2.x));
+    float minY = std::min(v0.y, std::min(v1.y, v2.y));
+    float maxY = std::max(v0.y, std::max(v1.y, v2.y));
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX <= float(width) && minY <= float(height))) {
+        return;
+    }
+    // Vertices close to the camera plane may be projected far outside of the buffer; keep the int conversion defined.
+    minX = std::max(minX, -1.0f);
+    maxX = std::min(maxX, float(width) + 1.0f);
+    minY = std::max(minY, -1.0f);
+    maxY = std::min(maxY, float(height) + 1.0f);
+    int startX = std::max(int(std::ceil(minX - 0.5f)), 0);
+    int endX = std::min(int(std::floor(maxX - 0.5f)), width - 1);
+    int startY = std::max(int(std::ceil(minY - 0.5f)), 0);
+    int endY = std::min(int(std::floor(maxY - 0.5f)), height - 1);
+    if (startX > endX || startY > endY) {
+        return;
+    }
+
+    // Edge functions e(x, y) = a * x + b * y + c, which are non-negative inside of the triangle.
+    auto computeEdge = [](const glm::vec3& p0, const glm::vec3& p1, float& a, float& b, float& c) {
+        a = p0.y - p1.y;
+        b = p1.x - p0.x;
+        c = -a * p0.x - b * p0.y;
+    };
+    float a0, b0, c0, a1, b1, c1, a2, b2, c2;
+    computeEdge(v1, v2, a0, b0, c0);
+    computeEdge(v2, v0, a1, b1, c1);
+    computeEdge(v0, v1, a2, b2, c2);
+
+    // The depth is interpolated linearly in screen space using the barycentric coordinates.
+    float invArea = 1.0f / area;
+    float dzdx = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * invArea;
+    float dzdy = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * invArea;
+    float z00 = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * invArea;
+
+#if defined(SGL_OCCLUSION_BUFFER_SSE) || defined(SGL_OCCLUSION_BUFFER_NEON)
+    // Process aligned groups of four pixels. Lanes outside of [startX, endX] are masked out.
+    const int alignedStartX = startX / 4 * 4;
+    const float laneOffsetsArray[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+#endif
+#if defined(SGL_OCCLUSION_BUFFER_SSE)
+    const __m128 laneOffsets = _mm_loadu_ps(laneOffsetsArray);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 minPixelX = _mm_set1_ps(float(startX));
+    const __m128 maxPixelX = _mm_set1_ps(float(endX) + 1.0f);
+    for (int y = startY; y <= endY; y++) {
+        float py = float(y) + 0.5f;
+        float* row = depthBuffer.data() + size_t(y) * size_t(rowPitch);
+        for (int x = alignedStartX; x <= endX; x += 4) {
+            __m128 px = _mm_add_ps(_mm_set1_ps(float(x)), laneOffsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a0), px), _mm_set1_ps(b0 * py + c0));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a1), px), _mm_set1_ps(b1 * py + c1));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(a2), px), _mm_set1_ps(b2 * py + c2));
+            __m128 isInside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero));
+            isInside = _mm_and_ps(isInside, _mm_cmpge_ps(e2, zero));
+            isInside = _mm_and_ps(isInside, _mm_and_ps(_mm_cmpgt_ps(px, minPixelX), _mm_cmplt_ps(px, maxPixelX)));
+            if (_mm_movemask_ps(isInside) == 0) {
+                continue;
+            }
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dzdx), px), _mm_set1_ps(dzdy * py + z00));
+            __m128 depthOld = _mm_loadu_ps(row + x);
+            __m128 depthNew = _mm_min_ps(depthOld, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(isInside, depthNew), _mm_andnot_ps(isInside, depthOld)));
+        }
+    }
+#elif defined(SGL_OCCLUSION_BUFFER_NEON)
+    const float32x4_t laneOffsets = vld1q_f32(laneOffsetsArray);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t minPixelX = vdupq_n_f32(float(startX));
+    const float32x4_t maxPixelX = vdupq_n_f32(float(endX) + 1.0f);
+    for (int y = startY; y <= endY; y++) {
+        float py = float(y) + 0.5f;
+        float* row = depthBuffer.data() + size_t(y) * size_t(rowPitch);
+        for (int x = alignedStartX; x <= endX; x += 4) {
+            float32x4_t px = vaddq_f32(vdupq_n_f32(float(x)), laneOffsets);
+            float32x4_t e0 = vmlaq_f32(vdupq_n_f32(b0 * py + c0), vdupq_n_f32(a0), px);
+            float32x4_t e1 = vmlaq_f32(vdupq_n_f32(b1 * py + c1), vdupq_n_f32(a1), px);
+            float32x4_t e2 = vmlaq_f32(vdupq_n_f32(b2 * py + c2), vdupq_n_f32(a2), px);
+            uint32x4_t isInside = vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero));
+            isInside = vandq_u32(isInside, vcgeq_f32(e2, zero));
+            isInside = vandq_u32(isInside, vandq_u32(vcgtq_f32(px, minPixelX), vcltq_f32(px, maxPixelX)));
+            float32x4_t z = vmlaq_f32(vdupq_n_f32(dzdy * py + z00), vdupq_n_f32(dzdx), px);
+            float32x4_t depthOld = vld1q_f32(row + x);
+            vst1q_f32(row + x, vbslq_f32(isInside, vminq_f32(depthOld, z), depthOld));
+        }
+    }
+#else
+    for (int y = startY; y <= endY; y++) {
+        float py = float(y) + 0.5f;
+        float* row = depthBuffer.data() + size_t(y) * size_t(rowPitch);
+        for (int x = startX; x <= endX; x++) {
+            float px = float(x) + 0.5f;
+            if (a0 * px + b0 * py + c0 >= 0.0f && a1 * px + b1 * py + c1 >= 0.0f && a2 * px + b2 * py + c2 >= 0.0f) {
+                row[x] = std::min(row[x], dzdx * px + dzdy * py + z00);
+            }
+        }
+    }
+#endif
+}
+
+bool OcclusionBuffer::isOccluded(const AABB3& aabb) const {
+    // Compute the screen space rectangle and nearest depth of the AABB.
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+    float minDepth = FLT_MAX;
+    for (int cornerIdx = 0; cornerIdx < 8; cornerIdx++) {
+        glm::vec4 corner(
+                (cornerIdx & 1) ? aabb.max.x : aabb.min.x,
+                (cornerIdx & 2) ? aabb.max.y : aabb.min.y,
+                (cornerIdx & 4) ? aabb.max.z : aabb.min.z, 1.0f);
+        glm::vec4 clipPosition = viewProjectionMatrix * corner;
+        if (clipPosition.w < MIN_CLIP_W) {
+            // The box intersects the near plane or is behind the camera.
+            return false;
+        }
+        float invW = 1.0f / clipPosition.w;
+        float x = (clipPosition.x * invW * 0.5f + 0.5f) * float(width);
+        float y = (clipPosition.y * invW * 0.5f + 0.5f) * float(height);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minDepth = std::min(minDepth, clipPosition.z * invW);
+    }
+    if (!(maxX >= 0.0f && maxY >= 0.0f && minX <= float(width) && minY <= float(height))) {
+        // Not on screen; this is left to frustum culling.
+        return false;
+    }
+
+    // The box is occluded if the occluders are nearer at all pixels it overlaps.
+    minX = std::max(minX, -1.0f);
+    maxX = std::min(maxX, float(width) + 1.0f);
+    minY = std::max(minY, -1.0f);
+    maxY = std::min(maxY, float(height) + 1.0f);
+    int startX = std::max(int(std::floor(minX)), 0);
+    int endX = std::min(int(std::floor(maxX)), width - 1);
+    int startY = std::max(int(std::floor(minY)), 0);
+    int endY = std::min(int(std::floor(maxY)), height - 1);
+    for (int y = startY; y <= endY; y++) {
+        const float* row = depthBuffer.data() + size_t(y) * size_t(rowPitch);
+        int x = startX;
+#if defined(SGL_OCCLUSION_BUFFER_SSE)
+        const __m128 minDepthVec = _mm_set1_ps(minDepth);
+        for (; x + 3 <= endX; x += 4) {
+            if (_mm_movemask_ps(_mm_cmple_ps(minDepthVec, _mm_loadu_ps(row + x))) != 0) {
+                return false;
+            }
+        }
+#elif defined(SGL_OCCLUSION_BUFFER_NEON)
+        const float32x4_t minDepthVec = vdupq_n_f32(minDepth);
+        for (; x + 3 <= endX; x += 4) {
+            uint32x4_t isVisible = vcleq_f32(minDepthVec, vld1q_f32(row + x));
+            uint32x2_t isVisibleHalf = vorr_u32(vget_low_u32(isVisible), vget_high_u32(isVisible));
+            if ((vget_lane_u32(isVisibleHalf, 0) | vget_lane_u32(isVisibleHalf, 1)) != 0) {
+                return false;
+            }
+        }
+#endif
+        for (; x <= endX; x++) {
+            if (minDepth <= row[x]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void OcclusionBuffer::removeOccludedObjects(
+        const std::vector<AABB3>& objectAabbs, std::vector<uint32_t>& objectIndices) const {
+    ZoneScoped;
+
+    const size_t numObjects = objectIndices.size();
+    std::vector<uint8_t> isObjectOccluded(numObjects);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numObjects), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numObjects, objectAabbs, objectIndices, isObjectOccluded) default(none)
+#endif
+    for (size_t i = 0; i < numObjects; i++) {
+#endif
+        isObjectOccluded[i] = isOccluded(objectAabbs[objectIndices[i]]) ? 1 : 0;
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    size_t writeIdx = 0;
+    for (size_t i = 0; i < numObjects; i++) {
+        if (!isObjectOccluded[i]) {
+            objectIndices[writeIdx++] = objectIndices[i];
+        }
+    }
+    objectIndices.resize(writeIdx);
+}
+
+}
@@ -0,0 +1,104 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_OCCLUSIONBUFFER_HPP
+#define SGL_OCCLUSIONBUFFER_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace sgl {
+
+class AABB3;
+
+/**
+ * A low-resolution software depth buffer for occlusion culling on the CPU.
+ * Usage: Call @see clear with the view projection matrix of the camera each frame, rasterize a few large occluders
+ * (e.g., simplified walls or terrain) using @see rasterizeOccluder, and finally test the bounding boxes of the
+ * potentially visible objects using @see isOccluded or @see removeOccludedObjects.
+ *
+ * The buffer stores the nearest NDC depth (z / w) per pixel, which is monotonic with the distance for both the
+ * [-1, 1] and [0, 1] depth ranges. Occluder triangles are sampled at the pixel centers and are not clipped, so
+ * triangles with a vertex in front of the near plane (z < 0 or z < -w in clip space, depending on the depth range) are
+ * skipped. Rows are rasterized four pixels at a time using SSE or NEON.
+ * As the test is sampled at low resolution, it is approximate at the silhouettes of the occluders.
+ */
+class DLL_OBJECT OcclusionBuffer {
+public:
+    explicit OcclusionBuffer(int width = 256, int height = 128);
+    void resize(int width, int height);
+    [[nodiscard]] inline int getWidth() const { return width; }
+    [[nodiscard]] inline int getHeight() const { return height; }
+
+    /**
+     * Resets all pixels to the far depth and sets the view projection matrix used for the following operations.
+     * @param viewProjectionMatrix The view projection matrix of the camera.
+     * @param isDepthRangeZeroOne Whether the projection matrix maps to the [0, 1] depth range (i.e.,
+     * Camera::DepthRange::ZERO_ONE) instead of [-1, 1]. This determines the near plane in clip space.
+     */
+    void clear(const glm::mat4& viewProjectionMatrix, bool isDepthRangeZeroOne = false);
+
+    /**
+     * Rasterizes the triangles of an occluder into the depth buffer. Both faces of the triangles are rasterized.
+     * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+     * @param vertexPositions The vertex positions.
+     * @param modelMatrix The model matrix of the occluder.
+     */
+    void rasterizeOccluder(
+            const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+            const glm::mat4& modelMatrix = glm::mat4(1.0f));
+
+    /// Returns whether the passed world space AABB is completely hidden behind the rasterized occluders.
+    [[nodiscard]] bool isOccluded(const AABB3& aabb) const;
+
+    /**
+     * Removes all objects hidden behind the rasterized occluders from the list of objects. The tests run in parallel.
+     * @param objectAabbs The world space AABBs of all objects.
+     * @param objectIndices The indices of the objects to test (e.g., the result of frustum culling).
+     */
+    void removeOccludedObjects(const std::vector<AABB3>& objectAabbs, std::vector<uint32_t>& objectIndices) const;
+
+    /// The depth values; row y starts at y * getRowPitch().
+    [[nodiscard]] inline const std::vector<float>& getDepthBuffer() const { return depthBuffer; }
+    [[nodiscard]] inline int getRowPitch() const { return rowPitch; }
+
+private:
+    void rasterizeTriangle(const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2);
+
+    int width = 0, height = 0;
+    int rowPitch = 0; ///< The width rounded up to a multiple of four for the SIMD code path.
+    glm::mat4 viewProjectionMatrix{1.0f};
+    bool isDepthRangeZeroOne = false;
+    std::vector<float> depthBuffer;
+};
+
+}
+
+#endif //SGL_OCCLUSIONBUFFER_HPP
@@ -0,0 +1,85 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <numeric>
+
+#include <tracy/Tracy.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Parallel/RadixSort.hpp>
+#include "Camera.hpp"
+#include "SceneCuller.hpp"
+
+namespace sgl {
+
+void SceneCuller::setObjectAabbs(const std::vector<AABB3>& aabbs, uint32_t maxLeafSize) {
+    objectAabbs = aabbs;
+    bvh.build(objectAabbs, maxLeafSize);
+}
+
+void SceneCuller::updateObjectAabbs(const std::vector<AABB3>& aabbs) {
+    // The hierarchy refers to the objects by their indices, so the state is left unchanged on a size mismatch.
+    if (aabbs.size() != objectAabbs.size()) {
+        sgl::Logfile::get()->writeError(
+                "Error in SceneCuller::updateObjectAabbs: The number of objects differs from the number used for "
+                "building. Please call setObjectAabbs instead.", false);
+        return;
+    }
+    objectAabbs = aabbs;
+    bvh.refit(objectAabbs);
+}
+
+void SceneCuller::beginFrame(const CameraPtr& camera) {
+    if (settings.useOcclusionCulling) {
+        occlusionBuffer.clear(
+                camera->getViewProjMatrix(), Camera::getDepthRange() == Camera::DepthRange::ZERO_ONE);
+    }
+}
+
+void SceneCuller::cull(const CameraPtr& camera, std::vector<uint32_t>& visibleObjects) {
+    ZoneScoped;
+
+    visibleObjects.clear();
+    if (settings.useFrustumCulling) {
+        bvh.cullFrustum(camera->getFrustumPlanes(), 6, visibleObjects);
+        // Sort by the object index for a deterministic draw order.
+        int numObjectBits = 1;
+        while (numObjectBits < 32 && (size_t(1) << numObjectBits) < objectAabbs.size()) {
+            numObjectBits++;
+        }
+        radixSortKeys(visibleObjects, numObjectBits);
+    } else {
+        visibleObjects.resize(objectAabbs.size());
+        std::iota(visibleObjects.begin(), visibleObjects.end(), 0);
+    }
+    if (settings.useOcclusionCulling) {
+        occlusionBuffer.removeOccludedObjects(objectAabbs, visibleObjects);
+    }
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_SCENECULLER_HPP
+#define SGL_SCENECULLER_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "CullingBvh.hpp"
+#include "OcclusionBuffer.hpp"
+
+namespace sgl {
+
+class Camera;
+typedef std::shared_ptr<Camera> CameraPtr;
+
+struct DLL_OBJECT SceneCullingSettings {
+    bool useFrustumCulling = true;
+    /// Requires the occluders to be rasterized into @see SceneCuller::getOcclusionBuffer before calling cull.
+    bool useOcclusionCulling = false;
+};
+
+/**
+ * Computes the list of visible objects of a scene per frame. The objects are only represented by their world space
+ * AABBs. They are culled hierarchically against the camera frustum using a @see CullingBvh, and optionally against
+ * a software depth buffer of occluders (@see OcclusionBuffer).
+ *
+ * Per frame usage:
+ * - updateObjectAabbs (if objects moved).
+ * - beginFrame(camera), followed by getOcclusionBuffer().rasterizeOccluder(...) for all occluders.
+ * - cull(camera, visibleObjects); the result can be converted to draw commands (@see sgl::vk::IndirectDrawBuffer).
+ */
+class DLL_OBJECT SceneCuller {
+public:
+    explicit SceneCuller(SceneCullingSettings settings = {}) : settings(settings) {}
+    inline void setSettings(const SceneCullingSettings& _settings) { settings = _settings; }
+    [[nodiscard]] inline const SceneCullingSettings& getSettings() const { return settings; }
+
+    /// Sets the world space AABBs of all objects and rebuilds the hierarchy.
+    void setObjectAabbs(const std::vector<AABB3>& aabbs, uint32_t maxLeafSize = 4);
+    /**
+     * Updates the world space AABBs of the objects after they moved. The number of objects must not change; otherwise,
+     * an error is logged and the AABBs are left unchanged.
+     * The hierarchy is only refitted, so @see setObjectAabbs should be called again after large movements.
+     */
+    void updateObjectAabbs(const std::vector<AABB3>& aabbs);
+    [[nodiscard]] inline const std::vector<AABB3>& getObjectAabbs() const { return objectAabbs; }
+    [[nodiscard]] inline size_t getNumObjects() const { return objectAabbs.size(); }
+
+    /// Clears the occlusion buffer with the view projection matrix of the camera (if occlusion culling is used).
+    void beginFrame(const CameraPtr& camera);
+    [[nodiscard]] inline OcclusionBuffer& getOcclusionBuffer() { return occlusionBuffer; }
+
+    /**
+     * Computes the indices of the visible objects in ascending order.
+     * @param camera The camera to use for frustum culling.
+     * @param visibleObjects The output list of visible objects (the old content is cleared).
+     */
+    void cull(const CameraPtr& camera, std::vector<uint32_t>& visibleObjects);
+
+private:
+    SceneCullingSettings settings;
+    std::vector<AABB3> objectAabbs;
+    CullingBvh bvh;
+    OcclusionBuffer occlusionBuffer;
+};
+
+}
+
+#endif //SGL_SCENECULLER_HPP
@@ -61,7 +61,7 @@ ComputePipeline::ComputePipeline(Device* device, const ComputePipelineInfo& pipe
     pipelineCreateInfo.basePipelineIndex = -1;
 
     if (vkCreateComputePipelines(
-            device->getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo,
+            device->getVkDevice(), device->getVkPipelineCache(), 1, &pipelineCreateInfo,
             nullptr, &pipeline) != VK_SUCCESS) {
         Logfile::get()->throwError(
                 "Error in ComputePipeline::ComputePipeline: Could not create a Compute pipeline.");
@@ -470,7 +470,7 @@ GraphicsPipeline::GraphicsPipeline(Device* device, const GraphicsPipelineInfo& p
     pipelineCreateInfo.basePipelineIndex = -1;
 
     if (vkCreateGraphicsPipelines(
-            device->getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCreateInfo,
+            device->getVkDevice(), device->getVkPipelineCache(), 1, &pipelineCreateInfo,
             nullptr, &pipeline) != VK_SUCCESS) {
         Logfile::get()->throwError(
                 "Error in GraphicsPipeline::GraphicsPipeline: Could not create a graphics pipeline.");
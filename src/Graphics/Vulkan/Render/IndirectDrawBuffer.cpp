@@ -0,0 +1,89 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include <Utils/File/Logfile.hpp>
+#include <Graphics/Vulkan/Utils/Device.hpp>
+#include <Graphics/Vulkan/Buffers/Buffer.hpp>
+
+#include "Data.hpp"
+#include "IndirectDrawBuffer.hpp"
+
+namespace sgl { namespace vk {
+
+IndirectDrawBuffer::IndirectDrawBuffer(
+        Device* device, const std::vector<VkDrawIndexedIndirectCommand>& objectDrawCommands)
+        : stride(uint32_t(sizeof(VkDrawIndexedIndirectCommand))), numObjects(uint32_t(objectDrawCommands.size())) {
+    createBuffer(device, objectDrawCommands.data());
+}
+
+IndirectDrawBuffer::IndirectDrawBuffer(
+        Device* device, const std::vector<VkDrawIndirectCommand>& objectDrawCommands)
+        : stride(uint32_t(sizeof(VkDrawIndirectCommand))), numObjects(uint32_t(objectDrawCommands.size())) {
+    createBuffer(device, objectDrawCommands.data());
+}
+
+void IndirectDrawBuffer::createBuffer(Device* device, const void* commandsData) {
+    objectDrawCommandsData.resize(size_t(numObjects) * size_t(stride));
+    if (numObjects > 0) {
+        memcpy(objectDrawCommandsData.data(), commandsData, objectDrawCommandsData.size());
+    }
+    // At most all objects are visible. Vulkan does not allow buffers of size zero.
+    indirectDrawBuffer = std::make_shared<Buffer>(
+            device, std::max(objectDrawCommandsData.size(), size_t(stride)),
+            VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU);
+}
+
+void IndirectDrawBuffer::update(const std::vector<uint32_t>& visibleObjects) {
+    if (visibleObjects.size() > numObjects) {
+        sgl::Logfile::get()->writeError(
+                "Error in IndirectDrawBuffer::update: More visible objects than objects were passed.");
+        return;
+    }
+    drawCount = 0;
+    auto* commandsMapped = reinterpret_cast<uint8_t*>(indirectDrawBuffer->mapMemory());
+    for (uint32_t objectIdx : visibleObjects) {
+        if (objectIdx >= numObjects) {
+            continue;
+        }
+        memcpy(
+                commandsMapped + size_t(drawCount) * size_t(stride),
+                objectDrawCommandsData.data() + size_t(objectIdx) * size_t(stride), stride);
+        drawCount++;
+    }
+    indirectDrawBuffer->unmapMemory();
+}
+
+void IndirectDrawBuffer::setRasterData(const RasterDataPtr& rasterData) {
+    rasterData->setIndirectDrawBuffer(indirectDrawBuffer, stride);
+    rasterData->setIndirectDrawCount(drawCount);
+}
+
+}}
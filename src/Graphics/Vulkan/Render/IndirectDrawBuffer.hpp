@@ -0,0 +1,87 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_INDIRECTDRAWBUFFER_HPP
+#define SGL_INDIRECTDRAWBUFFER_HPP
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "../libs/volk/volk.h"
+
+namespace sgl { namespace vk {
+
+class Device;
+class Buffer;
+typedef std::shared_ptr<Buffer> BufferPtr;
+class RasterData;
+typedef std::shared_ptr<RasterData> RasterDataPtr;
+
+/**
+ * Converts per-frame lists of visible objects (e.g., computed by sgl::SceneCuller) to indirect draw commands.
+ * Every object has one draw command, and the commands of the visible objects are written to a host-visible indirect
+ * draw buffer. The object index can be passed to the shaders by storing it in firstInstance (gl_InstanceIndex).
+ * As the buffer is written by the CPU, one IndirectDrawBuffer should be used per frame in flight.
+ */
+class DLL_OBJECT IndirectDrawBuffer {
+public:
+    /// Creates a buffer for vkCmdDrawIndexedIndirect with one command per object.
+    IndirectDrawBuffer(Device* device, const std::vector<VkDrawIndexedIndirectCommand>& objectDrawCommands);
+    /// Creates a buffer for vkCmdDrawIndirect with one command per object.
+    IndirectDrawBuffer(Device* device, const std::vector<VkDrawIndirectCommand>& objectDrawCommands);
+
+    /**
+     * Writes the draw commands of the passed objects to the indirect draw buffer.
+     * @param visibleObjects The indices of the visible objects.
+     */
+    void update(const std::vector<uint32_t>& visibleObjects);
+
+    /// Sets the indirect draw buffer and the number of draws of the raster data.
+    void setRasterData(const RasterDataPtr& rasterData);
+
+    [[nodiscard]] inline const BufferPtr& getBuffer() const { return indirectDrawBuffer; }
+    [[nodiscard]] inline uint32_t getStride() const { return stride; }
+    [[nodiscard]] inline uint32_t getNumObjects() const { return numObjects; }
+    [[nodiscard]] inline uint32_t getDrawCount() const { return drawCount; }
+
+private:
+    void createBuffer(Device* device, const void* commandsData);
+
+    uint32_t stride = 0;
+    uint32_t numObjects = 0;
+    uint32_t drawCount = 0;
+    std::vector<uint8_t> objectDrawCommandsData;
+    BufferPtr indirectDrawBuffer;
+};
+
+typedef std::shared_ptr<IndirectDrawBuffer> IndirectDrawBufferPtr;
+
+}}
+
+#endif //SGL_INDIRECTDRAWBUFFER_HPP
@@ -0,0 +1,129 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+#include <algorithm>
+
+#include <Utils/File/Logfile.hpp>
+#include <Graphics/Vulkan/Utils/Device.hpp>
+#include <Graphics/Vulkan/Buffers/Buffer.hpp>
+
+#include "Data.hpp"
+#include "MeshletBuffers.hpp"
+
+namespace sgl { namespace vk {
+
+MeshletSettings getMeshletSettings(Device* device, const MeshletSettings& preferredSettings) {
+    MeshletSettings settings = preferredSettings;
+    uint32_t maxMeshOutputVertices = 256;
+    uint32_t maxMeshOutputPrimitives = std::numeric_limits<uint32_t>::max();
+#ifdef VK_EXT_mesh_shader
+    if (device->getPhysicalDeviceMeshShaderFeaturesEXT().meshShader) {
+        const auto& meshShaderProperties = device->getPhysicalDeviceMeshShaderPropertiesEXT();
+        maxMeshOutputVertices = std::min(maxMeshOutputVertices, meshShaderProperties.maxMeshOutputVertices);
+        maxMeshOutputPrimitives = std::min(maxMeshOutputPrimitives, meshShaderProperties.maxMeshOutputPrimitives);
+    } else
+#endif
+    if (device->getPhysicalDeviceMeshShaderFeaturesNV().meshShader) {
+        const auto& meshShaderProperties = device->getPhysicalDeviceMeshShaderPropertiesNV();
+        maxMeshOutputVertices = std::min(maxMeshOutputVertices, meshShaderProperties.maxMeshOutputVertices);
+        maxMeshOutputPrimitives = std::min(maxMeshOutputPrimitives, meshShaderProperties.maxMeshOutputPrimitives);
+    }
+    settings.maxVertices = std::max(std::min(settings.maxVertices, maxMeshOutputVertices), 3u);
+    settings.maxPrimitives = std::max(std::min(settings.maxPrimitives, maxMeshOutputPrimitives), 1u);
+    return settings;
+}
+
+template<class T>
+static BufferPtr createMeshletStorageBuffer(
+        Device* device, const std::vector<T>& data, VkBufferUsageFlags additionalUsageFlags) {
+    // Vulkan does not allow buffers of size zero.
+    if (data.empty()) {
+        T dummyEntry{};
+        return std::make_shared<Buffer>(
+                device, sizeof(T), &dummyEntry, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | additionalUsageFlags,
+                VMA_MEMORY_USAGE_GPU_ONLY);
+    }
+    return std::make_shared<Buffer>(
+            device, sizeof(T) * data.size(), data.data(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | additionalUsageFlags,
+            VMA_MEMORY_USAGE_GPU_ONLY);
+}
+
+MeshletBuffers::MeshletBuffers(
+        Device* device, const MeshletData& meshletData, VkBufferUsageFlags additionalUsageFlags)
+        : numMeshlets(uint32_t(meshletData.meshlets.size())) {
+    meshletBuffer = createMeshletStorageBuffer(device, meshletData.meshlets, additionalUsageFlags);
+    meshletBoundsBuffer = createMeshletStorageBuffer(device, meshletData.meshletBounds, additionalUsageFlags);
+    vertexIndexBuffer = createMeshletStorageBuffer(device, meshletData.vertexIndices, additionalUsageFlags);
+    primitiveIndexBuffer = createMeshletStorageBuffer(device, meshletData.primitiveIndices, additionalUsageFlags);
+
+    // Only 65535 work groups per dimension are guaranteed by VK_EXT_mesh_shader, so split the meshlets into X * Y.
+    uint32_t maxGroupCountX = 65535;
+    uint32_t maxGroupCountY = 65535;
+    uint32_t maxGroupCountTotal = 1u << 22u;
+#ifdef VK_EXT_mesh_shader
+    if (device->getPhysicalDeviceMeshShaderFeaturesEXT().meshShader) {
+        const auto& meshShaderProperties = device->getPhysicalDeviceMeshShaderPropertiesEXT();
+        maxGroupCountX = std::min(
+                meshShaderProperties.maxMeshWorkGroupCount[0], meshShaderProperties.maxTaskWorkGroupCount[0]);
+        maxGroupCountY = std::min(
+                meshShaderProperties.maxMeshWorkGroupCount[1], meshShaderProperties.maxTaskWorkGroupCount[1]);
+        maxGroupCountTotal = std::min(
+                meshShaderProperties.maxMeshWorkGroupTotalCount, meshShaderProperties.maxTaskWorkGroupTotalCount);
+    }
+#endif
+    maxGroupCountX = std::max(maxGroupCountX, 1u);
+    groupCountX = std::min(numMeshlets, maxGroupCountX);
+    groupCountY = groupCountX == 0 ? 0 : (numMeshlets - 1) / groupCountX + 1;
+    if (groupCountX != 0) {
+        maxGroupCountY = std::min(maxGroupCountY, maxGroupCountTotal / groupCountX);
+    }
+    if (groupCountY > maxGroupCountY) {
+        sgl::Logfile::get()->writeError(
+                "Error in MeshletBuffers::MeshletBuffers: The number of meshlets exceeds the maximum mesh shader work "
+                "group count of the device.", false);
+        groupCountY = maxGroupCountY;
+    }
+}
+
+void MeshletBuffers::setRasterDataBuffers(
+        const RasterDataPtr& rasterData, bool useMeshShaderNV,
+        const std::string& meshletBufferName, const std::string& meshletBoundsBufferName,
+        const std::string& vertexIndexBufferName, const std::string& primitiveIndexBufferName) {
+    rasterData->setStaticBufferOptional(meshletBuffer, meshletBufferName);
+    rasterData->setStaticBufferOptional(meshletBoundsBuffer, meshletBoundsBufferName);
+    rasterData->setStaticBufferOptional(vertexIndexBuffer, vertexIndexBufferName);
+    rasterData->setStaticBufferOptional(primitiveIndexBuffer, primitiveIndexBufferName);
+    if (useMeshShaderNV) {
+        rasterData->setMeshTasksNV(numMeshlets, 0);
+    } else {
+        rasterData->setMeshTasksGroupCountEXT(groupCountX, groupCountY, 1);
+    }
+}
+
+}}
@@ -0,0 +1,108 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_MESHLETBUFFERS_HPP
+#define SGL_MESHLETBUFFERS_HPP
+
+#include <memory>
+#include <string>
+
+#include <Utils/Mesh/Meshlets.hpp>
+#include "../libs/volk/volk.h"
+
+namespace sgl { namespace vk {
+
+class Device;
+class Buffer;
+typedef std::shared_ptr<Buffer> BufferPtr;
+class RasterData;
+typedef std::shared_ptr<RasterData> RasterDataPtr;
+
+/**
+ * Clamps the preferred meshlet settings to the mesh shader output limits of the device (maxMeshOutputVertices and
+ * maxMeshOutputPrimitives). VK_EXT_mesh_shader is preferred over VK_NV_mesh_shader if both are enabled. If mesh
+ * shaders are not supported, the preferred settings are returned unchanged.
+ */
+DLL_OBJECT MeshletSettings getMeshletSettings(Device* device, const MeshletSettings& preferredSettings = {});
+
+/**
+ * Storage buffers for the data computed by @see sgl::buildMeshlets, i.e., one buffer each for the meshlets, the
+ * meshlet bounds, the meshlet vertex indices and the packed meshlet primitive indices.
+ */
+class DLL_OBJECT MeshletBuffers {
+public:
+    /**
+     * @param device The device to allocate the buffers for.
+     * @param meshletData The meshlet data to upload.
+     * @param additionalUsageFlags Additional usage flags for the buffers (e.g., VK_BUFFER_USAGE_TRANSFER_SRC_BIT).
+     */
+    MeshletBuffers(Device* device, const MeshletData& meshletData, VkBufferUsageFlags additionalUsageFlags = 0);
+
+    [[nodiscard]] inline uint32_t getNumMeshlets() const { return numMeshlets; }
+    /// Work group counts used by @see setRasterDataBuffers for vkCmdDrawMeshTasksEXT.
+    [[nodiscard]] inline uint32_t getMeshTasksGroupCountX() const { return groupCountX; }
+    [[nodiscard]] inline uint32_t getMeshTasksGroupCountY() const { return groupCountY; }
+    [[nodiscard]] inline const BufferPtr& getMeshletBuffer() const { return meshletBuffer; }
+    [[nodiscard]] inline const BufferPtr& getMeshletBoundsBuffer() const { return meshletBoundsBuffer; }
+    [[nodiscard]] inline const BufferPtr& getVertexIndexBuffer() const { return vertexIndexBuffer; }
+    [[nodiscard]] inline const BufferPtr& getPrimitiveIndexBuffer() const { return primitiveIndexBuffer; }
+
+    /**
+     * Binds the buffers to the passed raster data (if the shaders use them) and dispatches one mesh shader work group
+     * per meshlet (i.e., one task shader work group if a task shader is used).
+     * VK_EXT_mesh_shader only guarantees 65535 work groups in X, so the dispatch is split into groupCountX *
+     * groupCountY work groups, where groupCountX is limited by maxMeshWorkGroupCount[0] and maxTaskWorkGroupCount[0].
+     * The shader needs to linearize the work group ID and skip the padding work groups of the last row, i.e.:
+     * uint meshletIdx = gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x;
+     * if (meshletIdx >= numMeshlets) { return; }
+     * For VK_NV_mesh_shader, gl_WorkGroupID.x is the meshlet index, as the renderer splits draws exceeding
+     * maxDrawMeshTasksCount into multiple draws with an increasing first task index.
+     * @param rasterData The raster data of a graphics pipeline using a mesh shader.
+     * @param useMeshShaderNV Whether to use vkCmdDrawMeshTasksNV instead of vkCmdDrawMeshTasksEXT.
+     */
+    void setRasterDataBuffers(
+            const RasterDataPtr& rasterData, bool useMeshShaderNV = false,
+            const std::string& meshletBufferName = "MeshletBuffer",
+            const std::string& meshletBoundsBufferName = "MeshletBoundsBuffer",
+            const std::string& vertexIndexBufferName = "MeshletVertexIndexBuffer",
+            const std::string& primitiveIndexBufferName = "MeshletPrimitiveIndexBuffer");
+
+private:
+    uint32_t numMeshlets = 0;
+    uint32_t groupCountX = 0, groupCountY = 0;
+    BufferPtr meshletBuffer;
+    BufferPtr meshletBoundsBuffer;
+    BufferPtr vertexIndexBuffer;
+    BufferPtr primitiveIndexBuffer;
+};
+
+typedef std::shared_ptr<MeshletBuffers> MeshletBuffersPtr;
+
+}}
+
+#endif //SGL_MESHLETBUFFERS_HPP
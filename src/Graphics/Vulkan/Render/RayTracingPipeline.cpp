@@ -489,7 +489,7 @@ RayTracingPipeline::RayTracingPipeline(Device* device, const RayTracingPipelineI
     pipelineCreateInfo.basePipelineIndex = -1;
 
     if (vkCreateRayTracingPipelinesKHR(
-            device->getVkDevice(), VK_NULL_HANDLE, VK_NULL_HANDLE,
+            device->getVkDevice(), VK_NULL_HANDLE, device->getVkPipelineCache(),
             1, &pipelineCreateInfo, nullptr, &pipeline) != VK_SUCCESS) {
         Logfile::get()->throwError(
                 "Error in RayTracingPipeline::RayTracingPipeline: Could not create a RayTracing pipeline.");
@@ -38,6 +38,7 @@
 #include "Status.hpp"
 #include "Instance.hpp"
 #include "Swapchain.hpp"
+#include "PipelineCache.hpp"
 #include "Device.hpp"
 
 #ifdef SUPPORT_OPENGL
@@ -1696,6 +1697,7 @@ void Device::createDeviceSwapchain(
     writeDeviceInfoToLog(enabledDeviceExtensionNames);
 
     createVulkanMemoryAllocator();
+    pipelineCache = new PipelineCache(this);
 }
 
 void Device::createDeviceHeadless(
@@ -1732,9 +1734,15 @@ void Device::createDeviceHeadless(
     writeDeviceInfoToLog(enabledDeviceExtensionNames);
 
     createVulkanMemoryAllocator();
+    pipelineCache = new PipelineCache(this);
 }
 
 Device::~Device() {
+    if (pipelineCache) {
+        delete pipelineCache;
+        pipelineCache = nullptr;
+    }
+
     for (auto& it : commandPools) {
         vkDestroyCommandPool(device, it.second, nullptr);
     }
@@ -1752,6 +1760,13 @@ Device::~Device() {
     }
 }
 
+VkPipelineCache Device::getVkPipelineCache() {
+    if (!pipelineCache) {
+        return VK_NULL_HANDLE;
+    }
+    return pipelineCache->getVkPipelineCache();
+}
+
 void Device::waitIdle() {
     vkDeviceWaitIdle(device);
 }
@@ -108,6 +108,7 @@ template<> struct hash<sgl::vk::MemoryPoolType> {
 namespace sgl { namespace vk {
 
 class Instance;
+class PipelineCache;
 
 struct DLL_OBJECT DeviceFeatures {
     DeviceFeatures() {
@@ -501,6 +502,13 @@ public:
     // Get the standard descriptor pool.
     VkDescriptorPool getDefaultVkDescriptorPool() { return descriptorPool; }
 
+    /**
+     * Returns the pipeline cache to pass to vkCreate*Pipelines on the calling thread. Worker threads get their own
+     * cache, as the cache needs to be externally synchronized (@see PipelineCache::mergeWorkerThreadCaches).
+     */
+    VkPipelineCache getVkPipelineCache();
+    inline PipelineCache* getPipelineCache() { return pipelineCache; }
+
 #ifdef SUPPORT_OPENGL
     /// This function must be called before the device is created.
     void setOpenGlInteropEnabled(bool enabled) { openGlInteropEnabled = true; }
@@ -708,6 +716,9 @@ private:
     // Default descriptor pool.
     VkDescriptorPool descriptorPool;
 
+    // Pipeline cache persisted across runs of the application.
+    PipelineCache* pipelineCache = nullptr;
+
     // Vulkan-OpenGL interoperability enabled?
     bool openGlInteropEnabled = false;
 };
@@ -0,0 +1,229 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <tracy/Tracy.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/File/DiskCache.hpp>
+#include <Utils/File/ContentHash.hpp>
+#include <Utils/Events/Stream/Stream.hpp>
+#include "Device.hpp"
+#include "PipelineCache.hpp"
+
+namespace sgl { namespace vk {
+
+/// Needs to be increased when the layout of the stored data changes.
+static const uint32_t PIPELINE_CACHE_FORMAT_VERSION = 1;
+
+static DiskCacheKey getPipelineCacheKey(Device* device) {
+    DiskCacheKey key("VulkanPipelineCache");
+    key.addParameter(device->getVendorId());
+    key.addParameter(device->getDeviceId());
+    key.addParameter(device->getDriverVersion());
+    key.addData(device->getPipelineCacheUuid(), VK_UUID_SIZE);
+    return key;
+}
+
+PipelineCache::PipelineCache(Device* device, bool usePersistentStorage)
+        : device(device), usePersistentStorage(usePersistentStorage) {
+    ZoneScoped;
+
+    // Without a cache directory (i.e., if FileUtils was not initialized), the data would be stored in the working
+    // directory.
+    if (this->usePersistentStorage && DiskCache::get()->getCacheDirectory().empty()) {
+        Logfile::get()->writeInfo(
+                "PipelineCache::PipelineCache: No cache directory is set. Disabling persistent storage.");
+        this->usePersistentStorage = false;
+    }
+    if (this->usePersistentStorage && loadCacheData(loadedCacheData)) {
+        storedDataHash = computeXXHash64(loadedCacheData.data(), loadedCacheData.size());
+    } else {
+        loadedCacheData.clear();
+    }
+
+    mainPipelineCache = createVkPipelineCache(loadedCacheData);
+    if (mainPipelineCache == VK_NULL_HANDLE && !loadedCacheData.empty()) {
+        // The driver may still reject the data (e.g., if it is corrupted). Start with an empty cache in this case.
+        Logfile::get()->writeWarning(
+                "Warning in PipelineCache::PipelineCache: The driver rejected the cached pipeline data.", false);
+        loadedCacheData.clear();
+        storedDataHash = 0;
+        mainPipelineCache = createVkPipelineCache(loadedCacheData);
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    mergeWorkerThreadCaches();
+    if (usePersistentStorage) {
+        save();
+    }
+    if (mainPipelineCache != VK_NULL_HANDLE) {
+        vkDestroyPipelineCache(device->getVkDevice(), mainPipelineCache, nullptr);
+        mainPipelineCache = VK_NULL_HANDLE;
+    }
+}
+
+VkPipelineCache PipelineCache::getVkPipelineCache() {
+    if (device->getIsMainThread()) {
+        return mainPipelineCache;
+    }
+
+    std::lock_guard<std::mutex> lock(workerThreadCachesMutex);
+    auto it = workerThreadCaches.find(std::this_thread::get_id());
+    if (it != workerThreadCaches.end()) {
+        return it->second;
+    }
+    VkPipelineCache workerThreadCache = createVkPipelineCache(loadedCacheData);
+    if (workerThreadCache != VK_NULL_HANDLE) {
+        workerThreadCaches.insert(std::make_pair(std::this_thread::get_id(), workerThreadCache));
+    }
+    return workerThreadCache;
+}
+
+void PipelineCache::mergeWorkerThreadCaches() {
+    ZoneScoped;
+
+    std::lock_guard<std::mutex> lock(workerThreadCachesMutex);
+    if (workerThreadCaches.empty()) {
+        return;
+    }
+
+    std::vector<VkPipelineCache> srcCaches;
+    srcCaches.reserve(workerThreadCaches.size());
+    for (auto& it : workerThreadCaches) {
+        srcCaches.push_back(it.second);
+    }
+    if (mainPipelineCache != VK_NULL_HANDLE) {
+        VkResult result = vkMergePipelineCaches(
+                device->getVkDevice(), mainPipelineCache, uint32_t(srcCaches.size()), srcCaches.data());
+        if (result != VK_SUCCESS) {
+            Logfile::get()->writeError(
+                    "Error in PipelineCache::mergeWorkerThreadCaches: vkMergePipelineCaches failed.", false);
+        }
+    }
+    for (VkPipelineCache srcCache : srcCaches) {
+        vkDestroyPipelineCache(device->getVkDevice(), srcCache, nullptr);
+    }
+    workerThreadCaches.clear();
+}
+
+bool PipelineCache::save() {
+    ZoneScoped;
+
+    if (mainPipelineCache == VK_NULL_HANDLE || DiskCache::get()->getCacheDirectory().empty()) {
+        return false;
+    }
+
+    size_t dataSize = 0;
+    VkResult result = vkGetPipelineCacheData(device->getVkDevice(), mainPipelineCache, &dataSize, nullptr);
+    if (result != VK_SUCCESS) {
+        Logfile::get()->writeError("Error in PipelineCache::save: vkGetPipelineCacheData failed.", false);
+        return false;
+    }
+    std::vector<uint8_t> cacheData(dataSize);
+    if (dataSize > 0) {
+        result = vkGetPipelineCacheData(device->getVkDevice(), mainPipelineCache, &dataSize, cacheData.data());
+        if (result != VK_SUCCESS) {
+            Logfile::get()->writeError("Error in PipelineCache::save: vkGetPipelineCacheData failed.", false);
+            return false;
+        }
+        cacheData.resize(dataSize);
+    }
+    if (cacheData.empty() || !checkCacheDataHeader(cacheData)) {
+        return false;
+    }
+
+    uint64_t dataHash = computeXXHash64(cacheData.data(), cacheData.size());
+    if (dataHash == storedDataHash) {
+        return true;
+    }
+    DiskCacheKey key = getPipelineCacheKey(device);
+    if (!DiskCache::get()->store(key, PIPELINE_CACHE_FORMAT_VERSION, cacheData.data(), cacheData.size())) {
+        return false;
+    }
+    storedDataHash = dataHash;
+    return true;
+}
+
+bool PipelineCache::loadCacheData(std::vector<uint8_t>& cacheData) {
+    ZoneScoped;
+
+    DiskCacheKey key = getPipelineCacheKey(device);
+    ReadStreamPtr stream = DiskCache::get()->load(key, PIPELINE_CACHE_FORMAT_VERSION);
+    if (!stream) {
+        return false;
+    }
+    cacheData.assign(stream->getBuffer(), stream->getBuffer() + stream->getSize());
+    if (!checkCacheDataHeader(cacheData)) {
+        Logfile::get()->writeWarning(
+                "Warning in PipelineCache::loadCacheData: The stored pipeline cache does not match the device.",
+                false);
+        DiskCache::get()->remove(key);
+        cacheData.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PipelineCache::checkCacheDataHeader(const std::vector<uint8_t>& cacheData) {
+    // The fields of VkPipelineCacheHeaderVersionOne are read one by one, as the struct may contain padding.
+    const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+    if (cacheData.size() < headerSize) {
+        return false;
+    }
+    uint32_t headerFields[4];
+    memcpy(headerFields, cacheData.data(), sizeof(headerFields));
+    if (headerFields[0] < headerSize || headerFields[0] > cacheData.size()
+            || headerFields[1] != uint32_t(VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+            || headerFields[2] != device->getVendorId() || headerFields[3] != device->getDeviceId()) {
+        return false;
+    }
+    return memcmp(cacheData.data() + sizeof(headerFields), device->getPipelineCacheUuid(), VK_UUID_SIZE) == 0;
+}
+
+VkPipelineCache PipelineCache::createVkPipelineCache(const std::vector<uint8_t>& cacheData) {
+    VkPipelineCacheCreateInfo pipelineCacheCreateInfo{};
+    pipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    pipelineCacheCreateInfo.initialDataSize = cacheData.size();
+    pipelineCacheCreateInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    if (vkCreatePipelineCache(
+            device->getVkDevice(), &pipelineCacheCreateInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        // Failing with initial data is handled by the caller.
+        if (cacheData.empty()) {
+            Logfile::get()->writeError(
+                    "Error in PipelineCache::createVkPipelineCache: Could not create a pipeline cache.", false);
+        }
+        return VK_NULL_HANDLE;
+    }
+    return pipelineCache;
+}
+
+}}
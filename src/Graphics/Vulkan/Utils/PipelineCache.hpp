@@ -0,0 +1,110 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_PIPELINECACHE_HPP
+#define SGL_PIPELINECACHE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+
+#include "../libs/volk/volk.h"
+
+namespace sgl { namespace vk {
+
+class Device;
+
+/**
+ * Wrapper around VkPipelineCache owned by @see Device. All pipelines created by sgl use the cache returned by
+ * @see getVkPipelineCache, so the driver does not need to recompile pipelines it has already seen in this or (if
+ * persistent storage is enabled) a previous run of the application.
+ *
+ * The cache data is stored via @see DiskCache. The cache key contains the vendor ID, device ID, driver version and
+ * pipeline cache UUID of the device, i.e., every device/driver combination uses its own cache file. In addition, the
+ * header of the loaded data is validated before it is passed to the driver.
+ *
+ * vkCreate*Pipelines requires external synchronization of the passed pipeline cache. Thus, threads other than the
+ * main thread get their own cache, which is initialized with the data loaded from disk. These caches can be merged
+ * into the main cache using @see mergeWorkerThreadCaches.
+ */
+class DLL_OBJECT PipelineCache {
+public:
+    /**
+     * @param device The device the cache is created for.
+     * @param usePersistentStorage Whether to load the cache data from and store it to disk. It is disabled if no
+     * cache directory is set (@see FileUtils::initialize and @see DiskCache::setCacheDirectory).
+     */
+    explicit PipelineCache(Device* device, bool usePersistentStorage = true);
+    /// Merges the worker thread caches and saves the data to disk (if persistent storage is enabled).
+    ~PipelineCache();
+
+    /// Returns the cache to use for pipeline creation on the calling thread.
+    VkPipelineCache getVkPipelineCache();
+    /// Returns the cache of the main thread.
+    [[nodiscard]] inline VkPipelineCache getMainVkPipelineCache() { return mainPipelineCache; }
+
+    /**
+     * Merges the caches created for worker threads into the main cache and destroys them afterwards.
+     * NOTE: Must not be called while worker threads are creating pipelines.
+     */
+    void mergeWorkerThreadCaches();
+
+    /**
+     * Writes the data of the main cache to disk. This is done automatically when the device is destroyed, but can
+     * also be called manually, e.g., after loading has finished or after shaders have been reloaded.
+     * @return Whether the data could be stored. Fails if no cache directory is set.
+     */
+    bool save();
+
+    inline void setUsePersistentStorage(bool usePersistent) { usePersistentStorage = usePersistent; }
+    [[nodiscard]] inline bool getUsePersistentStorage() const { return usePersistentStorage; }
+
+private:
+    /// Loads the cache data from disk. Returns false if no valid data matching the device exists.
+    bool loadCacheData(std::vector<uint8_t>& cacheData);
+    /// Checks whether the header of the cache data matches the device (@see VkPipelineCacheHeaderVersionOne).
+    bool checkCacheDataHeader(const std::vector<uint8_t>& cacheData);
+    VkPipelineCache createVkPipelineCache(const std::vector<uint8_t>& cacheData);
+
+    Device* device;
+    bool usePersistentStorage;
+    VkPipelineCache mainPipelineCache = VK_NULL_HANDLE;
+    /// Hash of the data last loaded from or stored to disk. Used for not writing unchanged data again.
+    uint64_t storedDataHash = 0;
+    /// The data loaded from disk. Used for initializing the worker thread caches.
+    std::vector<uint8_t> loadedCacheData;
+
+    std::mutex workerThreadCachesMutex;
+    std::unordered_map<std::thread::id, VkPipelineCache> workerThreadCaches;
+};
+
+}}
+
+#endif //SGL_PIPELINECACHE_HPP
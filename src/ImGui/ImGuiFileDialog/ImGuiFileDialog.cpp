@@ -1433,6 +1433,13 @@ namespace IGFD
 	{
 		prFilteredFileList.clear();
 		prFileList.clear();
+#ifdef USE_SGL_DIRECTORY_SCANNER
+		if (prDirectoryScan)
+		{
+			prDirectoryScan->cancel();
+			prDirectoryScan = nullptr;
+		}
+#endif // USE_SGL_DIRECTORY_SCANNER
 	}
 
 	std::string IGFD::FileManager::prOptimizeFilenameForSearchOperations(const std::string& vFileNameExt)
@@ -1444,7 +1451,7 @@ namespace IGFD
 		return fileNameExt;
 	}
 
-	void IGFD::FileManager::AddFile(const FileDialogInternal& vFileDialogInternal, const std::string& vPath, const std::string& vFileName, const char& vFileType)
+	std::shared_ptr<FileInfos> IGFD::FileManager::prCreateFileInfos(const FileDialogInternal& vFileDialogInternal, const std::string& vPath, const std::string& vFileName, const char& vFileType)
 	{
 		auto infos = std::make_shared<FileInfos>();
 
@@ -1453,10 +1460,10 @@ namespace IGFD
 		infos->fileNameExt_optimized = prOptimizeFilenameForSearchOperations(infos->fileNameExt);
 		infos->fileType = vFileType;
 
-		if (infos->fileNameExt.empty() || (infos->fileNameExt == "." && !vFileDialogInternal.puFilterManager.puDLGFilters.empty())) return; // filename empty or filename is the current dir '.' //-V807
+		if (infos->fileNameExt.empty() || (infos->fileNameExt == "." && !vFileDialogInternal.puFilterManager.puDLGFilters.empty())) return nullptr; // filename empty or filename is the current dir '.' //-V807
 		if (infos->fileNameExt != ".." && (vFileDialogInternal.puDLGflags & ImGuiFileDialogFlags_DontShowHiddenFiles) && infos->fileNameExt[0] == '.') // dont show hidden files
 			if (!vFileDialogInternal.puFilterManager.puDLGFilters.empty() || (vFileDialogInternal.puFilterManager.puDLGFilters.empty() && infos->fileNameExt != ".")) // except "." if in directory mode //-V728
-				return;
+				return nullptr;
 
 		if (infos->fileType == 'f' ||
 			infos->fileType == 'l') // link can have the same extension of a file
@@ -1469,16 +1476,50 @@ namespace IGFD
 
 			if (!vFileDialogInternal.puFilterManager.IsCoveredByFilters(infos->fileExt))
 			{
-				return;
+				return nullptr;
 			}
 		}
 
 		vFileDialogInternal.puFilterManager.prFillFileStyle(infos);
 
+		return infos;
+	}
+
+	void IGFD::FileManager::AddFile(const FileDialogInternal& vFileDialogInternal, const std::string& vPath, const std::string& vFileName, const char& vFileType)
+	{
+		auto infos = prCreateFileInfos(vFileDialogInternal, vPath, vFileName, vFileType);
+		if (!infos)
+			return;
+
 		prCompleteFileInfos(infos);
 		prFileList.push_back(infos);
 	}
 
+#ifdef USE_SGL_DIRECTORY_SCANNER
+	void IGFD::FileManager::AddFile(const FileDialogInternal& vFileDialogInternal, const std::string& vPath, const sgl::DirectoryEntry& vEntry)
+	{
+		char fileType = 0;
+		switch (vEntry.type)
+		{
+		case sgl::DirectoryEntryType::FILE:
+			fileType = 'f'; break;
+		case sgl::DirectoryEntryType::DIRECTORY:
+			fileType = 'd'; break;
+		case sgl::DirectoryEntryType::SYMLINK:
+			fileType = 'l'; break;
+		default:
+			break;
+		}
+
+		auto infos = prCreateFileInfos(vFileDialogInternal, vPath, vEntry.name, fileType);
+		if (!infos)
+			return;
+
+		prCompleteFileInfos(infos, vEntry);
+		prFileList.push_back(infos);
+	}
+#endif // USE_SGL_DIRECTORY_SCANNER
+
 	void IGFD::FileManager::ScanDir(const FileDialogInternal& vFileDialogInternal, const std::string& vPath)
 	{
 		std::string	path = vPath;
@@ -1497,7 +1538,15 @@ namespace IGFD
 
 			ClearFileLists();
 
-#ifdef USE_STD_FILESYSTEM
+#ifdef USE_SGL_DIRECTORY_SCANNER
+			// the entries are added by UpdateDirectoryScan as soon as they are found
+			AddFile(vFileDialogInternal, path, ".", 'd');
+			AddFile(vFileDialogInternal, path, "..", 'd');
+			prDirectoryScanPath = path;
+			prDirectoryScan = sgl::DirectoryScanner::get()->scanDirectoryAsync(path, true);
+			UpdateDirectoryScan(vFileDialogInternal);
+			return;
+#elif defined(USE_STD_FILESYSTEM)
 			//const auto wpath = IGFD::Utils::WGetString(path.c_str());
 			const std::filesystem::path fspath(path);
 			const auto dir_iter = std::filesystem::directory_iterator(fspath);
@@ -1548,12 +1597,43 @@ namespace IGFD
 
 				free(files);
 			}
-#endif // USE_STD_FILESYSTEM
+#endif // USE_SGL_DIRECTORY_SCANNER
+
+			SortFields(vFileDialogInternal);
+		}
+	}
 
+#ifdef USE_SGL_DIRECTORY_SCANNER
+	void IGFD::FileManager::UpdateDirectoryScan(const FileDialogInternal& vFileDialogInternal)
+	{
+		if (!prDirectoryScan)
+			return;
+
+		// the directory was changed on disk (detected by sgl::PathWatchManager), so we scan it again
+		if (prDirectoryScan->getIsFinished() && prDirectoryScan->getIsOutdated())
+		{
+			std::string path = prDirectoryScanPath;
+			ScanDir(vFileDialogInternal, path);
+			return;
+		}
+
+		std::vector<sgl::DirectoryEntry> entries;
+		if (prDirectoryScan->fetchNewEntries(entries) > 0)
+		{
+			for (const auto& entry : entries)
+			{
+				AddFile(vFileDialogInternal, prDirectoryScanPath, entry);
+			}
 			SortFields(vFileDialogInternal);
 		}
 	}
 
+	bool IGFD::FileManager::IsDirectoryScanRunning()
+	{
+		return prDirectoryScan && !prDirectoryScan->getIsFinished();
+	}
+#endif // USE_SGL_DIRECTORY_SCANNER
+
 	bool IGFD::FileManager::GetDrives()
 	{
 		auto drives = IGFD::Utils::GetDrivesList();
@@ -1748,6 +1828,36 @@ namespace IGFD
 		}
 	}
 
+#ifdef USE_SGL_DIRECTORY_SCANNER
+	void IGFD::FileManager::prCompleteFileInfos(const std::shared_ptr<FileInfos>& vInfos, const sgl::DirectoryEntry& vEntry)
+	{
+		if (!vInfos.use_count() || !vEntry.hasMetadata)
+			return;
+
+		if (vInfos->fileType != 'd')
+		{
+			vInfos->fileSize = (size_t)vEntry.fileSize;
+			vInfos->formatedFileSize = prFormatFileSize(vInfos->fileSize);
+		}
+
+		char timebuf[100];
+		size_t len = 0;
+		auto modificationTime = (time_t)vEntry.modificationTime;
+#ifdef MSVC
+		struct tm _tm;
+		errno_t err = localtime_s(&_tm, &modificationTime);
+		if (!err) len = strftime(timebuf, 99, DateTimeFormat, &_tm);
+#else // MSVC
+		struct tm* _tm = localtime(&modificationTime);
+		if (_tm) len = strftime(timebuf, 99, DateTimeFormat, _tm);
+#endif // MSVC
+		if (len)
+		{
+			vInfos->fileModifDate = std::string(timebuf, len);
+		}
+	}
+#endif // USE_SGL_DIRECTORY_SCANNER
+
 	void IGFD::FileManager::prRemoveFileNameInSelection(const std::string& vFileName)
 	{
 		prSelectedFileNames.erase(vFileName);
@@ -3663,6 +3773,9 @@ namespace IGFD
 						fdFile.SetDefaultFileName(".");
 					fdFile.ScanDir(prFileDialogInternal, fdFile.puDLGpath);
 				}
+#ifdef USE_SGL_DIRECTORY_SCANNER
+				fdFile.UpdateDirectoryScan(prFileDialogInternal);
+#endif // USE_SGL_DIRECTORY_SCANNER
 
 				// draw dialog parts
 				prDrawHeader(); // bookmark, directory, path
@@ -657,6 +657,10 @@ struct IGFD_Thumbnail_Info
 #include <mutex>
 #include <condition_variable>
 
+#ifdef USE_SGL_DIRECTORY_SCANNER
+#include <Utils/File/DirectoryScanner.hpp>
+#endif // USE_SGL_DIRECTORY_SCANNER
+
 namespace IGFD
 {
 #ifndef defaultSortField
@@ -872,6 +876,10 @@ namespace IGFD
 		std::string prLastSelectedFileName;									// for shift multi selection
 		std::set<std::string> prSelectedFileNames;							// the user selection of FilePathNames
 		bool prCreateDirectoryMode = false;									// for create directory widget
+#ifdef USE_SGL_DIRECTORY_SCANNER
+		sgl::DirectoryScanPtr prDirectoryScan;								// asynchronous scan of the current directory
+		std::string prDirectoryScanPath;									// path passed to ScanDir for the current scan
+#endif // USE_SGL_DIRECTORY_SCANNER
 
 	public:
 		char puVariadicBuffer[MAX_FILE_DIALOG_NAME_BUFFER] = "";			// called by prSelectableItem
@@ -917,8 +925,15 @@ namespace IGFD
 		static void prCompleteFileInfos(const std::shared_ptr<FileInfos>& FileInfos);					// set time and date infos of a file (detail view mode)
 		void prRemoveFileNameInSelection(const std::string& vFileName);									// selection : remove a file name
 		void prAddFileNameInSelection(const std::string& vFileName, bool vSetLastSelectionFileName);	// selection : add a file name
+		std::shared_ptr<FileInfos> prCreateFileInfos(const FileDialogInternal& vFileDialogInternal,
+			const std::string& vPath, const std::string& vFileName, const char& vFileType);				// create the infos of a file, or nullptr if filtered out
 		void AddFile(const FileDialogInternal& vFileDialogInternal, 
 			const std::string& vPath, const std::string& vFileName, const char& vFileType);				// add file called by scandir
+#ifdef USE_SGL_DIRECTORY_SCANNER
+		void AddFile(const FileDialogInternal& vFileDialogInternal,
+			const std::string& vPath, const sgl::DirectoryEntry& vEntry);								// add file found by the directory scanner (no stat needed)
+		static void prCompleteFileInfos(const std::shared_ptr<FileInfos>& FileInfos, const sgl::DirectoryEntry& vEntry);	// set time and date infos from the scanned metadata
+#endif // USE_SGL_DIRECTORY_SCANNER
 
 	public:
 		FileManager();
@@ -953,6 +968,10 @@ namespace IGFD
 		//depend of dirent.h
 		void SetCurrentDir(const std::string& vPath);													// define current directory for scan
 		void ScanDir(const FileDialogInternal& vFileDialogInternal, const std::string& vPath);			// scan the directory for retrieve the file list
+#ifdef USE_SGL_DIRECTORY_SCANNER
+		void UpdateDirectoryScan(const FileDialogInternal& vFileDialogInternal);						// add the files found by the asynchronous scan since the last frame
+		bool IsDirectoryScanRunning();																	// the asynchronous scan of the current directory is not finished yet
+#endif // USE_SGL_DIRECTORY_SCANNER
 
 	public:
 		std::string GetResultingPath();
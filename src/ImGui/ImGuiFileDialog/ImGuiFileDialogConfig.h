@@ -8,6 +8,10 @@
 //this options need c++17
 // in this app its defined in CMakeLists.txt
 //#define USE_STD_FILESYSTEM
+
+// scan directories asynchronously with sgl::DirectoryScanner, so that big directories (or slow network file systems)
+// don't block the frame. The file list is filled incrementally, and changed directories are rescanned automatically.
+#define USE_SGL_DIRECTORY_SCANNER
  
 //#define MAX_FILE_DIALOG_NAME_BUFFER 1024
 //#define MAX_PATH_BUFFER_SIZE 1024
@@ -290,7 +290,7 @@ void ImGuiWrapper::renderStart() {
         initInfo.PhysicalDevice = device->getVkPhysicalDevice();
         initInfo.QueueFamily = device->getGraphicsQueueIndex();
         initInfo.Queue = device->getGraphicsQueue();
-        initInfo.PipelineCache = VK_NULL_HANDLE;
+        initInfo.PipelineCache = device->getVkPipelineCache();
         initInfo.DescriptorPool = imguiDescriptorPool;
         initInfo.MinImageCount = swapchain->getMinImageCount();
         initInfo.ImageCount = uint32_t(swapchain->getNumImages());
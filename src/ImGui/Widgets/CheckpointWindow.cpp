@@ -136,7 +136,7 @@ bool CheckpointWindow::readFromFile(const std::string& filename) {
     file.read(buffer, size);
     file.close();
 
-    sgl::BinaryReadStream stream(buffer, size);
+    sgl::BinaryReadStream stream(buffer, size, sgl::StreamBufferOwnership::TAKE);
     uint32_t version;
     stream.read(version);
     if (version > CHECKPOINT_FORMAT_VERSION || version < 1u) {
@@ -210,7 +210,9 @@ bool CheckpointWindow::writeToFile(const std::string& filename) {
         }
     }
 
-    file.write((const char*)stream.getBuffer(), stream.getSize());
+    stream.forEachSegment([&file](const uint8_t* data, size_t size) {
+        file.write((const char*)data, std::streamsize(size));
+    });
     file.close();
 
     return true;
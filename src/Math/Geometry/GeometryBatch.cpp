@@ -0,0 +1,481 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define SGL_GEOMETRY_BATCH_AVX
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SGL_GEOMETRY_BATCH_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SGL_GEOMETRY_BATCH_NEON
+#endif
+
+#include <tracy/Tracy.hpp>
+
+#include <Math/Math.hpp>
+#include "AABB3.hpp"
+#include "Sphere.hpp"
+#include "Plane.hpp"
+#include "GeometryBatch.hpp"
+
+namespace sgl {
+
+AABB3Batch::AABB3Batch(const std::vector<AABB3>& aabbs) {
+    resize(aabbs.size());
+    for (size_t i = 0; i < aabbs.size(); i++) {
+        setAABB(i, aabbs[i]);
+    }
+}
+
+void AABB3Batch::resize(size_t numAabbs) {
+    minX.resize(numAabbs);
+    minY.resize(numAabbs);
+    minZ.resize(numAabbs);
+    maxX.resize(numAabbs);
+    maxY.resize(numAabbs);
+    maxZ.resize(numAabbs);
+}
+
+void AABB3Batch::clear() {
+    minX.clear();
+    minY.clear();
+    minZ.clear();
+    maxX.clear();
+    maxY.clear();
+    maxZ.clear();
+}
+
+void AABB3Batch::reserve(size_t numAabbs) {
+    minX.reserve(numAabbs);
+    minY.reserve(numAabbs);
+    minZ.reserve(numAabbs);
+    maxX.reserve(numAabbs);
+    maxY.reserve(numAabbs);
+    maxZ.reserve(numAabbs);
+}
+
+void AABB3Batch::pushBack(const AABB3& aabb) {
+    minX.push_back(aabb.min.x);
+    minY.push_back(aabb.min.y);
+    minZ.push_back(aabb.min.z);
+    maxX.push_back(aabb.max.x);
+    maxY.push_back(aabb.max.y);
+    maxZ.push_back(aabb.max.z);
+}
+
+void AABB3Batch::setAABB(size_t idx, const AABB3& aabb) {
+    minX[idx] = aabb.min.x;
+    minY[idx] = aabb.min.y;
+    minZ[idx] = aabb.min.z;
+    maxX[idx] = aabb.max.x;
+    maxY[idx] = aabb.max.y;
+    maxZ[idx] = aabb.max.z;
+}
+
+AABB3 AABB3Batch::getAABB(size_t idx) const {
+    return AABB3(glm::vec3(minX[idx], minY[idx], minZ[idx]), glm::vec3(maxX[idx], maxY[idx], maxZ[idx]));
+}
+
+
+SphereBatch::SphereBatch(const std::vector<Sphere>& spheres) {
+    resize(spheres.size());
+    for (size_t i = 0; i < spheres.size(); i++) {
+        setSphere(i, spheres[i]);
+    }
+}
+
+void SphereBatch::resize(size_t numSpheres) {
+    centerX.resize(numSpheres);
+    centerY.resize(numSpheres);
+    centerZ.resize(numSpheres);
+    radius.resize(numSpheres);
+}
+
+void SphereBatch::clear() {
+    centerX.clear();
+    centerY.clear();
+    centerZ.clear();
+    radius.clear();
+}
+
+void SphereBatch::reserve(size_t numSpheres) {
+    centerX.reserve(numSpheres);
+    centerY.reserve(numSpheres);
+    centerZ.reserve(numSpheres);
+    radius.reserve(numSpheres);
+}
+
+void SphereBatch::pushBack(const Sphere& sphere) {
+    centerX.push_back(sphere.center.x);
+    centerY.push_back(sphere.center.y);
+    centerZ.push_back(sphere.center.z);
+    radius.push_back(sphere.radius);
+}
+
+void SphereBatch::setSphere(size_t idx, const Sphere& sphere) {
+    centerX[idx] = sphere.center.x;
+    centerY[idx] = sphere.center.y;
+    centerZ[idx] = sphere.center.z;
+    radius[idx] = sphere.radius;
+}
+
+Sphere SphereBatch::getSphere(size_t idx) const {
+    return Sphere(glm::vec3(centerX[idx], centerY[idx], centerZ[idx]), radius[idx]);
+}
+
+
+size_t getNumVisible(const VisibilityMask& visibilityMask) {
+    size_t numVisible = 0;
+    for (uint64_t word : visibilityMask) {
+        numVisible += getNumberOfBitsSet(uint32_t(word)) + getNumberOfBitsSet(uint32_t(word >> 32));
+    }
+    return numVisible;
+}
+
+void getVisibleIndices(const VisibilityMask& visibilityMask, std::vector<uint32_t>& visibleIndices) {
+    for (size_t wordIdx = 0; wordIdx < visibilityMask.size(); wordIdx++) {
+        uint64_t word = visibilityMask[wordIdx];
+        while (word != 0) {
+            uint64_t lowerBits = (word & (~word + 1)) - 1;
+            uint32_t bitIdx = getNumberOfBitsSet(uint32_t(lowerBits)) + getNumberOfBitsSet(uint32_t(lowerBits >> 32));
+            visibleIndices.push_back(uint32_t(wordIdx * 64 + bitIdx));
+            word &= word - 1;
+        }
+    }
+}
+
+
+/*
+ * Thin wrappers around the SIMD intrinsics, such that the kernels below only need to be written once.
+ */
+#if defined(SGL_GEOMETRY_BATCH_AVX)
+#define SGL_GEOMETRY_BATCH_SIMD
+typedef __m256 SimdFloat;
+static const size_t SIMD_WIDTH = 8;
+static inline SimdFloat simdLoad(const float* ptr) { return _mm256_loadu_ps(ptr); }
+static inline void simdStore(float* ptr, SimdFloat v) { _mm256_storeu_ps(ptr, v); }
+static inline SimdFloat simdSet1(float f) { return _mm256_set1_ps(f); }
+static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm256_add_ps(a, b); }
+static inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm256_sub_ps(a, b); }
+static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm256_mul_ps(a, b); }
+static inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm256_min_ps(a, b); }
+static inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm256_max_ps(a, b); }
+typedef __m256 SimdMask;
+static inline SimdMask simdCmpLt(SimdFloat a, SimdFloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+static inline SimdMask simdOr(SimdMask a, SimdMask b) { return _mm256_or_ps(a, b); }
+static inline uint32_t simdMoveMask(SimdMask m) { return uint32_t(_mm256_movemask_ps(m)); }
+#elif defined(SGL_GEOMETRY_BATCH_SSE)
+#define SGL_GEOMETRY_BATCH_SIMD
+typedef __m128 SimdFloat;
+static const size_t SIMD_WIDTH = 4;
+static inline SimdFloat simdLoad(const float* ptr) { return _mm_loadu_ps(ptr); }
+static inline void simdStore(float* ptr, SimdFloat v) { _mm_storeu_ps(ptr, v); }
+static inline SimdFloat simdSet1(float f) { return _mm_set1_ps(f); }
+static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return _mm_add_ps(a, b); }
+static inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return _mm_sub_ps(a, b); }
+static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return _mm_mul_ps(a, b); }
+static inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return _mm_min_ps(a, b); }
+static inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return _mm_max_ps(a, b); }
+typedef __m128 SimdMask;
+static inline SimdMask simdCmpLt(SimdFloat a, SimdFloat b) { return _mm_cmplt_ps(a, b); }
+static inline SimdMask simdOr(SimdMask a, SimdMask b) { return _mm_or_ps(a, b); }
+static inline uint32_t simdMoveMask(SimdMask m) { return uint32_t(_mm_movemask_ps(m)); }
+#elif defined(SGL_GEOMETRY_BATCH_NEON)
+#define SGL_GEOMETRY_BATCH_SIMD
+typedef float32x4_t SimdFloat;
+static const size_t SIMD_WIDTH = 4;
+static inline SimdFloat simdLoad(const float* ptr) { return vld1q_f32(ptr); }
+static inline void simdStore(float* ptr, SimdFloat v) { vst1q_f32(ptr, v); }
+static inline SimdFloat simdSet1(float f) { return vdupq_n_f32(f); }
+static inline SimdFloat simdAdd(SimdFloat a, SimdFloat b) { return vaddq_f32(a, b); }
+static inline SimdFloat simdSub(SimdFloat a, SimdFloat b) { return vsubq_f32(a, b); }
+static inline SimdFloat simdMul(SimdFloat a, SimdFloat b) { return vmulq_f32(a, b); }
+static inline SimdFloat simdMin(SimdFloat a, SimdFloat b) { return vminq_f32(a, b); }
+static inline SimdFloat simdMax(SimdFloat a, SimdFloat b) { return vmaxq_f32(a, b); }
+typedef uint32x4_t SimdMask;
+static inline SimdMask simdCmpLt(SimdFloat a, SimdFloat b) { return vcltq_f32(a, b); }
+static inline SimdMask simdOr(SimdMask a, SimdMask b) { return vorrq_u32(a, b); }
+static inline uint32_t simdMoveMask(SimdMask m) {
+    const uint32_t bitValues[4] = { 1u, 2u, 4u, 8u };
+    return vaddvq_u32(vandq_u32(m, vld1q_u32(bitValues)));
+}
+#endif
+
+/// Number of primitives processed per task (i.e., the number of bits of one visibility mask word).
+static const size_t BATCH_BLOCK_SIZE = 64;
+
+static void transformAABBsRange(
+        const glm::mat4& m, const AABB3Batch& aabbsIn, AABB3Batch& aabbsOut, size_t begin, size_t end) {
+    size_t i = begin;
+#ifdef SGL_GEOMETRY_BATCH_SIMD
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        SimdFloat inMin[3] = {
+                simdLoad(aabbsIn.minX.data() + i), simdLoad(aabbsIn.minY.data() + i),
+                simdLoad(aabbsIn.minZ.data() + i) };
+        SimdFloat inMax[3] = {
+                simdLoad(aabbsIn.maxX.data() + i), simdLoad(aabbsIn.maxY.data() + i),
+                simdLoad(aabbsIn.maxZ.data() + i) };
+        SimdFloat outMin[3], outMax[3];
+        for (int row = 0; row < 3; row++) {
+            outMin[row] = simdSet1(m[3][row]);
+            outMax[row] = outMin[row];
+            for (int col = 0; col < 3; col++) {
+                SimdFloat entry = simdSet1(m[col][row]);
+                SimdFloat a = simdMul(entry, inMin[col]);
+                SimdFloat b = simdMul(entry, inMax[col]);
+                outMin[row] = simdAdd(outMin[row], simdMin(a, b));
+                outMax[row] = simdAdd(outMax[row], simdMax(a, b));
+            }
+        }
+        simdStore(aabbsOut.minX.data() + i, outMin[0]);
+        simdStore(aabbsOut.minY.data() + i, outMin[1]);
+        simdStore(aabbsOut.minZ.data() + i, outMin[2]);
+        simdStore(aabbsOut.maxX.data() + i, outMax[0]);
+        simdStore(aabbsOut.maxY.data() + i, outMax[1]);
+        simdStore(aabbsOut.maxZ.data() + i, outMax[2]);
+    }
+#endif
+    for (; i < end; i++) {
+        float inMin[3] = { aabbsIn.minX[i], aabbsIn.minY[i], aabbsIn.minZ[i] };
+        float inMax[3] = { aabbsIn.maxX[i], aabbsIn.maxY[i], aabbsIn.maxZ[i] };
+        float outMin[3], outMax[3];
+        for (int row = 0; row < 3; row++) {
+            outMin[row] = m[3][row];
+            outMax[row] = m[3][row];
+            for (int col = 0; col < 3; col++) {
+                float a = m[col][row] * inMin[col];
+                float b = m[col][row] * inMax[col];
+                outMin[row] += std::min(a, b);
+                outMax[row] += std::max(a, b);
+            }
+        }
+        aabbsOut.minX[i] = outMin[0];
+        aabbsOut.minY[i] = outMin[1];
+        aabbsOut.minZ[i] = outMin[2];
+        aabbsOut.maxX[i] = outMax[0];
+        aabbsOut.maxY[i] = outMax[1];
+        aabbsOut.maxZ[i] = outMax[2];
+    }
+}
+
+void transformAABBs(const glm::mat4& matrix, const AABB3Batch& aabbsIn, AABB3Batch& aabbsOut) {
+    ZoneScoped;
+
+    const size_t numAabbs = aabbsIn.size();
+    aabbsOut.resize(numAabbs);
+    const size_t numBlocks = (numAabbs + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numAabbs, numBlocks, matrix, aabbsIn, aabbsOut) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t begin = blockIdx * BATCH_BLOCK_SIZE;
+        size_t end = std::min(begin + BATCH_BLOCK_SIZE, numAabbs);
+        transformAABBsRange(matrix, aabbsIn, aabbsOut, begin, end);
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+/// Plane coefficients with the absolute values of the normal precomputed for the AABB tests.
+struct BatchPlane {
+    float a, b, c, d;
+    float absA, absB, absC;
+};
+
+static uint64_t computeVisibilityMaskWordAABBs(
+        const BatchPlane* planes, int numPlanes, const AABB3Batch& aabbs, size_t begin, size_t end) {
+    uint64_t word = 0;
+    size_t i = begin;
+#ifdef SGL_GEOMETRY_BATCH_SIMD
+    const SimdFloat zero = simdSet1(0.0f);
+    const SimdFloat half = simdSet1(0.5f);
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        SimdFloat minX = simdLoad(aabbs.minX.data() + i);
+        SimdFloat minY = simdLoad(aabbs.minY.data() + i);
+        SimdFloat minZ = simdLoad(aabbs.minZ.data() + i);
+        SimdFloat maxX = simdLoad(aabbs.maxX.data() + i);
+        SimdFloat maxY = simdLoad(aabbs.maxY.data() + i);
+        SimdFloat maxZ = simdLoad(aabbs.maxZ.data() + i);
+        SimdFloat centerX = simdMul(simdAdd(minX, maxX), half);
+        SimdFloat centerY = simdMul(simdAdd(minY, maxY), half);
+        SimdFloat centerZ = simdMul(simdAdd(minZ, maxZ), half);
+        SimdFloat extentX = simdMul(simdSub(maxX, minX), half);
+        SimdFloat extentY = simdMul(simdSub(maxY, minY), half);
+        SimdFloat extentZ = simdMul(simdSub(maxZ, minZ), half);
+        SimdMask isOutside{};
+        for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+            const BatchPlane& plane = planes[planeIdx];
+            // Signed distance of the corner of the AABB furthest along the plane normal.
+            SimdFloat dist = simdAdd(simdMul(simdSet1(plane.a), centerX), simdSet1(plane.d));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.b), centerY));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.c), centerZ));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.absA), extentX));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.absB), extentY));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.absC), extentZ));
+            SimdMask isOutsidePlane = simdCmpLt(dist, zero);
+            isOutside = planeIdx == 0 ? isOutsidePlane : simdOr(isOutside, isOutsidePlane);
+        }
+        uint64_t isVisibleBits = ~uint64_t(simdMoveMask(isOutside)) & ((uint64_t(1) << SIMD_WIDTH) - 1);
+        word |= isVisibleBits << (i - begin);
+    }
+#endif
+    for (; i < end; i++) {
+        float centerX = (aabbs.minX[i] + aabbs.maxX[i]) * 0.5f;
+        float centerY = (aabbs.minY[i] + aabbs.maxY[i]) * 0.5f;
+        float centerZ = (aabbs.minZ[i] + aabbs.maxZ[i]) * 0.5f;
+        float extentX = (aabbs.maxX[i] - aabbs.minX[i]) * 0.5f;
+        float extentY = (aabbs.maxY[i] - aabbs.minY[i]) * 0.5f;
+        float extentZ = (aabbs.maxZ[i] - aabbs.minZ[i]) * 0.5f;
+        bool isOutside = false;
+        for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+            const BatchPlane& plane = planes[planeIdx];
+            float dist =
+                    plane.a * centerX + plane.d + plane.b * centerY + plane.c * centerZ
+                    + plane.absA * extentX + plane.absB * extentY + plane.absC * extentZ;
+            isOutside = isOutside || dist < 0.0f;
+        }
+        if (!isOutside) {
+            word |= uint64_t(1) << (i - begin);
+        }
+    }
+    return word;
+}
+
+static uint64_t computeVisibilityMaskWordSpheres(
+        const BatchPlane* planes, int numPlanes, const SphereBatch& spheres, size_t begin, size_t end) {
+    uint64_t word = 0;
+    size_t i = begin;
+#ifdef SGL_GEOMETRY_BATCH_SIMD
+    const SimdFloat zero = simdSet1(0.0f);
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        SimdFloat centerX = simdLoad(spheres.centerX.data() + i);
+        SimdFloat centerY = simdLoad(spheres.centerY.data() + i);
+        SimdFloat centerZ = simdLoad(spheres.centerZ.data() + i);
+        SimdFloat radius = simdLoad(spheres.radius.data() + i);
+        SimdMask isOutside{};
+        for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+            const BatchPlane& plane = planes[planeIdx];
+            SimdFloat dist = simdAdd(simdMul(simdSet1(plane.a), centerX), simdSet1(plane.d));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.b), centerY));
+            dist = simdAdd(dist, simdMul(simdSet1(plane.c), centerZ));
+            dist = simdAdd(dist, radius);
+            SimdMask isOutsidePlane = simdCmpLt(dist, zero);
+            isOutside = planeIdx == 0 ? isOutsidePlane : simdOr(isOutside, isOutsidePlane);
+        }
+        uint64_t isVisibleBits = ~uint64_t(simdMoveMask(isOutside)) & ((uint64_t(1) << SIMD_WIDTH) - 1);
+        word |= isVisibleBits << (i - begin);
+    }
+#endif
+    for (; i < end; i++) {
+        bool isOutside = false;
+        for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+            const BatchPlane& plane = planes[planeIdx];
+            float dist =
+                    plane.a * spheres.centerX[i] + plane.d + plane.b * spheres.centerY[i]
+                    + plane.c * spheres.centerZ[i] + spheres.radius[i];
+            isOutside = isOutside || dist < 0.0f;
+        }
+        if (!isOutside) {
+            word |= uint64_t(1) << (i - begin);
+        }
+    }
+    return word;
+}
+
+template<class BatchType, class WordFunction>
+static void computeVisibilityMaskParallel(
+        const Plane* planes, int numPlanes, const BatchType& batch, VisibilityMask& visibilityMask,
+        WordFunction computeWord) {
+    const size_t numPrimitives = batch.size();
+    const size_t numWords = (numPrimitives + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE;
+    visibilityMask.resize(numWords);
+    if (numPlanes <= 0) {
+        for (size_t wordIdx = 0; wordIdx < numWords; wordIdx++) {
+            size_t numBits = std::min(numPrimitives - wordIdx * BATCH_BLOCK_SIZE, BATCH_BLOCK_SIZE);
+            visibilityMask[wordIdx] = numBits == 64 ? ~uint64_t(0) : (uint64_t(1) << numBits) - 1;
+        }
+        return;
+    }
+
+    std::vector<BatchPlane> batchPlanes(numPlanes);
+    for (int planeIdx = 0; planeIdx < numPlanes; planeIdx++) {
+        const Plane& plane = planes[planeIdx];
+        batchPlanes[planeIdx] = {
+                plane.a, plane.b, plane.c, plane.d, std::abs(plane.a), std::abs(plane.b), std::abs(plane.c) };
+    }
+    const BatchPlane* batchPlanesPtr = batchPlanes.data();
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numWords), [&](auto const& r) {
+        for (auto wordIdx = r.begin(); wordIdx != r.end(); wordIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) \
+    shared(numPrimitives, numWords, batchPlanesPtr, numPlanes, batch, visibilityMask, computeWord)
+#endif
+    for (size_t wordIdx = 0; wordIdx < numWords; wordIdx++) {
+#endif
+        size_t begin = wordIdx * BATCH_BLOCK_SIZE;
+        size_t end = std::min(begin + BATCH_BLOCK_SIZE, numPrimitives);
+        visibilityMask[wordIdx] = computeWord(batchPlanesPtr, numPlanes, batch, begin, end);
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+void computeVisibilityMask(
+        const Plane* planes, int numPlanes, const AABB3Batch& aabbs, VisibilityMask& visibilityMask) {
+    ZoneScoped;
+    computeVisibilityMaskParallel(planes, numPlanes, aabbs, visibilityMask, computeVisibilityMaskWordAABBs);
+}
+
+void computeVisibilityMask(
+        const Plane* planes, int numPlanes, const SphereBatch& spheres, VisibilityMask& visibilityMask) {
+    ZoneScoped;
+    computeVisibilityMaskParallel(planes, numPlanes, spheres, visibilityMask, computeVisibilityMaskWordSpheres);
+}
+
+}
@@ -0,0 +1,130 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SRC_MATH_GEOMETRY_GEOMETRYBATCH_HPP_
+#define SRC_MATH_GEOMETRY_GEOMETRYBATCH_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <Defs.hpp>
+
+namespace sgl {
+
+class AABB3;
+class Sphere;
+class Plane;
+
+/**
+ * A batch of axis-aligned bounding boxes stored as a structure of arrays, which allows for processing multiple
+ * boxes at once with SIMD instructions.
+ */
+class DLL_OBJECT AABB3Batch {
+public:
+    AABB3Batch() = default;
+    explicit AABB3Batch(const std::vector<AABB3>& aabbs);
+
+    [[nodiscard]] inline size_t size() const { return minX.size(); }
+    [[nodiscard]] inline bool empty() const { return minX.empty(); }
+    void resize(size_t numAabbs);
+    void clear();
+    void reserve(size_t numAabbs);
+    void pushBack(const AABB3& aabb);
+    void setAABB(size_t idx, const AABB3& aabb);
+    [[nodiscard]] AABB3 getAABB(size_t idx) const;
+
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+};
+
+/**
+ * A batch of spheres stored as a structure of arrays.
+ */
+class DLL_OBJECT SphereBatch {
+public:
+    SphereBatch() = default;
+    explicit SphereBatch(const std::vector<Sphere>& spheres);
+
+    [[nodiscard]] inline size_t size() const { return centerX.size(); }
+    [[nodiscard]] inline bool empty() const { return centerX.empty(); }
+    void resize(size_t numSpheres);
+    void clear();
+    void reserve(size_t numSpheres);
+    void pushBack(const Sphere& sphere);
+    void setSphere(size_t idx, const Sphere& sphere);
+    [[nodiscard]] Sphere getSphere(size_t idx) const;
+
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> radius;
+};
+
+/**
+ * A visibility bitmask. Bit (i % 64) of word i / 64 is set if primitive i is visible.
+ * The bits after the last primitive in the last word are zero.
+ */
+typedef std::vector<uint64_t> VisibilityMask;
+
+inline bool getVisibilityMaskBit(const VisibilityMask& visibilityMask, size_t idx) {
+    return (visibilityMask[idx / 64] >> (idx % 64)) & uint64_t(1);
+}
+
+/// Returns the number of set bits in the visibility mask.
+DLL_OBJECT size_t getNumVisible(const VisibilityMask& visibilityMask);
+
+/// Appends the indices of all set bits in ascending order to visibleIndices.
+DLL_OBJECT void getVisibleIndices(const VisibilityMask& visibilityMask, std::vector<uint32_t>& visibleIndices);
+
+/**
+ * Transforms all AABBs by the passed matrix. The result is equal to @see AABB3::transformedFast for affine
+ * matrices, i.e., the last row of the matrix is assumed to be (0, 0, 0, 1).
+ * aabbsIn and aabbsOut may be the same object.
+ */
+DLL_OBJECT void transformAABBs(const glm::mat4& matrix, const AABB3Batch& aabbsIn, AABB3Batch& aabbsOut);
+
+/**
+ * Tests all AABBs against the passed planes (e.g., the six frustum planes of a camera). An AABB is visible if it is
+ * not completely on the negative side (@see Plane::isOutside) of any of the planes.
+ * @param planes The planes to test against.
+ * @param numPlanes The number of planes (usually 6).
+ * @param aabbs The AABBs to test.
+ * @param visibilityMask The output visibility bitmask with one bit per AABB.
+ */
+DLL_OBJECT void computeVisibilityMask(
+        const Plane* planes, int numPlanes, const AABB3Batch& aabbs, VisibilityMask& visibilityMask);
+
+/**
+ * Tests all spheres against the passed planes. A sphere is visible if the signed distance of its center to all
+ * planes is at least -radius.
+ */
+DLL_OBJECT void computeVisibilityMask(
+        const Plane* planes, int numPlanes, const SphereBatch& spheres, VisibilityMask& visibilityMask);
+
+}
+
+/*! SRC_MATH_GEOMETRY_GEOMETRYBATCH_HPP_ */
+#endif
@@ -26,6 +26,22 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cmath>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SGL_MATRIX_UTIL_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SGL_MATRIX_UTIL_NEON
+#endif
+
 #include "MatrixUtil.hpp"
 
 namespace sgl {
@@ -55,6 +71,277 @@ glm::vec2 transformDirection(const glm::mat4 &mat, const glm::vec2 &vec) {
 }
 
 
+/*
+ * Batched transforms.
+ */
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 must be tightly packed.");
+
+enum class BatchTransformType {
+    POINT_AFFINE, POINT_PROJECTIVE, DIRECTION, NORMAL
+};
+
+/// Number of vectors processed per parallel task.
+static const size_t TRANSFORM_BLOCK_SIZE = 16384;
+
+template<class Function>
+static void forEachTransformBlock(size_t n, Function transformRange) {
+    const size_t numBlocks = (n + TRANSFORM_BLOCK_SIZE - 1) / TRANSFORM_BLOCK_SIZE;
+    if (numBlocks <= 1) {
+        transformRange(size_t(0), n);
+        return;
+    }
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(n, numBlocks, transformRange) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t begin = blockIdx * TRANSFORM_BLOCK_SIZE;
+        transformRange(begin, std::min(begin + TRANSFORM_BLOCK_SIZE, n));
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+static inline void transformScalar(const glm::mat4& mat, BatchTransformType type, float& x, float& y, float& z) {
+    glm::vec4 v = mat[0] * x + mat[1] * y + mat[2] * z;
+    if (type == BatchTransformType::POINT_AFFINE || type == BatchTransformType::POINT_PROJECTIVE) {
+        v += mat[3];
+    }
+    if (type == BatchTransformType::POINT_PROJECTIVE) {
+        v /= v.w;
+    } else if (type == BatchTransformType::NORMAL) {
+        float length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        v = length > 0.0f ? v / length : glm::vec4(0.0f);
+    }
+    x = v.x;
+    y = v.y;
+    z = v.z;
+}
+
+#if defined(SGL_MATRIX_UTIL_SSE)
+typedef __m128 SimdFloat;
+#elif defined(SGL_MATRIX_UTIL_NEON)
+typedef float32x4_t SimdFloat;
+#endif
+
+#if defined(SGL_MATRIX_UTIL_SSE) || defined(SGL_MATRIX_UTIL_NEON)
+/// The matrix entries broadcast to all lanes.
+struct SimdMatrix {
+    explicit SimdMatrix(const glm::mat4& mat) {
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+#if defined(SGL_MATRIX_UTIL_SSE)
+                m[col][row] = _mm_set1_ps(mat[col][row]);
+#else
+                m[col][row] = vdupq_n_f32(mat[col][row]);
+#endif
+            }
+        }
+    }
+    SimdFloat m[4][4];
+};
+
+/// Transforms four vectors stored as structure of arrays.
+static inline void transformSimd(
+        const SimdMatrix& mat, BatchTransformType type, SimdFloat& x, SimdFloat& y, SimdFloat& z) {
+    SimdFloat v[4];
+#if defined(SGL_MATRIX_UTIL_SSE)
+    for (int row = 0; row < 4; row++) {
+        v[row] = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(mat.m[0][row], x), _mm_mul_ps(mat.m[1][row], y)), _mm_mul_ps(mat.m[2][row], z));
+        if (type == BatchTransformType::POINT_AFFINE || type == BatchTransformType::POINT_PROJECTIVE) {
+            v[row] = _mm_add_ps(v[row], mat.m[3][row]);
+        }
+    }
+    if (type == BatchTransformType::POINT_PROJECTIVE) {
+        for (int row = 0; row < 3; row++) {
+            v[row] = _mm_div_ps(v[row], v[3]);
+        }
+    } else if (type == BatchTransformType::NORMAL) {
+        __m128 lengthSquared = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(v[0], v[0]), _mm_mul_ps(v[1], v[1])), _mm_mul_ps(v[2], v[2]));
+        __m128 length = _mm_sqrt_ps(lengthSquared);
+        // Zero vectors stay zero.
+        __m128 invLength = _mm_and_ps(
+                _mm_cmpgt_ps(length, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(1.0f), length));
+        for (int row = 0; row < 3; row++) {
+            v[row] = _mm_mul_ps(v[row], invLength);
+        }
+    }
+#else
+    for (int row = 0; row < 4; row++) {
+        v[row] = vmlaq_f32(vmlaq_f32(vmulq_f32(mat.m[0][row], x), mat.m[1][row], y), mat.m[2][row], z);
+        if (type == BatchTransformType::POINT_AFFINE || type == BatchTransformType::POINT_PROJECTIVE) {
+            v[row] = vaddq_f32(v[row], mat.m[3][row]);
+        }
+    }
+    if (type == BatchTransformType::POINT_PROJECTIVE) {
+        for (int row = 0; row < 3; row++) {
+            v[row] = vdivq_f32(v[row], v[3]);
+        }
+    } else if (type == BatchTransformType::NORMAL) {
+        float32x4_t lengthSquared = vmlaq_f32(vmlaq_f32(vmulq_f32(v[0], v[0]), v[1], v[1]), v[2], v[2]);
+        float32x4_t length = vsqrtq_f32(lengthSquared);
+        // Zero vectors stay zero.
+        uint32x4_t isNonZero = vcgtq_f32(length, vdupq_n_f32(0.0f));
+        float32x4_t invLength = vreinterpretq_f32_u32(vandq_u32(
+                isNonZero, vreinterpretq_u32_f32(vdivq_f32(vdupq_n_f32(1.0f), length))));
+        for (int row = 0; row < 3; row++) {
+            v[row] = vmulq_f32(v[row], invLength);
+        }
+    }
+#endif
+    x = v[0];
+    y = v[1];
+    z = v[2];
+}
+#endif
+
+static void transformVec3Range(
+        const glm::mat4& mat, BatchTransformType type, const glm::vec3* vecsIn, glm::vec3* vecsOut,
+        size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(SGL_MATRIX_UTIL_SSE)
+    const SimdMatrix simdMatrix(mat);
+    for (; i + 4 <= end; i += 4) {
+        // Load the vectors [x0 y0 z0 x1], [y1 z1 x2 y2], [z2 x3 y3 z3] and transpose them.
+        const float* src = &vecsIn[i].x;
+        __m128 a = _mm_loadu_ps(src);
+        __m128 b = _mm_loadu_ps(src + 4);
+        __m128 c = _mm_loadu_ps(src + 8);
+        __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+        __m128 y = _mm_shuffle_ps(
+                _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 z = _mm_shuffle_ps(
+                _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                _MM_SHUFFLE(2, 0, 2, 0));
+        transformSimd(simdMatrix, type, x, y, z);
+        a = _mm_shuffle_ps(
+                _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                _MM_SHUFFLE(2, 0, 2, 0));
+        b = _mm_shuffle_ps(
+                _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                _MM_SHUFFLE(2, 0, 2, 0));
+        c = _mm_shuffle_ps(
+                _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)), _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                _MM_SHUFFLE(2, 0, 2, 0));
+        float* dst = &vecsOut[i].x;
+        _mm_storeu_ps(dst, a);
+        _mm_storeu_ps(dst + 4, b);
+        _mm_storeu_ps(dst + 8, c);
+    }
+#elif defined(SGL_MATRIX_UTIL_NEON)
+    const SimdMatrix simdMatrix(mat);
+    for (; i + 4 <= end; i += 4) {
+        float32x4x3_t v = vld3q_f32(&vecsIn[i].x);
+        transformSimd(simdMatrix, type, v.val[0], v.val[1], v.val[2]);
+        vst3q_f32(&vecsOut[i].x, v);
+    }
+#endif
+    for (; i < end; i++) {
+        glm::vec3 v = vecsIn[i];
+        transformScalar(mat, type, v.x, v.y, v.z);
+        vecsOut[i] = v;
+    }
+}
+
+static void transformSoARange(
+        const glm::mat4& mat, BatchTransformType type, const float* xIn, const float* yIn, const float* zIn,
+        float* xOut, float* yOut, float* zOut, size_t begin, size_t end) {
+    size_t i = begin;
+#if defined(SGL_MATRIX_UTIL_SSE)
+    const SimdMatrix simdMatrix(mat);
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(xIn + i);
+        __m128 y = _mm_loadu_ps(yIn + i);
+        __m128 z = _mm_loadu_ps(zIn + i);
+        transformSimd(simdMatrix, type, x, y, z);
+        _mm_storeu_ps(xOut + i, x);
+        _mm_storeu_ps(yOut + i, y);
+        _mm_storeu_ps(zOut + i, z);
+    }
+#elif defined(SGL_MATRIX_UTIL_NEON)
+    const SimdMatrix simdMatrix(mat);
+    for (; i + 4 <= end; i += 4) {
+        float32x4_t x = vld1q_f32(xIn + i);
+        float32x4_t y = vld1q_f32(yIn + i);
+        float32x4_t z = vld1q_f32(zIn + i);
+        transformSimd(simdMatrix, type, x, y, z);
+        vst1q_f32(xOut + i, x);
+        vst1q_f32(yOut + i, y);
+        vst1q_f32(zOut + i, z);
+    }
+#endif
+    for (; i < end; i++) {
+        float x = xIn[i], y = yIn[i], z = zIn[i];
+        transformScalar(mat, type, x, y, z);
+        xOut[i] = x;
+        yOut[i] = y;
+        zOut[i] = z;
+    }
+}
+
+static inline BatchTransformType getPointTransformType(const glm::mat4& mat) {
+    bool isAffine = mat[0][3] == 0.0f && mat[1][3] == 0.0f && mat[2][3] == 0.0f && mat[3][3] == 1.0f;
+    return isAffine ? BatchTransformType::POINT_AFFINE : BatchTransformType::POINT_PROJECTIVE;
+}
+
+void transformPoints(const glm::mat4 &mat, const glm::vec3* pointsIn, glm::vec3* pointsOut, size_t n) {
+    BatchTransformType type = getPointTransformType(mat);
+    forEachTransformBlock(n, [&](size_t begin, size_t end) {
+        transformVec3Range(mat, type, pointsIn, pointsOut, begin, end);
+    });
+}
+
+void transformDirections(const glm::mat4 &mat, const glm::vec3* dirsIn, glm::vec3* dirsOut, size_t n) {
+    forEachTransformBlock(n, [&](size_t begin, size_t end) {
+        transformVec3Range(mat, BatchTransformType::DIRECTION, dirsIn, dirsOut, begin, end);
+    });
+}
+
+void transformNormals(const glm::mat4 &mat, const glm::vec3* normalsIn, glm::vec3* normalsOut, size_t n) {
+    glm::mat4 normalMatrix(glm::transpose(glm::inverse(glm::mat3(mat))));
+    forEachTransformBlock(n, [&](size_t begin, size_t end) {
+        transformVec3Range(normalMatrix, BatchTransformType::NORMAL, normalsIn, normalsOut, begin, end);
+    });
+}
+
+void transformPoints(const glm::mat4 &mat, std::vector<glm::vec3>& points) {
+    transformPoints(mat, points.data(), points.data(), points.size());
+}
+
+void transformDirections(const glm::mat4 &mat, std::vector<glm::vec3>& directions) {
+    transformDirections(mat, directions.data(), directions.data(), directions.size());
+}
+
+void transformNormals(const glm::mat4 &mat, std::vector<glm::vec3>& normals) {
+    transformNormals(mat, normals.data(), normals.data(), normals.size());
+}
+
+void transformPointsSoA(
+        const glm::mat4 &mat, const float* xIn, const float* yIn, const float* zIn,
+        float* xOut, float* yOut, float* zOut, size_t n) {
+    BatchTransformType type = getPointTransformType(mat);
+    forEachTransformBlock(n, [&](size_t begin, size_t end) {
+        transformSoARange(mat, type, xIn, yIn, zIn, xOut, yOut, zOut, begin, end);
+    });
+}
+
+void transformDirectionsSoA(
+        const glm::mat4 &mat, const float* xIn, const float* yIn, const float* zIn,
+        float* xOut, float* yOut, float* zOut, size_t n) {
+    forEachTransformBlock(n, [&](size_t begin, size_t end) {
+        transformSoARange(mat, BatchTransformType::DIRECTION, xIn, yIn, zIn, xOut, yOut, zOut, begin, end);
+    });
+}
+
+
 glm::mat4 matrixTranslation(const glm::vec3 &v) {
     /*return glm::translate(glm::vec3(v.x, v.y, v.z));*/
     return glm::mat4(1.0f, 0.0f, 0.0f, 0.0f,
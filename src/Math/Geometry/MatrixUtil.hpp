@@ -30,6 +30,7 @@
 #define SRC_MATH_GEOMETRY_MATRIXUTIL_HPP_
 
 #define GLM_ENABLE_EXPERIMENTAL
+#include <vector>
 #include <Defs.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
@@ -41,6 +42,31 @@ DLL_OBJECT glm::vec3 transformDirection(const glm::mat4 &mat, const glm::vec3 &v
 DLL_OBJECT glm::vec2 transformPoint(const glm::mat4 &mat, const glm::vec2 &vec);
 DLL_OBJECT glm::vec2 transformDirection(const glm::mat4 &mat, const glm::vec2 &vec);
 
+/**
+ * Batched versions of transformPoint and transformDirection for large arrays (e.g., the vertices of a mesh or a
+ * point cloud). Four vectors are processed at once using SSE or NEON, and large arrays are split across threads.
+ * The input and output arrays may be identical (in-place transform), but must not overlap otherwise.
+ * For points, the division by w is skipped if the last row of the matrix is (0, 0, 0, 1).
+ */
+DLL_OBJECT void transformPoints(const glm::mat4 &mat, const glm::vec3* pointsIn, glm::vec3* pointsOut, size_t n);
+DLL_OBJECT void transformDirections(const glm::mat4 &mat, const glm::vec3* dirsIn, glm::vec3* dirsOut, size_t n);
+/// Transforms normals by the inverse transpose of the upper 3x3 matrix and normalizes them.
+DLL_OBJECT void transformNormals(const glm::mat4 &mat, const glm::vec3* normalsIn, glm::vec3* normalsOut, size_t n);
+DLL_OBJECT void transformPoints(const glm::mat4 &mat, std::vector<glm::vec3>& points);
+DLL_OBJECT void transformDirections(const glm::mat4 &mat, std::vector<glm::vec3>& directions);
+DLL_OBJECT void transformNormals(const glm::mat4 &mat, std::vector<glm::vec3>& normals);
+
+/**
+ * Structure-of-arrays variants of the batched transform functions, where the x, y and z components are stored in
+ * separate arrays. Again, the input and output arrays may be identical.
+ */
+DLL_OBJECT void transformPointsSoA(
+        const glm::mat4 &mat, const float* xIn, const float* yIn, const float* zIn,
+        float* xOut, float* yOut, float* zOut, size_t n);
+DLL_OBJECT void transformDirectionsSoA(
+        const glm::mat4 &mat, const float* xIn, const float* yIn, const float* zIn,
+        float* xOut, float* yOut, float* zOut, size_t n);
+
 /// Special types of matrices
 inline     glm::mat4 matrixIdentity() {return glm::mat4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);}
 inline     glm::mat4 matrixZero() {return glm::mat4(0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f);}
@@ -33,6 +33,8 @@
 #include <ImGui/ImGuiWrapper.hpp>
 #include <Utils/AppSettings.hpp>
 #include <Utils/Events/EventManager.hpp>
+#include <Utils/File/ResourceManager.hpp>
+#include <Utils/File/PathWatchManager.hpp>
 #include <Input/Mouse.hpp>
 #include <Input/Keyboard.hpp>
 #include <Input/Gamepad.hpp>
@@ -197,6 +199,8 @@ void AppLogic::run() {
 }
 
 void AppLogic::updateBase(float dt) {
+    ResourceManager::get()->update();
+    PathWatchManager::get()->update();
     EventManager::get()->update();
     if (Keyboard->keyPressed(SDLK_PRINTSCREEN)
             || ((Keyboard->getModifier()&KMOD_CTRL) && Keyboard->keyPressed(SDLK_p))) {
@@ -32,6 +32,10 @@
 #include <cstddef>
 #include <cassert>
 
+/**
+ * Growable circular queue, which is not thread-safe.
+ * For lock-free producer/consumer queues between threads, please refer to Utils/Parallel/RingBuffer.hpp.
+ */
 template<class T>
 class CircularQueue {
 public:
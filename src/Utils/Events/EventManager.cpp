@@ -26,41 +26,229 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <Utils/Parallel/RingBuffer.hpp>
 #include "EventManager.hpp"
 
 namespace sgl {
 
+/// Maximum number of events taken from the queue at once.
+static const size_t MAX_EVENT_BATCH_SIZE = 256;
+/// Number of slots of the typed event ring buffer.
+static const size_t TYPED_EVENT_QUEUE_CAPACITY = 4096;
+
+/*
+ * The event memory pool uses size classes of 32 bytes up to 512 bytes. Larger blocks use the system allocator.
+ * The pool is never destroyed, as events may still be released during the destruction of static objects.
+ */
+static const size_t EVENT_MEMORY_BLOCK_GRANULARITY = 32;
+static const size_t EVENT_MEMORY_NUM_SIZE_CLASSES = 16;
+static const size_t EVENT_MEMORY_BLOCKS_PER_CHUNK = 64;
+
+struct EventMemoryPool {
+    struct SizeClass {
+        std::mutex mutex;
+        std::vector<void*> freeBlocks;
+    };
+    SizeClass sizeClasses[EVENT_MEMORY_NUM_SIZE_CLASSES];
+};
+
+static EventMemoryPool* getEventMemoryPool() {
+    static auto* eventMemoryPool = new EventMemoryPool;
+    return eventMemoryPool;
+}
+
+void* allocateEventMemory(size_t numBytes) {
+    size_t sizeClassIdx = (numBytes + EVENT_MEMORY_BLOCK_GRANULARITY - 1) / EVENT_MEMORY_BLOCK_GRANULARITY - 1;
+    if (numBytes == 0 || sizeClassIdx >= EVENT_MEMORY_NUM_SIZE_CLASSES) {
+        return ::operator new(numBytes);
+    }
+    EventMemoryPool::SizeClass& sizeClass = getEventMemoryPool()->sizeClasses[sizeClassIdx];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    if (sizeClass.freeBlocks.empty()) {
+        // Blocks are allocated in chunks; the chunks are never freed.
+        size_t blockSize = (sizeClassIdx + 1) * EVENT_MEMORY_BLOCK_GRANULARITY;
+        auto* chunk = static_cast<uint8_t*>(::operator new(blockSize * EVENT_MEMORY_BLOCKS_PER_CHUNK));
+        sizeClass.freeBlocks.reserve(sizeClass.freeBlocks.capacity() + EVENT_MEMORY_BLOCKS_PER_CHUNK);
+        for (size_t i = 0; i < EVENT_MEMORY_BLOCKS_PER_CHUNK; i++) {
+            sizeClass.freeBlocks.push_back(chunk + blockSize * (EVENT_MEMORY_BLOCKS_PER_CHUNK - i - 1));
+        }
+    }
+    void* block = sizeClass.freeBlocks.back();
+    sizeClass.freeBlocks.pop_back();
+    return block;
+}
+
+void deallocateEventMemory(void* ptr, size_t numBytes) {
+    size_t sizeClassIdx = (numBytes + EVENT_MEMORY_BLOCK_GRANULARITY - 1) / EVENT_MEMORY_BLOCK_GRANULARITY - 1;
+    if (numBytes == 0 || sizeClassIdx >= EVENT_MEMORY_NUM_SIZE_CLASSES) {
+        ::operator delete(ptr);
+        return;
+    }
+    EventMemoryPool::SizeClass& sizeClass = getEventMemoryPool()->sizeClasses[sizeClassIdx];
+    std::lock_guard<std::mutex> lock(sizeClass.mutex);
+    sizeClass.freeBlocks.push_back(ptr);
+}
+
+
+struct TypedEventRecord {
+    uint32_t eventType;
+    uint32_t payloadSize;
+    alignas(16) uint8_t payload[MAX_TYPED_EVENT_PAYLOAD_SIZE];
+};
+
+/**
+ * Lock-free ring buffer storing the payloads of typed events inline. If the ring buffer is full, the events are
+ * appended to a mutex-protected overflow list. While overflow records are pending, new events are also appended to the
+ * overflow list, which is dispatched once the ring buffer has been drained. This keeps the events in FIFO order.
+ */
+struct TypedEventQueue {
+    TypedEventQueue() : ringBuffer(TYPED_EVENT_QUEUE_CAPACITY) {}
+
+    void push(uint32_t eventType, const void* payload, size_t payloadSize) {
+        TypedEventRecord record;
+        record.eventType = eventType;
+        record.payloadSize = uint32_t(payloadSize);
+        if (payloadSize > 0) {
+            memcpy(record.payload, payload, payloadSize);
+        }
+        if (hasOverflowRecords.load(std::memory_order_acquire) || !ringBuffer.tryPush(record)) {
+            std::lock_guard<std::mutex> lock(overflowMutex);
+            overflowRecords.push_back(record);
+            hasOverflowRecords = true;
+        }
+    }
+
+    MpmcRingBuffer<TypedEventRecord> ringBuffer;
+    std::mutex overflowMutex;
+    std::vector<TypedEventRecord> overflowRecords;
+    std::atomic<bool> hasOverflowRecords{false};
+};
+
+
 EventManager::EventManager() {
     listenerCounter = 0;
+    typedEventQueue = new TypedEventQueue;
+}
+
+EventManager::~EventManager() {
+    delete typedEventQueue;
+    typedEventQueue = nullptr;
 }
 
 void EventManager::update() {
-    while (!eventQueue.empty()) {
-        EventPtr event = eventQueue.front();
-        eventQueue.pop_front();
-        triggerEvent(event);
+    // A local batch allows update to be called recursively by a listener.
+    std::vector<EventPtr> batch;
+    batch.swap(eventBatch);
+    EventPtr event;
+    while (true) {
+        bool hasDispatchedTypedEvents = dispatchTypedEvents();
+        while (batch.size() < MAX_EVENT_BATCH_SIZE && eventQueue.tryPop(event)) {
+            batch.push_back(std::move(event));
+        }
+        if (batch.empty() && !hasDispatchedTypedEvents) {
+            break;
+        }
+        for (const EventPtr& batchEvent : batch) {
+            triggerEvent(batchEvent);
+        }
+        batch.clear();
     }
+    batch.swap(eventBatch);
+}
+
+bool EventManager::dispatchTypedEvents() {
+    bool hasDispatchedEvents = false;
+    TypedEventRecord record;
+    bool isRingBufferEmpty = false;
+    for (size_t i = 0; i < MAX_EVENT_BATCH_SIZE; i++) {
+        if (!typedEventQueue->ringBuffer.tryPop(record)) {
+            isRingBufferEmpty = true;
+            break;
+        }
+        triggerTypedEventData(record.eventType, record.payload, record.payloadSize);
+        hasDispatchedEvents = true;
+    }
+    // The overflow records are newer than all records in the ring buffer, so they may only be dispatched afterwards.
+    if (isRingBufferEmpty && typedEventQueue->hasOverflowRecords.load(std::memory_order_acquire)) {
+        std::vector<TypedEventRecord> overflowRecords;
+        {
+            std::lock_guard<std::mutex> lock(typedEventQueue->overflowMutex);
+            overflowRecords.swap(typedEventQueue->overflowRecords);
+            typedEventQueue->hasOverflowRecords = false;
+        }
+        for (const TypedEventRecord& overflowRecord : overflowRecords) {
+            triggerTypedEventData(overflowRecord.eventType, overflowRecord.payload, overflowRecord.payloadSize);
+            hasDispatchedEvents = true;
+        }
+    }
+    return hasDispatchedEvents;
 }
 
 ListenerToken EventManager::addListener(uint32_t eventType, const EventFunc& func) {
     ListenerToken token = listenerCounter++;
+    if (dispatchDepth > 0) {
+        pendingListeners.emplace_back(eventType, EventListener{ token, func, nullptr, nullptr, false });
+    } else {
+        listeners[eventType].push_back(EventListener{ token, func, nullptr, nullptr, false });
+    }
+    return token;
+}
 
-    EventFuncList &eventListenerList = listeners[eventType];
-    eventListenerList.push_back(make_pair(token, func));
-
+ListenerToken EventManager::addTypedListener(uint32_t eventType, TypedEventFunc func, void* context) {
+    ListenerToken token = listenerCounter++;
+    if (dispatchDepth > 0) {
+        pendingListeners.emplace_back(eventType, EventListener{ token, {}, func, context, false });
+    } else {
+        listeners[eventType].push_back(EventListener{ token, {}, func, context, false });
+    }
     return token;
 }
 
 void EventManager::removeListener(uint32_t eventType, ListenerToken token) {
-    EventFuncList &listenerList = listeners[eventType];
+    for (auto it = pendingListeners.begin(); it != pendingListeners.end(); it++) {
+        if (it->second.token == token) {
+            pendingListeners.erase(it);
+            return;
+        }
+    }
+
+    auto mapEntry = listeners.find(eventType);
+    if (mapEntry == listeners.end()) {
+        return;
+    }
+    EventListenerList& listenerList = mapEntry->second;
     for (auto it = listenerList.begin(); it != listenerList.end(); it++) {
-        if (it->first == token) {
-            listenerList.erase(it);
+        if (it->token == token) {
+            if (dispatchDepth > 0) {
+                // The listener function may currently be executing.
+                it->isRemoved = true;
+                hasRemovedListeners = true;
+            } else {
+                listenerList.erase(it);
+            }
             return;
         }
     }
 }
 
+void EventManager::applyPendingListenerChanges() {
+    if (hasRemovedListeners) {
+        for (auto& mapEntry : listeners) {
+            EventListenerList& listenerList = mapEntry.second;
+            listenerList.erase(std::remove_if(
+                    listenerList.begin(), listenerList.end(),
+                    [](const EventListener& listener) { return listener.isRemoved; }), listenerList.end());
+        }
+        hasRemovedListeners = false;
+    }
+    for (auto& pendingListener : pendingListeners) {
+        listeners[pendingListener.first].push_back(std::move(pendingListener.second));
+    }
+    pendingListeners.clear();
+}
+
 // Event function is called instantly
 void EventManager::triggerEvent(const EventPtr& event) {
     auto mapEntry = listeners.find(event->getType());
@@ -68,14 +256,74 @@ void EventManager::triggerEvent(const EventPtr& event) {
         return;
     }
 
-    for (auto& it : mapEntry->second) {
-        it.second(event);
+    // References to the elements of an unordered_map stay valid, and the list does not grow during the iteration.
+    EventListenerList& listenerList = mapEntry->second;
+    dispatchDepth++;
+    const size_t numListeners = listenerList.size();
+    for (size_t i = 0; i < numListeners; i++) {
+        EventListener& listener = listenerList[i];
+        if (listener.isRemoved) {
+            continue;
+        }
+        if (listener.func) {
+            listener.func(event);
+        } else {
+            auto* payloadEvent = dynamic_cast<PayloadEvent*>(event.get());
+            TypedEvent typedEvent{ event->getType(), 0, nullptr };
+            if (payloadEvent) {
+                typedEvent = payloadEvent->getTypedEvent();
+            }
+            listener.typedFunc(listener.context, typedEvent);
+        }
+    }
+    dispatchDepth--;
+
+    if (dispatchDepth == 0 && (hasRemovedListeners || !pendingListeners.empty())) {
+        applyPendingListenerChanges();
     }
 }
 
 // Adds an event to the event queue, which is updated by calling the function "update"
 void EventManager::queueEvent(const EventPtr& event) {
-    eventQueue.push_back(event);
+    eventQueue.push(event);
+}
+
+void EventManager::triggerTypedEventData(uint32_t eventType, const void* payload, size_t payloadSize) {
+    auto mapEntry = listeners.find(eventType);
+    if (mapEntry == listeners.end()) {
+        return;
+    }
+
+    EventListenerList& listenerList = mapEntry->second;
+    TypedEvent typedEvent{ eventType, uint32_t(payloadSize), payload };
+    // Only created if an EventPtr listener exists.
+    EventPtr payloadEvent;
+    dispatchDepth++;
+    const size_t numListeners = listenerList.size();
+    for (size_t i = 0; i < numListeners; i++) {
+        EventListener& listener = listenerList[i];
+        if (listener.isRemoved) {
+            continue;
+        }
+        if (listener.typedFunc) {
+            listener.typedFunc(listener.context, typedEvent);
+        } else {
+            if (!payloadEvent) {
+                payloadEvent = makeEvent<PayloadEvent>(eventType, payload, payloadSize);
+            }
+            listener.func(payloadEvent);
+        }
+    }
+    dispatchDepth--;
+
+    if (dispatchDepth == 0 && (hasRemovedListeners || !pendingListeners.empty())) {
+        applyPendingListenerChanges();
+    }
+}
+
+void EventManager::queueTypedEventData(uint32_t eventType, const void* payload, size_t payloadSize) {
+    assert(payloadSize <= MAX_TYPED_EVENT_PAYLOAD_SIZE);
+    typedEventQueue->push(eventType, payload, payloadSize);
 }
 
 }
@@ -30,12 +30,17 @@
 #define SRC_UTILS_EVENTS_EVENTMANAGER_HPP_
 
 #include <cstdint>
-#include <map>
-#include <list>
+#include <cstring>
+#include <cassert>
+#include <vector>
+#include <unordered_map>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <type_traits>
 #include "Stream/Stream.hpp"
 #include <Utils/Singleton.hpp>
+#include <Utils/Parallel/MpscQueue.hpp>
 
 namespace sgl {
 
@@ -43,7 +48,55 @@ class Event;
 typedef std::shared_ptr<Event> EventPtr;
 typedef std::function<void(const EventPtr&)> EventFunc;
 typedef uint32_t ListenerToken;
-typedef std::list<std::pair<ListenerToken, EventFunc>> EventFuncList;
+
+/// Maximum size of the payload of events queued via @see EventManager::queueTypedEvent.
+const size_t MAX_TYPED_EVENT_PAYLOAD_SIZE = 64;
+
+/// View of a typed event passed to typed listeners. The payload is only valid during the call of the listener.
+struct TypedEvent {
+    uint32_t eventType;
+    uint32_t payloadSize;
+    const void* payload;
+
+    template<class T>
+    [[nodiscard]] inline const T& getPayload() const {
+        assert(sizeof(T) == payloadSize);
+        return *reinterpret_cast<const T*>(payload);
+    }
+};
+/// Typed listeners are plain function pointers with a user-defined context (e.g., a pointer to an object).
+typedef void (*TypedEventFunc)(void* context, const TypedEvent& event);
+
+struct EventListener {
+    ListenerToken token;
+    /// Either func or typedFunc is set.
+    EventFunc func;
+    TypedEventFunc typedFunc;
+    void* context;
+    /// Listeners removed while events are dispatched are only marked and erased afterwards.
+    bool isRemoved;
+};
+typedef std::vector<EventListener> EventListenerList;
+
+/*
+ * Memory pool for events. Blocks are recycled instead of being returned to the system allocator.
+ * Thread-safe, as events are usually created on worker threads and released on the main thread.
+ */
+DLL_OBJECT void* allocateEventMemory(size_t numBytes);
+DLL_OBJECT void deallocateEventMemory(void* ptr, size_t numBytes);
+
+/// Allocator for std::allocate_shared using the event memory pool (@see EventManager::makeEvent).
+template<class T>
+class EventPoolAllocator {
+public:
+    typedef T value_type;
+    EventPoolAllocator() noexcept = default;
+    template<class U> explicit EventPoolAllocator(const EventPoolAllocator<U>&) noexcept {}
+    T* allocate(size_t n) { return static_cast<T*>(allocateEventMemory(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t n) noexcept { deallocateEventMemory(ptr, n * sizeof(T)); }
+    template<class U> bool operator==(const EventPoolAllocator<U>&) const noexcept { return true; }
+    template<class U> bool operator!=(const EventPoolAllocator<U>&) const noexcept { return false; }
+};
 
 class DLL_OBJECT Event {
 public:
@@ -57,27 +110,113 @@ private:
     uint32_t eventType;
 };
 
+/// Event carrying the payload of a typed event, which is passed to listeners registered via addListener.
+class DLL_OBJECT PayloadEvent : public Event {
+public:
+    PayloadEvent(uint32_t eventType, const void* payloadData, size_t payloadSize)
+            : Event(eventType), payloadSize(uint32_t(payloadSize)) {
+        assert(payloadSize <= MAX_TYPED_EVENT_PAYLOAD_SIZE);
+        if (payloadSize > 0) {
+            memcpy(payload, payloadData, payloadSize);
+        }
+    }
+    [[nodiscard]] inline TypedEvent getTypedEvent() const { return { getType(), payloadSize, payload }; }
+    template<class T>
+    [[nodiscard]] inline const T& getPayload() const {
+        assert(sizeof(T) == payloadSize);
+        return *reinterpret_cast<const T*>(payload);
+    }
+
+private:
+    uint32_t payloadSize;
+    alignas(16) uint8_t payload[MAX_TYPED_EVENT_PAYLOAD_SIZE];
+};
+
+struct TypedEventQueue;
+
+/**
+ * Dispatches events to the listeners registered for their type.
+ * queueEvent and queueTypedEvent may be called from any thread (e.g., by loader or compute worker threads); the queued
+ * events are dispatched on the main thread when calling @see update. All other functions except for makeEvent may only
+ * be called on the main thread.
+ *
+ * For high-frequency events (e.g., input or progress events), the typed event path avoids all allocations: Small
+ * trivially copyable payloads are copied into a ring buffer and passed to function pointer listeners. Both kinds of
+ * listeners receive both kinds of events. EventPtr listeners receive typed events as a @see PayloadEvent (which is
+ * only created if such a listener exists), and typed listeners receive the payload of PayloadEvent objects (or no
+ * payload for other events).
+ *
+ * Example usage:
+ * struct ProgressPayload { uint32_t taskId; float progress; };
+ * EventManager::get()->addTypedListener(PROGRESS_EVENT, [](void* context, const TypedEvent& event) {
+ *     static_cast<ProgressBar*>(context)->setProgress(event.getPayload<ProgressPayload>().progress);
+ * }, progressBar);
+ * // On a worker thread:
+ * EventManager::get()->queueTypedEvent(PROGRESS_EVENT, ProgressPayload{ taskId, 0.5f });
+ */
 class DLL_OBJECT EventManager : public Singleton<EventManager> {
 public:
     EventManager();
+    ~EventManager();
+    /// Dispatches all queued events (including events queued by listeners during the call).
     void update();
 
     /// Creates a listener
     ListenerToken addListener(uint32_t eventType, const EventFunc& func);
+    /// Creates a listener for the typed event path. 'context' is passed to every call of 'func'.
+    ListenerToken addTypedListener(uint32_t eventType, TypedEventFunc func, void* context = nullptr);
+    /// Removes both kinds of listeners.
     void removeListener(uint32_t eventType, ListenerToken token);
 
     /// Event function is called instantly
     void triggerEvent(const EventPtr& event);
-    /// Adds an event to the event queue, which is updated by calling the function "update"
+    /// Adds an event to the event queue, which is updated by calling the function "update". Lock-free and thread-safe.
     void queueEvent(const EventPtr& event);
-    //bool threadSafeQueueEvent(const EventDataPtr &event);
 
+    /// Creates an event whose memory is recycled from a pool (instead of std::make_shared). Thread-safe.
+    template<class T, class... Args>
+    static std::shared_ptr<T> makeEvent(Args&&... args) {
+        return std::allocate_shared<T>(EventPoolAllocator<T>(), std::forward<Args>(args)...);
+    }
+
+    /// Calls the listeners of the typed event instantly.
+    template<class T>
+    void triggerTypedEvent(uint32_t eventType, const T& payload) {
+        static_assert(std::is_trivially_copyable<T>::value, "The payload of typed events must be trivially copyable.");
+        static_assert(sizeof(T) <= MAX_TYPED_EVENT_PAYLOAD_SIZE, "The payload of the typed event is too large.");
+        triggerTypedEventData(eventType, &payload, sizeof(T));
+    }
+    void triggerTypedEvent(uint32_t eventType) { triggerTypedEventData(eventType, nullptr, 0); }
+    void triggerTypedEventData(uint32_t eventType, const void* payload, size_t payloadSize);
+
+    /// Copies the payload to the typed event queue. Lock-free (unless the queue is full) and thread-safe.
+    template<class T>
+    void queueTypedEvent(uint32_t eventType, const T& payload) {
+        static_assert(std::is_trivially_copyable<T>::value, "The payload of typed events must be trivially copyable.");
+        static_assert(sizeof(T) <= MAX_TYPED_EVENT_PAYLOAD_SIZE, "The payload of the typed event is too large.");
+        static_assert(alignof(T) <= 16, "The payload of typed events may be at most 16-byte aligned.");
+        queueTypedEventData(eventType, &payload, sizeof(T));
+    }
+    void queueTypedEvent(uint32_t eventType) { queueTypedEventData(eventType, nullptr, 0); }
+    void queueTypedEventData(uint32_t eventType, const void* payload, size_t payloadSize);
 
 private:
-    std::map<uint32_t, EventFuncList> listeners;
-    std::list<EventPtr> eventQueue;
+    void applyPendingListenerChanges();
+    bool dispatchTypedEvents();
+
+    std::unordered_map<uint32_t, EventListenerList> listeners;
+    /// Listeners added while events are dispatched (the listener lists may not grow during iteration).
+    std::vector<std::pair<uint32_t, EventListener>> pendingListeners;
+    bool hasRemovedListeners = false;
+    int dispatchDepth = 0;
     uint32_t listenerCounter;
-    //MultithreadedQueue<EventPtr> threadSafeEventQueue
+
+    MpscQueue<EventPtr> eventQueue;
+    /// Reused between calls of update to avoid allocations.
+    std::vector<EventPtr> eventBatch;
+
+    /// Ring buffer for typed events.
+    TypedEventQueue* typedEventQueue = nullptr;
 };
 
 }
@@ -35,44 +35,21 @@
 
 namespace sgl {
 
-BinaryWriteStream::BinaryWriteStream(size_t size /* = STD_BUFFER_SIZE */) {
-    bufferSize = 0;
-    capacity = 0;
-    buffer = nullptr;
-    reserve(size);
+BinaryWriteStream::BinaryWriteStream(size_t size /* = STD_BUFFER_SIZE */) : storage(size) {
 }
 
-BinaryWriteStream::~BinaryWriteStream() {
-    if (buffer) {
-        delete[] buffer;
-        buffer = nullptr;
-        capacity = 0;
-        bufferSize = 0;
-    }
-}
+BinaryWriteStream::~BinaryWriteStream() = default;
 
 void BinaryWriteStream::reserve(size_t size /* = STD_BUFFER_SIZE */) {
-    size = std::max((size_t)4, size); // Minimum buffer size: 32 bits
-    if (size > capacity) {
-        auto* _buffer = new uint8_t[size];
-        if (buffer) {
-            memcpy(_buffer, buffer, bufferSize);
-            delete[] buffer;
-        }
-        buffer = _buffer;
-        capacity = size;
-    }
+    storage.reserve(size);
 }
 
-void BinaryWriteStream::write(const void* data, size_t size) {
-    // Check if we need to increase the buffer size
-    if (bufferSize + size > capacity) {
-        reserve(std::max(bufferSize + size, bufferSize*2));
-    }
+void BinaryWriteStream::setSink(WriteStreamSink sink, size_t chunkSize /* = STD_STREAMING_CHUNK_SIZE */) {
+    storage.setSink(std::move(sink), chunkSize);
+}
 
-    assert(bufferSize + size <= capacity);
-    memcpy(buffer + bufferSize, data, size);
-    bufferSize += size;
+bool BinaryWriteStream::flush() {
+    return storage.flush();
 }
 
 void BinaryWriteStream::write(const char *str) {
@@ -90,33 +67,44 @@ void BinaryWriteStream::write(const std::string &str) {
 
 
 BinaryReadStream::BinaryReadStream(BinaryWriteStream &stream) {
-    // Copy the buffer address to this stream
-    buffer = stream.buffer;
-    bufferSize = stream.bufferSize;
+    // Move the buffer of the old stream to this stream
+    buffer = stream.storage.releaseContiguousData(bufferSize);
     bufferStart = 0;
+}
 
-    // Delete the buffer from the old stream
-    stream.buffer = nullptr;
-    stream.bufferSize = 0;
-    stream.capacity = 0;
+BinaryReadStream::BinaryReadStream(void* _buffer, size_t _bufferSize)
+        : BinaryReadStream(static_cast<const void*>(_buffer), _bufferSize, StreamBufferOwnership::TAKE) {
 }
 
-BinaryReadStream::BinaryReadStream(void* _buffer, size_t _bufferSize) {
-    buffer = (uint8_t*)_buffer;
+BinaryReadStream::BinaryReadStream(const void* _buffer, size_t _bufferSize)
+        : BinaryReadStream(_buffer, _bufferSize, StreamBufferOwnership::COPY) {
+}
+
+BinaryReadStream::BinaryReadStream(const void* _buffer, size_t _bufferSize, StreamBufferOwnership ownership) {
+    if (ownership == StreamBufferOwnership::COPY) {
+        buffer = new uint8_t[_bufferSize];
+        memcpy(buffer, _buffer, _bufferSize);
+    } else {
+        buffer = (uint8_t*)_buffer;
+    }
+    ownsBuffer = ownership != StreamBufferOwnership::VIEW;
     bufferSize = _bufferSize;
     bufferStart = 0;
 }
 
-BinaryReadStream::BinaryReadStream(const void* _buffer, size_t _bufferSize) {
-    buffer = new uint8_t[_bufferSize];
-    memcpy(buffer, _buffer, _bufferSize);
+BinaryReadStream::BinaryReadStream(const void* _buffer, size_t _bufferSize, std::shared_ptr<const void> owner)
+        : bufferOwner(std::move(owner)) {
+    buffer = (uint8_t*)_buffer;
+    ownsBuffer = false;
     bufferSize = _bufferSize;
     bufferStart = 0;
 }
 
 BinaryReadStream::~BinaryReadStream() {
     if (buffer) {
-        delete[] buffer;
+        if (ownsBuffer) {
+            delete[] buffer;
+        }
         buffer = nullptr;
         bufferStart = 0;
         bufferSize = 0;
@@ -139,11 +127,29 @@ void BinaryReadStream::read(std::string& str) {
         Logfile::get()->writeError("FATAL ERROR: BinaryReadStream::read(string&)");
         return;
     }
-    char *cstr = new char[strSize+1];
-    cstr[strSize] = '\0';
-    read((void*)cstr, strSize);
-    str = cstr;
-    delete[] cstr;
+    str.assign(reinterpret_cast<const char*>(buffer + bufferStart), strSize);
+    bufferStart += strSize;
+}
+
+void BinaryReadStream::read(std::string_view& str) {
+    uint32_t strSize;
+    read(strSize);
+    if (bufferStart + (size_t)strSize > bufferSize) {
+        Logfile::get()->writeError("FATAL ERROR: BinaryReadStream::read(string_view&)");
+        return;
+    }
+    str = std::string_view(reinterpret_cast<const char*>(buffer + bufferStart), strSize);
+    bufferStart += strSize;
+}
+
+const uint8_t* BinaryReadStream::readSpanBytes(size_t size) {
+    if (bufferStart + size > bufferSize) {
+        Logfile::get()->writeError("FATAL ERROR: BinaryReadStream::readSpan(size_t)");
+        return nullptr;
+    }
+    const uint8_t* data = buffer + bufferStart;
+    bufferStart += size;
+    return data;
 }
 
 void BinaryReadStream::skip(size_t size) {
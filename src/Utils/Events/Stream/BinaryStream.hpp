@@ -32,7 +32,11 @@
 #include <Defs.hpp>
 #include <cassert>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <memory>
+#include <iterator>
+#include "SegmentedWriteBuffer.hpp"
 
 namespace sgl {
 
@@ -45,13 +49,30 @@ public:
     explicit BinaryWriteStream(size_t size = STD_BUFFER_SIZE);
     ~BinaryWriteStream();
     /// @return Current size of the used buffer (not the capacity)
-    [[nodiscard]] inline size_t getSize() const { return bufferSize; }
-    [[nodiscard]] inline const uint8_t* getBuffer() const { return buffer; }
+    [[nodiscard]] inline size_t getSize() const { return storage.getSize(); }
+    /**
+     * Returns the written data as one contiguous buffer. The data may be stored in multiple segments internally, which
+     * are merged (i.e., copied) by the first call to this function after growing. If the data is only passed on
+     * (e.g., written to a file), @see forEachSegment avoids the copy. Must not be called in streaming mode.
+     */
+    [[nodiscard]] inline const uint8_t* getBuffer() { return storage.getContiguousData(); }
+    /// Calls 'callback(const uint8_t* data, size_t size)' for all internal segments in order without merging them.
+    template<class Func>
+    void forEachSegment(Func callback) const { storage.forEachSegment(callback); }
     /// Manually make sure buffer holds at least passed size bytes.
     void reserve(size_t size = STD_BUFFER_SIZE);
 
+    /**
+     * Switches to streaming mode: Instead of keeping all data in memory, data is passed to 'sink' (e.g., created with
+     * @see createFileDescriptorSink or @see ZlibCompressorSink) in chunks of 'chunkSize' bytes.
+     * IMPORTANT: @see flush needs to be called after the last write.
+     */
+    void setSink(WriteStreamSink sink, size_t chunkSize = STD_STREAMING_CHUNK_SIZE);
+    /// Passes all buffered data to the sink in streaming mode. Returns false if the sink reported an error.
+    bool flush();
+
     /// Write "size"-bytes of array "data"
-    void write(const void* data, size_t size);
+    inline void write(const void* data, size_t size) { storage.write(data, size); }
     /// Write a typed primitive value to the file (i.e. no pointers in type T).
     template<typename T>
     void write(const T &val) { write((const void*)&val, sizeof(T)); }
@@ -61,14 +82,20 @@ public:
 
     /// Write an array of primitive values to the file (i.e. no pointers in type T).
     template<typename T>
-    void writeArray(const std::vector<T> &v)
+    void writeArray(const T* data, size_t numEntries)
     {
-        uint32_t size = uint32_t(v.size());
+        uint32_t size = uint32_t(numEntries);
         write(size);
         if (size > 0) {
-            write((const void*)&v.front(), sizeof(T)*v.size());
+            write((const void*)data, sizeof(T)*numEntries);
         }
     }
+    /// Write a contiguous container of primitive values (e.g., std::vector or std::array) to the file.
+    template<typename Container>
+    void writeArray(const Container &v)
+    {
+        writeArray(std::data(v), std::size(v));
+    }
 
     /// Serialization with pipe operator
     template<typename T>
@@ -77,28 +104,51 @@ public:
     BinaryWriteStream& operator<<(const std::string &str) { write(str); return *this; }
 
 protected:
-    /// The current buffer size (only the used part of the buffer counts)
-    size_t bufferSize;
-    /// The maximum buffer size before it needs to be increased/reallocated
-    size_t capacity;
-    uint8_t* buffer;
+    SegmentedWriteBuffer storage;
+};
+
+/// Specifies how a @see BinaryReadStream treats the buffer passed to it.
+enum class StreamBufferOwnership {
+    /// The data is copied to a buffer owned by the stream.
+    COPY,
+    /// The stream takes ownership of the buffer, which must have been allocated with "new[]".
+    TAKE,
+    /// The stream reads directly from the buffer without copying it (e.g., memory-mapped files or archive entries).
+    /// The buffer must outlive the stream.
+    VIEW
 };
 
 class DLL_OBJECT BinaryReadStream {
 public:
-    /// Read from passed input stream.
+    /// Read from passed input stream. The data is moved out of 'stream', which must not be in streaming mode.
     explicit BinaryReadStream(BinaryWriteStream &stream);
-    /// Read from passed input buffer.
+    /**
+     * Read from passed input buffer. The stream takes ownership of the buffer (allocated with "new[]").
+     * Deprecated, as it is easy to pick by accident for buffers the caller does not own (e.g., a non-const pointer to
+     * a view). Use the constructor taking an explicit @see StreamBufferOwnership instead.
+     */
+    [[deprecated("Use BinaryReadStream(buffer, size, StreamBufferOwnership::TAKE) instead.")]]
     BinaryReadStream(void* _buffer, size_t _bufferSize);
+    /// Read from a copy of the passed input buffer.
     BinaryReadStream(const void* _buffer, size_t _bufferSize);
+    BinaryReadStream(const void* _buffer, size_t _bufferSize, StreamBufferOwnership ownership);
+    /// Read from the passed buffer without copying it. 'owner' is kept alive as long as the stream exists.
+    BinaryReadStream(const void* _buffer, size_t _bufferSize, std::shared_ptr<const void> owner);
     ~BinaryReadStream();
+    BinaryReadStream(const BinaryReadStream&) = delete;
+    BinaryReadStream& operator=(const BinaryReadStream&) = delete;
     [[nodiscard]] inline size_t getSize() const { return bufferSize; }
+    /// @return The current read position in bytes.
+    [[nodiscard]] inline size_t getPosition() const { return bufferStart; }
+    [[nodiscard]] inline const uint8_t* getBuffer() const { return buffer; }
 
     /// Deserialization (see BinaryWriteStream for details).
     void read(void* data, size_t size);
     template<typename T>
     void read(T& val) { read((void*)&val, sizeof(T)); }
     void read(std::string &str);
+    /// Zero-copy variant of @see read(std::string&). The view is only valid as long as the buffer of the stream.
+    void read(std::string_view &str);
 
     template<typename T>
     void readArray(std::vector<T>& v)
@@ -111,6 +161,24 @@ public:
         }
     }
 
+    /**
+     * Returns a pointer to the next 'n' values of type T in the buffer without copying them and advances the read
+     * position. The pointer is only valid as long as the buffer of the stream. It is only aligned to alignof(T) if the
+     * writer ensured this. Returns nullptr if the stream does not contain enough data.
+     */
+    template<typename T>
+    const T* readSpan(size_t n) {
+        return reinterpret_cast<const T*>(readSpanBytes(sizeof(T) * n));
+    }
+    /// Zero-copy variant of @see readArray. The number of values is stored in 'n'.
+    template<typename T>
+    const T* readArraySpan(size_t& n) {
+        uint32_t size = 0;
+        read(size);
+        n = size;
+        return readSpan<T>(n);
+    }
+
     /// Deserialization with pipe operator
     template<typename T>
     BinaryReadStream& operator>>(T& val) { read(val); return *this; }
@@ -120,11 +188,17 @@ public:
     void skip(size_t size);
 
 protected:
+    const uint8_t* readSpanBytes(size_t size);
+
     /// The total buffer size
     size_t bufferSize;
     /// The current point in the buffer where the code reads from
     size_t bufferStart;
     uint8_t* buffer;
+    /// Whether the buffer needs to be freed with "delete[]" by the stream.
+    bool ownsBuffer = true;
+    /// Optional owner of the buffer in view mode.
+    std::shared_ptr<const void> bufferOwner;
 };
 
 }
@@ -0,0 +1,247 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+#include <Utils/File/Logfile.hpp>
+#include "SegmentedWriteBuffer.hpp"
+
+namespace sgl {
+
+// Upper bound for the size of newly allocated segments, so that the last segment does not overallocate too much.
+static const size_t MAX_SEGMENT_GROWTH_SIZE = size_t(64) * 1024 * 1024;
+
+SegmentedWriteBuffer::SegmentedWriteBuffer(size_t initialCapacity) : initialCapacity(initialCapacity) {
+    reserve(initialCapacity);
+}
+
+SegmentedWriteBuffer::~SegmentedWriteBuffer() {
+    freeSegments();
+}
+
+void SegmentedWriteBuffer::freeSegments() {
+    for (Segment& fullSegment : fullSegments) {
+        delete[] fullSegment.data;
+    }
+    fullSegments.clear();
+    numBytesInFullSegments = 0;
+    if (segment) {
+        delete[] segment;
+        segment = nullptr;
+    }
+    segmentSize = 0;
+    segmentCapacity = 0;
+}
+
+void SegmentedWriteBuffer::reserve(size_t size) {
+    size = std::max((size_t)4, size); // Minimum buffer size: 32 bits
+    if (size <= numBytesInFullSegments + segmentCapacity) {
+        return;
+    }
+    if (segmentSize == 0) {
+        delete[] segment;
+        segmentCapacity = size - numBytesInFullSegments;
+        segment = new uint8_t[segmentCapacity];
+    } else {
+        finishSegment();
+        segmentCapacity = size - numBytesInFullSegments;
+        segment = new uint8_t[segmentCapacity];
+    }
+}
+
+void SegmentedWriteBuffer::finishSegment() {
+    if (segmentSize > 0) {
+        fullSegments.push_back(Segment{ segment, segmentSize });
+        numBytesInFullSegments += segmentSize;
+    } else {
+        delete[] segment;
+    }
+    segment = nullptr;
+    segmentSize = 0;
+    segmentCapacity = 0;
+}
+
+void SegmentedWriteBuffer::writeSlow(const uint8_t* data, size_t size) {
+    if (sink) {
+        while (size > 0) {
+            if (segmentSize == 0 && size >= segmentCapacity) {
+                // Large writes are passed to the sink directly.
+                passToSink(data, size);
+                totalSize += size;
+                return;
+            }
+            size_t numBytesToCopy = std::min(size, segmentCapacity - segmentSize);
+            memcpy(segment + segmentSize, data, numBytesToCopy);
+            segmentSize += numBytesToCopy;
+            totalSize += numBytesToCopy;
+            data += numBytesToCopy;
+            size -= numBytesToCopy;
+            if (segmentSize == segmentCapacity) {
+                passToSink(segment, segmentSize);
+                segmentSize = 0;
+            }
+        }
+        return;
+    }
+
+    // Fill the rest of the current segment first.
+    size_t numBytesToCopy = std::min(size, segmentCapacity - segmentSize);
+    if (numBytesToCopy > 0) {
+        memcpy(segment + segmentSize, data, numBytesToCopy);
+        segmentSize += numBytesToCopy;
+        totalSize += numBytesToCopy;
+        data += numBytesToCopy;
+        size -= numBytesToCopy;
+    }
+
+    // Grow geometrically without copying the data written so far.
+    finishSegment();
+    size_t growthSize = std::min(std::max(totalSize, initialCapacity), MAX_SEGMENT_GROWTH_SIZE);
+    segmentCapacity = std::max(std::max(size, growthSize), (size_t)4);
+    segment = new uint8_t[segmentCapacity];
+    memcpy(segment, data, size);
+    segmentSize = size;
+    totalSize += size;
+}
+
+void SegmentedWriteBuffer::checkIsNotStreaming(const char* functionName) const {
+    if (sink) {
+        Logfile::get()->throwError(
+                std::string() + "Error in SegmentedWriteBuffer::" + functionName
+                + ": The data of a stream in streaming mode was already passed to its sink.", false);
+    }
+}
+
+const uint8_t* SegmentedWriteBuffer::getContiguousData() {
+    checkIsNotStreaming("getContiguousData");
+    if (fullSegments.empty()) {
+        return segment;
+    }
+
+    size_t mergedSize = numBytesInFullSegments + segmentSize;
+    auto* mergedSegment = new uint8_t[mergedSize];
+    size_t offset = 0;
+    for (const Segment& fullSegment : fullSegments) {
+        memcpy(mergedSegment + offset, fullSegment.data, fullSegment.size);
+        offset += fullSegment.size;
+        delete[] fullSegment.data;
+    }
+    if (segmentSize > 0) {
+        memcpy(mergedSegment + offset, segment, segmentSize);
+    }
+    delete[] segment;
+    fullSegments.clear();
+    numBytesInFullSegments = 0;
+    segment = mergedSegment;
+    segmentSize = mergedSize;
+    segmentCapacity = mergedSize;
+    return segment;
+}
+
+uint8_t* SegmentedWriteBuffer::releaseContiguousData(size_t& size) {
+    checkIsNotStreaming("releaseContiguousData");
+    getContiguousData();
+    uint8_t* data = segment;
+    size = segmentSize;
+    segment = nullptr;
+    segmentSize = 0;
+    segmentCapacity = 0;
+    totalSize = 0;
+    return data;
+}
+
+void SegmentedWriteBuffer::setSink(WriteStreamSink _sink, size_t chunkSize) {
+    sink = std::move(_sink);
+    hasSinkError = false;
+    flush();
+    chunkSize = std::max((size_t)4, chunkSize);
+    if (segmentCapacity != chunkSize) {
+        delete[] segment;
+        segment = new uint8_t[chunkSize];
+        segmentCapacity = chunkSize;
+    }
+}
+
+bool SegmentedWriteBuffer::flush() {
+    if (!sink) {
+        return true;
+    }
+    for (Segment& fullSegment : fullSegments) {
+        passToSink(fullSegment.data, fullSegment.size);
+        delete[] fullSegment.data;
+    }
+    fullSegments.clear();
+    numBytesInFullSegments = 0;
+    if (segmentSize > 0) {
+        passToSink(segment, segmentSize);
+        segmentSize = 0;
+    }
+    return !hasSinkError;
+}
+
+void SegmentedWriteBuffer::passToSink(const uint8_t* data, size_t size) {
+    if (!hasSinkError && !sink(data, size)) {
+        hasSinkError = true;
+        Logfile::get()->writeError("Error in SegmentedWriteBuffer::passToSink: The sink reported an error.");
+    }
+}
+
+WriteStreamSink createFileDescriptorSink(int fileDescriptor) {
+    return [fileDescriptor](const uint8_t* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            int numBytesWritten = _write(
+                    fileDescriptor, data, unsigned(std::min(size, size_t(1) << 30)));
+            if (numBytesWritten <= 0) {
+                return false;
+            }
+#else
+            ssize_t numBytesWritten = ::write(fileDescriptor, data, size);
+            if (numBytesWritten < 0 && errno == EINTR) {
+                continue;
+            }
+            if (numBytesWritten <= 0) {
+                return false;
+            }
+#endif
+            data += numBytesWritten;
+            size -= size_t(numBytesWritten);
+        }
+        return true;
+    };
+}
+
+}
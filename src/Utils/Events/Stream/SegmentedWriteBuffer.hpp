@@ -0,0 +1,147 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_SEGMENTEDWRITEBUFFER_HPP
+#define SGL_SEGMENTEDWRITEBUFFER_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <functional>
+
+namespace sgl {
+
+/**
+ * Receives the data of a write stream in streaming mode (@see SegmentedWriteBuffer::setSink).
+ * @return false if an error occurred.
+ */
+typedef std::function<bool(const uint8_t* data, size_t size)> WriteStreamSink;
+
+/**
+ * Backing store of BinaryWriteStream and StringWriteStream. When the buffer runs full, a new segment is appended
+ * instead of reallocating and copying the data written so far. The segments can be consumed without copying via
+ * @see forEachSegment. A contiguous buffer is only created on explicit request (@see getContiguousData), which
+ * copies the data once.
+ * In streaming mode, full segments are passed to a sink (e.g., a file descriptor or a compressor) and reused, so the
+ * memory consumption stays bounded independent of the amount of data written.
+ */
+class DLL_OBJECT SegmentedWriteBuffer {
+public:
+    explicit SegmentedWriteBuffer(size_t initialCapacity);
+    ~SegmentedWriteBuffer();
+    SegmentedWriteBuffer(const SegmentedWriteBuffer&) = delete;
+    SegmentedWriteBuffer& operator=(const SegmentedWriteBuffer&) = delete;
+
+    /// @return The total number of bytes written (including data already passed to the sink in streaming mode).
+    [[nodiscard]] inline size_t getSize() const { return totalSize; }
+    /// Makes sure that at least 'size' bytes can be stored without allocating new memory.
+    void reserve(size_t size);
+
+    inline void write(const void* data, size_t size) {
+        if (segmentSize + size <= segmentCapacity) {
+            memcpy(segment + segmentSize, data, size);
+            segmentSize += size;
+            totalSize += size;
+        } else {
+            writeSlow(reinterpret_cast<const uint8_t*>(data), size);
+        }
+    }
+
+    /// Returns whether all data is stored in one segment, i.e., @see getContiguousData does not need to copy.
+    [[nodiscard]] inline bool getIsContiguous() const { return fullSegments.empty(); }
+    /**
+     * Merges all segments into one buffer if necessary and returns it. The merge copies all data written so far.
+     * The pointer is invalidated by the next call to @see write. Must not be called in streaming mode.
+     */
+    const uint8_t* getContiguousData();
+    /**
+     * Returns the contiguous buffer and removes it from the store, which is empty afterwards.
+     * Must not be called in streaming mode.
+     * IMPORTANT: The user must use "delete[]" to free the memory of the returned buffer.
+     */
+    uint8_t* releaseContiguousData(size_t& size);
+    /**
+     * Calls 'callback(data, size)' for all segments in order without merging them.
+     * Must not be called in streaming mode.
+     */
+    template<class Func>
+    void forEachSegment(Func callback) const {
+        checkIsNotStreaming("forEachSegment");
+        for (const Segment& fullSegment : fullSegments) {
+            callback(static_cast<const uint8_t*>(fullSegment.data), fullSegment.size);
+        }
+        if (segmentSize > 0) {
+            callback(static_cast<const uint8_t*>(segment), segmentSize);
+        }
+    }
+
+    /**
+     * Switches to streaming mode. Data that was already written is passed to the sink immediately. Afterwards, data is
+     * passed to the sink in chunks of 'chunkSize' bytes. @see flush needs to be called after the last write.
+     */
+    void setSink(WriteStreamSink _sink, size_t chunkSize);
+    /// Passes all buffered data to the sink. Does nothing if no sink is set.
+    bool flush();
+    /// Returns whether the sink reported an error.
+    [[nodiscard]] inline bool getHasSinkError() const { return hasSinkError; }
+
+private:
+    /// Throws an error if a sink is set, as the data was (partially) passed on to the sink already.
+    void checkIsNotStreaming(const char* functionName) const;
+    void writeSlow(const uint8_t* data, size_t size);
+    /// Moves the current segment to the list of full segments.
+    void finishSegment();
+    void passToSink(const uint8_t* data, size_t size);
+    void freeSegments();
+
+    struct Segment {
+        uint8_t* data;
+        size_t size;
+    };
+
+    size_t initialCapacity;
+    size_t totalSize = 0;
+    std::vector<Segment> fullSegments;
+    size_t numBytesInFullSegments = 0;
+    uint8_t* segment = nullptr;
+    size_t segmentSize = 0;
+    size_t segmentCapacity = 0;
+
+    // Streaming mode.
+    WriteStreamSink sink;
+    bool hasSinkError = false;
+};
+
+/**
+ * Returns a sink writing to an already opened file descriptor. The file descriptor is not closed by the sink.
+ */
+DLL_OBJECT WriteStreamSink createFileDescriptorSink(int fileDescriptor);
+
+}
+
+#endif //SGL_SEGMENTEDWRITEBUFFER_HPP
@@ -34,6 +34,8 @@
 
 /// Standard size: 256 bytes
 const size_t STD_BUFFER_SIZE = 256;
+/// Chunk size of write streams in streaming mode: 4MiB
+const size_t STD_STREAMING_CHUNK_SIZE = 4 * 1024 * 1024;
 
 #include "BinaryStream.hpp"
 
@@ -33,44 +33,21 @@
 
 namespace sgl {
 
-StringWriteStream::StringWriteStream(size_t size /* = STD_BUFFER_SIZE */) {
-    bufferSize = 0;
-    capacity = 0;
-    buffer = nullptr;
-    reserve(size);
+StringWriteStream::StringWriteStream(size_t size /* = STD_BUFFER_SIZE */) : storage(size) {
 }
 
-StringWriteStream::~StringWriteStream() {
-    if (buffer) {
-        delete[] buffer;
-        buffer = nullptr;
-        capacity = 0;
-        bufferSize = 0;
-    }
-}
+StringWriteStream::~StringWriteStream() = default;
 
 void StringWriteStream::reserve(size_t size /* = STD_BUFFER_SIZE */) {
-    size = std::max((size_t)4, size); // Minimum buffer size: 32 bits
-    if (size > capacity) {
-        char *_buffer = new char[size];
-        if (buffer) {
-            memcpy(_buffer, buffer, bufferSize);
-            delete[] buffer;
-        }
-        buffer = _buffer;
-        capacity = size;
-    }
+    storage.reserve(size);
 }
 
-void StringWriteStream::write(const void* data, size_t size) {
-    // Check if we need to increase the buffer size
-    if (bufferSize + size > capacity) {
-        reserve(bufferSize*2);
-    }
+void StringWriteStream::setSink(WriteStreamSink sink, size_t chunkSize /* = STD_STREAMING_CHUNK_SIZE */) {
+    storage.setSink(std::move(sink), chunkSize);
+}
 
-    assert(bufferSize + size <= capacity);
-    memcpy(buffer + bufferSize, data, size);
-    bufferSize += size;
+bool StringWriteStream::flush() {
+    return storage.flush();
 }
 
 void StringWriteStream::write(const char *str) {
@@ -86,15 +63,9 @@ void StringWriteStream::write(const std::string &str) {
 
 
 StringReadStream::StringReadStream(StringWriteStream& stream) {
-    // Copy the buffer address to this stream
-    buffer = stream.buffer;
-    bufferSize = stream.bufferSize;
+    // Move the buffer of the old stream to this stream
+    buffer = reinterpret_cast<char*>(stream.storage.releaseContiguousData(bufferSize));
     bufferStart = 0;
-
-    // Delete the buffer from the old stream
-    stream.buffer = nullptr;
-    stream.bufferSize = 0;
-    stream.capacity = 0;
 }
 
 StringReadStream::StringReadStream(void* _buffer, size_t _bufferSize) {
@@ -120,7 +91,7 @@ void StringReadStream::read(void* data, size_t size) {
 
 void StringReadStream::read(std::string& str) {
     str = buffer + bufferStart;
-    bufferStart += strlen(buffer) + 1;
+    bufferStart += str.size() + 1;
 }
 
 }
@@ -32,6 +32,7 @@
 #include <Utils/Convert.hpp>
 #include <cassert>
 #include <string>
+#include "SegmentedWriteBuffer.hpp"
 
 namespace sgl {
 
@@ -43,12 +44,19 @@ friend class StringReadStream;
 public:
     explicit StringWriteStream(size_t size = STD_BUFFER_SIZE);
     ~StringWriteStream();
-    [[nodiscard]] inline size_t getSize() const { return bufferSize; }
-    [[nodiscard]] inline const char* getBuffer() const { return buffer; }
+    [[nodiscard]] inline size_t getSize() const { return storage.getSize(); }
+    /// Returns the written data as one contiguous buffer (see @see BinaryWriteStream::getBuffer).
+    [[nodiscard]] inline const char* getBuffer() {
+        return reinterpret_cast<const char*>(storage.getContiguousData());
+    }
     void reserve(size_t size = STD_BUFFER_SIZE);
 
+    /// Streaming mode (see @see BinaryWriteStream::setSink).
+    void setSink(WriteStreamSink sink, size_t chunkSize = STD_STREAMING_CHUNK_SIZE);
+    bool flush();
+
     /// Serialization
-    void write(const void* data, size_t size);
+    inline void write(const void* data, size_t size) { storage.write(data, size); }
     template<typename T>
     void write(const T& val) { write(toString(val)); }
     void write(const char* str);
@@ -61,11 +69,7 @@ public:
     StringWriteStream& operator<<(const std::string &str) { write(str); return *this; }
 
 protected:
-    /// The current buffer size (only the used part of the buffer counts)
-    size_t bufferSize;
-    /// The maximum buffer size before it needs to be increased/reallocated
-    size_t capacity;
-    char* buffer;
+    SegmentedWriteBuffer storage;
 };
 
 class DLL_OBJECT StringReadStream {
@@ -0,0 +1,446 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <fstream>
+
+#include <zlib.h>
+#ifdef SUPPORT_ZSTD
+#include <zstd.h>
+#endif
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include "Logfile.hpp"
+#include "FileLoader.hpp"
+#include "BlockCompression.hpp"
+
+namespace sgl {
+
+static const uint32_t BLOCK_CONTAINER_MAGIC = 0x424C4753u; // "SGLB" in little endian.
+static const uint32_t BLOCK_CONTAINER_VERSION = 1u;
+
+struct BlockContainerHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t codec;
+    uint32_t reserved;
+    uint64_t uncompressedSize;
+    uint64_t blockSize;
+    uint64_t numBlocks;
+};
+
+bool getIsBlockCompressionCodecSupported(BlockCompressionCodec codec) {
+    if (codec == BlockCompressionCodec::NONE || codec == BlockCompressionCodec::ZLIB) {
+        return true;
+    }
+#ifdef SUPPORT_ZSTD
+    if (codec == BlockCompressionCodec::ZSTD) {
+        return true;
+    }
+#endif
+    return false;
+}
+
+/*
+ * zlib passes sizes as uLong, which only has 32 bits on Windows. Larger blocks are split by @see compressBlocks;
+ * half of the range is used so that the compression bound of a block also fits.
+ */
+static const uint64_t ZLIB_MAX_BLOCK_SIZE = uint64_t(std::numeric_limits<uLong>::max() / 2);
+
+static size_t getMaxBlockSize(BlockCompressionCodec codec) {
+    if (codec == BlockCompressionCodec::ZLIB) {
+        return size_t(std::min(ZLIB_MAX_BLOCK_SIZE, uint64_t(std::numeric_limits<size_t>::max())));
+    }
+    return std::numeric_limits<size_t>::max();
+}
+
+static size_t getCompressBound(BlockCompressionCodec codec, size_t size) {
+    if (codec == BlockCompressionCodec::ZLIB) {
+        return size_t(compressBound(uLong(size)));
+    }
+#ifdef SUPPORT_ZSTD
+    if (codec == BlockCompressionCodec::ZSTD) {
+        return ZSTD_compressBound(size);
+    }
+#endif
+    return size;
+}
+
+static bool compressBlock(
+        BlockCompressionCodec codec, int compressionLevel,
+        const uint8_t* src, size_t srcSize, uint8_t* dst, size_t& dstSize) {
+    if (codec == BlockCompressionCodec::NONE) {
+        memcpy(dst, src, srcSize);
+        dstSize = srcSize;
+        return true;
+    }
+    if (codec == BlockCompressionCodec::ZLIB) {
+        if (uint64_t(srcSize) > ZLIB_MAX_BLOCK_SIZE) {
+            return false;
+        }
+        auto destLen = uLongf(std::min(uint64_t(dstSize), uint64_t(std::numeric_limits<uLong>::max())));
+        if (compress2(dst, &destLen, src, uLong(srcSize), compressionLevel) != Z_OK) {
+            return false;
+        }
+        dstSize = size_t(destLen);
+        return true;
+    }
+#ifdef SUPPORT_ZSTD
+    if (codec == BlockCompressionCodec::ZSTD) {
+        size_t returnValue = ZSTD_compress(
+                dst, dstSize, src, srcSize, compressionLevel < 0 ? ZSTD_CLEVEL_DEFAULT : compressionLevel);
+        if (ZSTD_isError(returnValue)) {
+            return false;
+        }
+        dstSize = returnValue;
+        return true;
+    }
+#endif
+    return false;
+}
+
+static bool decompressBlock(
+        BlockCompressionCodec codec, const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+    if (codec == BlockCompressionCodec::NONE) {
+        if (srcSize != dstSize) {
+            return false;
+        }
+        memcpy(dst, src, srcSize);
+        return true;
+    }
+    if (codec == BlockCompressionCodec::ZLIB) {
+        if (uint64_t(srcSize) > uint64_t(std::numeric_limits<uLong>::max())
+                || uint64_t(dstSize) > ZLIB_MAX_BLOCK_SIZE) {
+            return false;
+        }
+        auto destLen = uLongf(dstSize);
+        if (uncompress(dst, &destLen, src, uLong(srcSize)) != Z_OK) {
+            return false;
+        }
+        return size_t(destLen) == dstSize;
+    }
+#ifdef SUPPORT_ZSTD
+    if (codec == BlockCompressionCodec::ZSTD) {
+        size_t returnValue = ZSTD_decompress(dst, dstSize, src, srcSize);
+        return !ZSTD_isError(returnValue) && returnValue == dstSize;
+    }
+#endif
+    return false;
+}
+
+bool compressBlocks(
+        const uint8_t* uncompressedBuffer, size_t uncompressedBufferSize,
+        uint8_t*& compressedBuffer, size_t& compressedBufferSize,
+        const BlockCompressionSettings& settings) {
+    compressedBuffer = nullptr;
+    compressedBufferSize = 0;
+    if (!getIsBlockCompressionCodecSupported(settings.codec)) {
+        sgl::Logfile::get()->writeError("Error in compressBlocks: Unsupported codec.");
+        return false;
+    }
+    if (settings.blockSize == 0) {
+        sgl::Logfile::get()->writeError("Error in compressBlocks: The block size must be larger than zero.");
+        return false;
+    }
+
+    const BlockCompressionCodec codec = settings.codec;
+    const int compressionLevel = settings.compressionLevel;
+    const size_t blockSize = std::min(settings.blockSize, getMaxBlockSize(codec));
+    const size_t numBlocks = (uncompressedBufferSize + blockSize - 1) / blockSize;
+    const size_t blockBound = getCompressBound(codec, blockSize);
+
+    /*
+     * Each block is compressed into its own slot of the staging buffer. Afterwards, the compressed blocks are packed
+     * consecutively behind the header and the block table.
+     */
+    std::vector<uint64_t> compressedBlockSizes(numBlocks);
+    auto* stagingBuffer = new uint8_t[std::max(numBlocks * blockBound, size_t(1))];
+    std::atomic<bool> hasError = false;
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(uncompressedBuffer, uncompressedBufferSize, codec, compressionLevel, blockSize) \
+    shared(numBlocks, blockBound, compressedBlockSizes, stagingBuffer, hasError) schedule(dynamic) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t srcOffset = blockIdx * blockSize;
+        size_t srcSize = std::min(blockSize, uncompressedBufferSize - srcOffset);
+        size_t dstSize = blockBound;
+        if (!compressBlock(
+                codec, compressionLevel, uncompressedBuffer + srcOffset, srcSize,
+                stagingBuffer + blockIdx * blockBound, dstSize)) {
+            hasError = true;
+            dstSize = 0;
+        }
+        compressedBlockSizes[blockIdx] = uint64_t(dstSize);
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    if (hasError) {
+        delete[] stagingBuffer;
+        sgl::Logfile::get()->writeError("Error in compressBlocks: Compressing a block failed.");
+        return false;
+    }
+
+    // Compute the offsets of the blocks in the container (exclusive prefix sum).
+    const size_t headerSize = sizeof(BlockContainerHeader) + numBlocks * sizeof(uint64_t);
+    std::vector<size_t> blockOffsets(numBlocks);
+    size_t currentOffset = headerSize;
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        blockOffsets[blockIdx] = currentOffset;
+        currentOffset += size_t(compressedBlockSizes[blockIdx]);
+    }
+
+    compressedBufferSize = currentOffset;
+    compressedBuffer = new uint8_t[compressedBufferSize];
+    BlockContainerHeader header{};
+    header.magic = BLOCK_CONTAINER_MAGIC;
+    header.version = BLOCK_CONTAINER_VERSION;
+    header.codec = uint32_t(codec);
+    header.reserved = 0;
+    header.uncompressedSize = uint64_t(uncompressedBufferSize);
+    header.blockSize = uint64_t(blockSize);
+    header.numBlocks = uint64_t(numBlocks);
+    memcpy(compressedBuffer, &header, sizeof(BlockContainerHeader));
+    if (numBlocks > 0) {
+        memcpy(
+                compressedBuffer + sizeof(BlockContainerHeader), compressedBlockSizes.data(),
+                numBlocks * sizeof(uint64_t));
+    }
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numBlocks, blockBound, compressedBlockSizes, blockOffsets) \
+    shared(stagingBuffer, compressedBuffer) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        memcpy(
+                compressedBuffer + blockOffsets[blockIdx], stagingBuffer + blockIdx * blockBound,
+                size_t(compressedBlockSizes[blockIdx]));
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    delete[] stagingBuffer;
+    return true;
+}
+
+static bool readBlockContainerHeader(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize, BlockContainerHeader& header) {
+    if (compressedBufferSize < sizeof(BlockContainerHeader)) {
+        sgl::Logfile::get()->writeError("Error in readBlockContainerHeader: The buffer is too small.");
+        return false;
+    }
+    memcpy(&header, compressedBuffer, sizeof(BlockContainerHeader));
+    if (header.magic != BLOCK_CONTAINER_MAGIC) {
+        sgl::Logfile::get()->writeError("Error in readBlockContainerHeader: Invalid magic number.");
+        return false;
+    }
+    if (header.version != BLOCK_CONTAINER_VERSION) {
+        sgl::Logfile::get()->writeError("Error in readBlockContainerHeader: Unsupported format version.");
+        return false;
+    }
+    if (!getIsBlockCompressionCodecSupported(BlockCompressionCodec(header.codec))) {
+        sgl::Logfile::get()->writeError(
+                "Error in readBlockContainerHeader: The codec used by the container is not supported by this build.");
+        return false;
+    }
+    // The header is untrusted, so the checks are formulated such that they cannot overflow.
+    if (header.blockSize == 0
+            || header.numBlocks != header.uncompressedSize / header.blockSize
+                    + (header.uncompressedSize % header.blockSize != 0 ? 1 : 0)
+            || header.numBlocks > (compressedBufferSize - sizeof(BlockContainerHeader)) / sizeof(uint64_t)) {
+        sgl::Logfile::get()->writeError("Error in readBlockContainerHeader: Invalid block table.");
+        return false;
+    }
+    return true;
+}
+
+bool getBlockCompressedUncompressedSize(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize, size_t& uncompressedBufferSize) {
+    BlockContainerHeader header{};
+    if (!readBlockContainerHeader(compressedBuffer, compressedBufferSize, header)) {
+        return false;
+    }
+    uncompressedBufferSize = size_t(header.uncompressedSize);
+    return true;
+}
+
+bool decompressBlocksInto(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize,
+        uint8_t* decompressedBuffer, size_t decompressedBufferSize) {
+    BlockContainerHeader header{};
+    if (!readBlockContainerHeader(compressedBuffer, compressedBufferSize, header)) {
+        return false;
+    }
+    if (decompressedBufferSize < size_t(header.uncompressedSize)) {
+        sgl::Logfile::get()->writeError("Error in decompressBlocksInto: The output buffer is too small.");
+        return false;
+    }
+
+    const auto codec = BlockCompressionCodec(header.codec);
+    const auto uncompressedSize = size_t(header.uncompressedSize);
+    const auto blockSize = size_t(header.blockSize);
+    const auto numBlocks = size_t(header.numBlocks);
+    std::vector<uint64_t> compressedBlockSizes(numBlocks);
+    if (numBlocks > 0) {
+        memcpy(
+                compressedBlockSizes.data(), compressedBuffer + sizeof(BlockContainerHeader),
+                numBlocks * sizeof(uint64_t));
+    }
+    std::vector<size_t> blockOffsets(numBlocks);
+    size_t currentOffset = sizeof(BlockContainerHeader) + numBlocks * sizeof(uint64_t);
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        // Compare against the remaining bytes, as the sum of crafted block sizes could wrap around.
+        if (compressedBlockSizes[blockIdx] > uint64_t(compressedBufferSize - currentOffset)) {
+            sgl::Logfile::get()->writeError("Error in decompressBlocksInto: The container is truncated.");
+            return false;
+        }
+        blockOffsets[blockIdx] = currentOffset;
+        currentOffset += size_t(compressedBlockSizes[blockIdx]);
+    }
+
+    std::atomic<bool> hasError = false;
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(compressedBuffer, decompressedBuffer, codec, uncompressedSize, blockSize) \
+    shared(numBlocks, compressedBlockSizes, blockOffsets, hasError) schedule(dynamic) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t dstOffset = blockIdx * blockSize;
+        size_t dstSize = std::min(blockSize, uncompressedSize - dstOffset);
+        if (!decompressBlock(
+                codec, compressedBuffer + blockOffsets[blockIdx], size_t(compressedBlockSizes[blockIdx]),
+                decompressedBuffer + dstOffset, dstSize)) {
+            hasError = true;
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    if (hasError) {
+        sgl::Logfile::get()->writeError("Error in decompressBlocksInto: Decompressing a block failed.");
+        return false;
+    }
+    return true;
+}
+
+bool decompressBlocks(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize,
+        uint8_t*& decompressedBuffer, size_t& decompressedBufferSize) {
+    decompressedBuffer = nullptr;
+    decompressedBufferSize = 0;
+    size_t uncompressedSize = 0;
+    if (!getBlockCompressedUncompressedSize(compressedBuffer, compressedBufferSize, uncompressedSize)) {
+        return false;
+    }
+    decompressedBuffer = new uint8_t[std::max(uncompressedSize, size_t(1))];
+    if (!decompressBlocksInto(compressedBuffer, compressedBufferSize, decompressedBuffer, uncompressedSize)) {
+        delete[] decompressedBuffer;
+        decompressedBuffer = nullptr;
+        return false;
+    }
+    decompressedBufferSize = uncompressedSize;
+    return true;
+}
+
+bool writeBlockCompressedFile(
+        const std::string& filename, const uint8_t* data, size_t dataSize,
+        const BlockCompressionSettings& settings) {
+    uint8_t* compressedBuffer = nullptr;
+    size_t compressedBufferSize = 0;
+    if (!compressBlocks(data, dataSize, compressedBuffer, compressedBufferSize, settings)) {
+        return false;
+    }
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        sgl::Logfile::get()->writeError(
+                "Error in writeBlockCompressedFile: File \"" + filename + "\" could not be opened for writing.");
+        delete[] compressedBuffer;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(compressedBuffer), std::streamsize(compressedBufferSize));
+    file.close();
+    delete[] compressedBuffer;
+    return true;
+}
+
+bool readBlockCompressedFile(const std::string& filename, uint8_t*& buffer, size_t& bufferSize) {
+    uint8_t* compressedBuffer = nullptr;
+    size_t compressedBufferSize = 0;
+    if (!loadFileFromSource(filename, compressedBuffer, compressedBufferSize, true)) {
+        return false;
+    }
+    bool retVal = decompressBlocks(compressedBuffer, compressedBufferSize, buffer, bufferSize);
+    delete[] compressedBuffer;
+    return retVal;
+}
+
+bool writeBinaryStreamBlockCompressed(
+        const std::string& filename, BinaryWriteStream& stream,
+        const BlockCompressionSettings& settings) {
+    return writeBlockCompressedFile(filename, stream.getBuffer(), stream.getSize(), settings);
+}
+
+ReadStreamPtr readBinaryStreamBlockCompressed(const std::string& filename) {
+    uint8_t* buffer = nullptr;
+    size_t bufferSize = 0;
+    if (!readBlockCompressedFile(filename, buffer, bufferSize)) {
+        return {};
+    }
+    // The stream takes ownership of the buffer.
+    return std::make_shared<BinaryReadStream>(
+            static_cast<const void*>(buffer), bufferSize, StreamBufferOwnership::TAKE);
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_BLOCKCOMPRESSION_HPP
+#define SGL_BLOCKCOMPRESSION_HPP
+
+#include <string>
+#include <cstdint>
+
+#include <Utils/Events/Stream/Stream.hpp>
+
+namespace sgl {
+
+enum class BlockCompressionCodec : uint32_t {
+    NONE = 0, ZLIB = 1, ZSTD = 2
+};
+
+struct DLL_OBJECT BlockCompressionSettings {
+    BlockCompressionCodec codec = BlockCompressionCodec::ZLIB;
+    /// Codec-specific compression level. -1 selects the default level of the codec.
+    int compressionLevel = -1;
+    /**
+     * Size of the independently compressed blocks in bytes. Smaller blocks increase the available parallelism.
+     * The size is clamped to the maximum block size supported by the codec (zlib: 2 GiB on Windows).
+     */
+    size_t blockSize = 4 * 1024 * 1024;
+};
+
+/// Returns whether the passed codec is available in this build (e.g., ZSTD depends on the build configuration).
+DLL_OBJECT bool getIsBlockCompressionCodecSupported(BlockCompressionCodec codec);
+
+/**
+ * Block-parallel compressed container format for large binary arrays (e.g., serialized BinaryWriteStream payloads
+ * or volume data). The data is split into blocks of equal size, which are compressed and decompressed independently
+ * in parallel. Layout (all values little endian):
+ * - Header: magic "SGLB" (uint32_t), format version (uint32_t), codec (uint32_t), reserved (uint32_t),
+ *   uncompressed size (uint64_t), block size (uint64_t), number of blocks (uint64_t).
+ * - Block table: The compressed size of each block (uint64_t).
+ * - Block data: The compressed blocks, stored consecutively.
+ *
+ * IMPORTANT: The user must use "delete[]" to free the memory of "compressedBuffer" if true is returned.
+ * @param uncompressedBuffer The buffer storing the uncompressed data.
+ * @param uncompressedBufferSize The size of the uncompressed data in bytes.
+ * @param compressedBuffer A reference to where the newly allocated container buffer should be stored.
+ * @param compressedBufferSize The size of the container in bytes.
+ * @param settings The codec, compression level and block size to use.
+ * @return Whether compression finished successfully.
+ */
+DLL_OBJECT bool compressBlocks(
+        const uint8_t* uncompressedBuffer, size_t uncompressedBufferSize,
+        uint8_t*& compressedBuffer, size_t& compressedBufferSize,
+        const BlockCompressionSettings& settings = {});
+
+/**
+ * Decompresses a container created with @see compressBlocks. The blocks are decompressed in parallel.
+ * IMPORTANT: The user must use "delete[]" to free the memory of "decompressedBuffer" if true is returned.
+ */
+DLL_OBJECT bool decompressBlocks(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize,
+        uint8_t*& decompressedBuffer, size_t& decompressedBufferSize);
+
+/**
+ * Returns the uncompressed size stored in the header of a block-compressed container.
+ * This can be used to decompress into a buffer allocated by the caller.
+ */
+DLL_OBJECT bool getBlockCompressedUncompressedSize(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize, size_t& uncompressedBufferSize);
+
+/**
+ * Like @see decompressBlocks, but decompresses into a buffer provided by the caller, which must be at least as large
+ * as the size returned by @see getBlockCompressedUncompressedSize.
+ */
+DLL_OBJECT bool decompressBlocksInto(
+        const uint8_t* compressedBuffer, size_t compressedBufferSize,
+        uint8_t* decompressedBuffer, size_t decompressedBufferSize);
+
+/// Writes the passed data to a block-compressed file.
+DLL_OBJECT bool writeBlockCompressedFile(
+        const std::string& filename, const uint8_t* data, size_t dataSize,
+        const BlockCompressionSettings& settings = {});
+/**
+ * Reads a block-compressed file (also from archives if built with libarchive support).
+ * IMPORTANT: The user must use "delete[]" to free the memory of "buffer" if true is returned.
+ */
+DLL_OBJECT bool readBlockCompressedFile(const std::string& filename, uint8_t*& buffer, size_t& bufferSize);
+
+/// Writes the content of a binary write stream to a block-compressed file. The segments of the stream are merged.
+DLL_OBJECT bool writeBinaryStreamBlockCompressed(
+        const std::string& filename, BinaryWriteStream& stream,
+        const BlockCompressionSettings& settings = {});
+/// Reads a binary stream from a block-compressed file. Returns an empty pointer if loading failed.
+DLL_OBJECT ReadStreamPtr readBinaryStreamBlockCompressed(const std::string& filename);
+
+}
+
+#endif //SGL_BLOCKCOMPRESSION_HPP
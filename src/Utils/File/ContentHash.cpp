@@ -0,0 +1,207 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "Logfile.hpp"
+#include "ContentHash.hpp"
+
+namespace sgl {
+
+static const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ull;
+static const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ull;
+static const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotateLeft64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+// The format is defined in little endian byte order; memcpy avoids unaligned accesses.
+static inline uint64_t readUint64(const uint8_t* ptr) {
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(uint64_t));
+    return value;
+}
+
+static inline uint32_t readUint32(const uint8_t* ptr) {
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(uint32_t));
+    return value;
+}
+
+static inline uint64_t xxhRound(uint64_t accumulator, uint64_t input) {
+    accumulator += input * XXH_PRIME64_2;
+    accumulator = rotateLeft64(accumulator, 31);
+    accumulator *= XXH_PRIME64_1;
+    return accumulator;
+}
+
+static inline uint64_t xxhMergeRound(uint64_t accumulator, uint64_t value) {
+    value = xxhRound(0, value);
+    accumulator ^= value;
+    accumulator = accumulator * XXH_PRIME64_1 + XXH_PRIME64_4;
+    return accumulator;
+}
+
+XXHash64::XXHash64(uint64_t seed) {
+    reset(seed);
+}
+
+void XXHash64::reset(uint64_t _seed) {
+    seed = _seed;
+    accumulators[0] = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    accumulators[1] = seed + XXH_PRIME64_2;
+    accumulators[2] = seed;
+    accumulators[3] = seed - XXH_PRIME64_1;
+    numPendingBytes = 0;
+    totalSize = 0;
+}
+
+void XXHash64::update(const void* data, size_t size) {
+    const auto* ptr = reinterpret_cast<const uint8_t*>(data);
+    const uint8_t* end = ptr + size;
+    totalSize += size;
+
+    // Complete a partially filled stripe first.
+    if (numPendingBytes > 0) {
+        size_t numBytesToCopy = std::min(size, size_t(32) - numPendingBytes);
+        memcpy(pendingData + numPendingBytes, ptr, numBytesToCopy);
+        numPendingBytes += numBytesToCopy;
+        ptr += numBytesToCopy;
+        if (numPendingBytes < 32) {
+            return;
+        }
+        for (int i = 0; i < 4; i++) {
+            accumulators[i] = xxhRound(accumulators[i], readUint64(pendingData + i * 8));
+        }
+        numPendingBytes = 0;
+    }
+
+    uint64_t v0 = accumulators[0], v1 = accumulators[1], v2 = accumulators[2], v3 = accumulators[3];
+    while (end - ptr >= 32) {
+        v0 = xxhRound(v0, readUint64(ptr));
+        v1 = xxhRound(v1, readUint64(ptr + 8));
+        v2 = xxhRound(v2, readUint64(ptr + 16));
+        v3 = xxhRound(v3, readUint64(ptr + 24));
+        ptr += 32;
+    }
+    accumulators[0] = v0;
+    accumulators[1] = v1;
+    accumulators[2] = v2;
+    accumulators[3] = v3;
+
+    if (ptr < end) {
+        numPendingBytes = size_t(end - ptr);
+        memcpy(pendingData, ptr, numPendingBytes);
+    }
+}
+
+uint64_t XXHash64::digest() const {
+    uint64_t hash;
+    if (totalSize >= 32) {
+        hash = rotateLeft64(accumulators[0], 1) + rotateLeft64(accumulators[1], 7)
+                + rotateLeft64(accumulators[2], 12) + rotateLeft64(accumulators[3], 18);
+        for (int i = 0; i < 4; i++) {
+            hash = xxhMergeRound(hash, accumulators[i]);
+        }
+    } else {
+        hash = seed + XXH_PRIME64_5;
+    }
+    hash += totalSize;
+
+    const uint8_t* ptr = pendingData;
+    const uint8_t* end = pendingData + numPendingBytes;
+    while (end - ptr >= 8) {
+        hash ^= xxhRound(0, readUint64(ptr));
+        hash = rotateLeft64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        ptr += 8;
+    }
+    if (end - ptr >= 4) {
+        hash ^= uint64_t(readUint32(ptr)) * XXH_PRIME64_1;
+        hash = rotateLeft64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        ptr += 4;
+    }
+    while (ptr < end) {
+        hash ^= uint64_t(*ptr) * XXH_PRIME64_5;
+        hash = rotateLeft64(hash, 11) * XXH_PRIME64_1;
+        ptr++;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= XXH_PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= XXH_PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint64_t computeXXHash64(const void* data, size_t size, uint64_t seed) {
+    XXHash64 hasher(seed);
+    hasher.update(data, size);
+    return hasher.digest();
+}
+
+bool computeFileXXHash64(const std::string& filename, uint64_t& hash) {
+#if defined(__linux__) || defined(__MINGW32__)
+    FILE* file = fopen64(filename.c_str(), "rb");
+#else
+    FILE* file = fopen(filename.c_str(), "rb");
+#endif
+    if (!file) {
+        sgl::Logfile::get()->writeError(
+                std::string() + "Error in computeFileXXHash64: File \"" + filename + "\" could not be opened.");
+        return false;
+    }
+
+    XXHash64 hasher;
+    std::vector<uint8_t> buffer(size_t(1) << 20);
+    size_t numBytesRead;
+    while ((numBytesRead = fread(buffer.data(), 1, buffer.size(), file)) > 0) {
+        hasher.update(buffer.data(), numBytesRead);
+    }
+    bool hasError = ferror(file) != 0;
+    fclose(file);
+    if (hasError) {
+        sgl::Logfile::get()->writeError(
+                std::string() + "Error in computeFileXXHash64: File \"" + filename + "\" could not be read.");
+        return false;
+    }
+
+    hash = hasher.digest();
+    return true;
+}
+
+}
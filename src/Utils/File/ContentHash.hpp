@@ -0,0 +1,76 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_CONTENTHASH_HPP
+#define SGL_CONTENTHASH_HPP
+
+#include <string>
+#include <cstdint>
+
+namespace sgl {
+
+/**
+ * Streaming implementation of the 64-bit xxHash (XXH64) algorithm. It is a fast non-cryptographic hash function
+ * meant for detecting changes of file contents, e.g., for keys of cached derived data (@see DiskCache).
+ *
+ * Example usage:
+ * XXHash64 hasher;
+ * hasher.update(data0, size0);
+ * hasher.update(data1, size1);
+ * uint64_t hash = hasher.digest();
+ */
+class DLL_OBJECT XXHash64 {
+public:
+    explicit XXHash64(uint64_t seed = 0);
+    void reset(uint64_t seed = 0);
+    void update(const void* data, size_t size);
+    /// Returns the hash of all data passed so far. More data can be added afterwards.
+    [[nodiscard]] uint64_t digest() const;
+
+private:
+    uint64_t seed = 0;
+    uint64_t accumulators[4]{};
+    uint8_t pendingData[32]{};
+    size_t numPendingBytes = 0;
+    uint64_t totalSize = 0;
+};
+
+/// Computes the XXH64 hash of the passed data.
+DLL_OBJECT uint64_t computeXXHash64(const void* data, size_t size, uint64_t seed = 0);
+
+/**
+ * Computes the XXH64 hash of the content of a file.
+ * @param filename The file to hash.
+ * @param hash The computed hash.
+ * @return Whether the file could be read.
+ */
+DLL_OBJECT bool computeFileXXHash64(const std::string& filename, uint64_t& hash);
+
+}
+
+#endif //SGL_CONTENTHASH_HPP
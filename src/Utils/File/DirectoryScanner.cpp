@@ -0,0 +1,422 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <Utils/Parallel/ThreadPool.hpp>
+#include "Logfile.hpp"
+#include "PathWatchManager.hpp"
+#include "DirectoryScanner.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#endif
+
+namespace sgl {
+
+/// Number of entries per published batch and per metadata query task.
+static const size_t DIRECTORY_SCAN_CHUNK_SIZE = 256;
+
+struct DirectoryCacheEntry {
+    std::string path;
+    uint32_t watchId = 0;
+    /// Incremented whenever the directory changes.
+    std::atomic<uint64_t> generation{0};
+    /// The cached listing (or nullptr if no valid listing is cached). Protected by DirectoryScanner::cacheMutex.
+    std::shared_ptr<std::vector<DirectoryEntry>> entries;
+    bool hasMetadata = false;
+    uint64_t lastAccess = 0;
+};
+
+static std::string normalizeDirectoryPath(const std::string& path) {
+    std::string normalizedPath = boost::filesystem::absolute(path).lexically_normal().generic_string();
+    // E.g., "/home/user/data/." -> "/home/user/data".
+    if (boost::ends_with(normalizedPath, "/.")) {
+        normalizedPath.resize(normalizedPath.size() - 2);
+    }
+    while (normalizedPath.size() > 1 && normalizedPath.back() == '/') {
+        normalizedPath.pop_back();
+    }
+    return normalizedPath;
+}
+
+
+DirectoryScan::DirectoryScan(
+        std::string path, bool queryMetadata, std::shared_ptr<DirectoryCacheEntry> cacheEntry)
+        : path(std::move(path)), queryMetadata(queryMetadata), cacheEntry(std::move(cacheEntry)),
+          entries(std::make_shared<std::vector<DirectoryEntry>>()) {
+    cacheGeneration = this->cacheEntry->generation.load();
+}
+
+size_t DirectoryScan::fetchNewEntries(std::vector<DirectoryEntry>& newEntries) {
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    size_t numNewEntries = entries->size() - numFetchedEntries;
+    newEntries.insert(newEntries.end(), entries->begin() + ptrdiff_t(numFetchedEntries), entries->end());
+    numFetchedEntries = entries->size();
+    return numNewEntries;
+}
+
+bool DirectoryScan::getIsOutdated() const {
+    return cacheEntry->generation.load() != cacheGeneration;
+}
+
+void DirectoryScan::cancel() {
+    isCancelled = true;
+}
+
+void DirectoryScan::wait() {
+    std::unique_lock<std::mutex> lock(entriesMutex);
+    finishedCondition.wait(lock, [this]() { return isFinished.load(); });
+}
+
+void DirectoryScan::publishEntries(std::vector<DirectoryEntry>& newEntries) {
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    entries->insert(
+            entries->end(), std::make_move_iterator(newEntries.begin()), std::make_move_iterator(newEntries.end()));
+    newEntries.clear();
+}
+
+void DirectoryScan::finish() {
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        isFinished = true;
+    }
+    finishedCondition.notify_all();
+}
+
+
+DirectoryScanner::DirectoryScanner() {
+    size_t numThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    scanThreadPool = new ThreadPool(2);
+    // Metadata queries mostly wait for the file system (e.g., network round trips), so more threads than cores help.
+    metadataThreadPool = new ThreadPool(std::min(numThreads, size_t(16)));
+}
+
+DirectoryScanner::~DirectoryScanner() {
+    // Waits for the running tasks, which may still access the cache. Queued scans are discarded.
+    delete scanThreadPool;
+    scanThreadPool = nullptr;
+    delete metadataThreadPool;
+    metadataThreadPool = nullptr;
+    // The watches are not removed, as the path watch manager may have already been destroyed at program exit.
+    // Their callbacks only hold weak references to the cache entries and share the ownership of the mutex.
+    cacheEntries.clear();
+}
+
+DirectoryScanPtr DirectoryScanner::scanDirectoryAsync(const std::string& dirPath, bool queryMetadata) {
+    std::string normalizedPath = normalizeDirectoryPath(dirPath);
+    std::shared_ptr<DirectoryCacheEntry> cacheEntry;
+    std::shared_ptr<std::vector<DirectoryEntry>> cachedEntries;
+    {
+        std::lock_guard<std::mutex> lock(*cacheMutex);
+        cacheEntry = getOrCreateCacheEntry(normalizedPath);
+        cacheEntry->lastAccess = ++accessCounter;
+        if (cacheEntry->entries && (cacheEntry->hasMetadata || !queryMetadata)) {
+            cachedEntries = cacheEntry->entries;
+        }
+    }
+
+    auto scan = std::make_shared<DirectoryScan>(normalizedPath, queryMetadata, cacheEntry);
+    if (cachedEntries) {
+        scan->entries = cachedEntries;
+        scan->isFromCache = true;
+        scan->isFinished = true;
+        return scan;
+    }
+
+    scanThreadPool->push([this, scan]() { scanTask(scan); });
+    return scan;
+}
+
+bool DirectoryScanner::scanDirectory(
+        const std::string& dirPath, std::vector<DirectoryEntry>& entries, bool queryMetadata) {
+    DirectoryScanPtr scan = scanDirectoryAsync(dirPath, queryMetadata);
+    scan->wait();
+    scan->fetchNewEntries(entries);
+    return !scan->getHasError();
+}
+
+void DirectoryScanner::invalidate(const std::string& dirPath) {
+    std::string normalizedPath = normalizeDirectoryPath(dirPath);
+    std::lock_guard<std::mutex> lock(*cacheMutex);
+    auto it = cacheEntries.find(normalizedPath);
+    if (it != cacheEntries.end()) {
+        it->second->generation++;
+        it->second->entries = {};
+    }
+}
+
+void DirectoryScanner::clearCache() {
+    std::lock_guard<std::mutex> lock(*cacheMutex);
+    while (!cacheEntries.empty()) {
+        removeCacheEntry(cacheEntries.begin());
+    }
+}
+
+void DirectoryScanner::setMaxNumCachedDirectories(size_t maxNum) {
+    std::lock_guard<std::mutex> lock(*cacheMutex);
+    maxNumCachedDirectories = maxNum;
+    evictCacheEntries();
+}
+
+void DirectoryScanner::finishScan(const DirectoryScanPtr& scan, bool success) {
+    if (success && !scan->isCancelled) {
+        storeListing(scan->cacheEntry, scan->cacheGeneration, scan->entries, scan->queryMetadata);
+    }
+    scan->finish();
+}
+
+std::shared_ptr<DirectoryCacheEntry> DirectoryScanner::getOrCreateCacheEntry(const std::string& normalizedPath) {
+    auto it = cacheEntries.find(normalizedPath);
+    if (it != cacheEntries.end()) {
+        return it->second;
+    }
+
+    auto cacheEntry = std::make_shared<DirectoryCacheEntry>();
+    cacheEntry->path = normalizedPath;
+    // The watch is added before the directory is scanned, so that changes during the scan are not missed.
+    // The callback does not capture this, as it may be called after the scanner was destroyed at program exit.
+    std::weak_ptr<DirectoryCacheEntry> cacheEntryWeak = cacheEntry;
+    std::shared_ptr<std::mutex> cacheMutexShared = cacheMutex;
+    cacheEntry->watchId = PathWatchManager::get()->addWatch(
+            normalizedPath, false, [cacheMutexShared, cacheEntryWeak](const std::vector<std::string>&) {
+        std::shared_ptr<DirectoryCacheEntry> cacheEntry = cacheEntryWeak.lock();
+        if (cacheEntry) {
+            std::lock_guard<std::mutex> lock(*cacheMutexShared);
+            cacheEntry->generation++;
+            cacheEntry->entries = {};
+        }
+    });
+    cacheEntries.insert(std::make_pair(normalizedPath, cacheEntry));
+    evictCacheEntries();
+    return cacheEntry;
+}
+
+void DirectoryScanner::storeListing(
+        const std::shared_ptr<DirectoryCacheEntry>& cacheEntry, uint64_t generation,
+        const std::shared_ptr<std::vector<DirectoryEntry>>& entries, bool hasMetadata) {
+    std::lock_guard<std::mutex> lock(*cacheMutex);
+    if (cacheEntry->generation.load() != generation) {
+        // The directory was changed during the scan.
+        return;
+    }
+    if (cacheEntry->entries && cacheEntry->hasMetadata && !hasMetadata) {
+        return;
+    }
+    cacheEntry->entries = entries;
+    cacheEntry->hasMetadata = hasMetadata;
+}
+
+void DirectoryScanner::evictCacheEntries() {
+    while (cacheEntries.size() > maxNumCachedDirectories) {
+        auto lruIt = cacheEntries.begin();
+        for (auto it = cacheEntries.begin(); it != cacheEntries.end(); it++) {
+            if (it->second->lastAccess < lruIt->second->lastAccess) {
+                lruIt = it;
+            }
+        }
+        removeCacheEntry(lruIt);
+    }
+}
+
+void DirectoryScanner::removeCacheEntry(std::map<std::string, std::shared_ptr<DirectoryCacheEntry>>::iterator it) {
+    if (it->second->watchId != 0) {
+        PathWatchManager::get()->removeWatch(it->second->watchId);
+    }
+    // Running scans of this directory can no longer be notified about changes.
+    it->second->generation++;
+    it->second->entries = {};
+    cacheEntries.erase(it);
+}
+
+#ifdef _WIN32
+
+static int64_t fileTimeToUnixTime(const FILETIME& fileTime) {
+    uint64_t fileTime100ns = (uint64_t(fileTime.dwHighDateTime) << 32ull) | uint64_t(fileTime.dwLowDateTime);
+    // FILETIME counts 100ns intervals since 1601-01-01.
+    return int64_t(fileTime100ns / 10000000ull) - int64_t(11644473600ll);
+}
+
+void DirectoryScanner::scanTask(const DirectoryScanPtr& scan) {
+    // FindFirstFileEx returns the metadata together with the names, so no separate queries are necessary.
+    std::string pattern = scan->path + "/*";
+    WIN32_FIND_DATAA findData;
+    HANDLE findHandle = FindFirstFileExA(
+            pattern.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (findHandle == INVALID_HANDLE_VALUE) {
+        scan->hasError = true;
+        finishScan(scan, false);
+        return;
+    }
+
+    std::vector<DirectoryEntry> chunkEntries;
+    do {
+        if (strcmp(findData.cFileName, ".") == 0 || strcmp(findData.cFileName, "..") == 0) {
+            continue;
+        }
+        DirectoryEntry entry;
+        entry.name = findData.cFileName;
+        if ((findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+            entry.type = DirectoryEntryType::SYMLINK;
+        } else if ((findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) {
+            entry.type = DirectoryEntryType::DIRECTORY;
+        } else {
+            entry.type = DirectoryEntryType::FILE;
+        }
+        entry.hasMetadata = true;
+        entry.fileSize = (uint64_t(findData.nFileSizeHigh) << 32ull) | uint64_t(findData.nFileSizeLow);
+        entry.modificationTime = fileTimeToUnixTime(findData.ftLastWriteTime);
+        chunkEntries.push_back(std::move(entry));
+        if (chunkEntries.size() >= DIRECTORY_SCAN_CHUNK_SIZE) {
+            scan->publishEntries(chunkEntries);
+        }
+    } while (!scan->isCancelled && FindNextFileA(findHandle, &findData));
+    FindClose(findHandle);
+
+    scan->publishEntries(chunkEntries);
+    finishScan(scan, true);
+}
+
+#else
+
+void DirectoryScanner::scanTask(const DirectoryScanPtr& scan) {
+    DIR* dir = opendir(scan->path.c_str());
+    if (!dir) {
+        scan->hasError = true;
+        finishScan(scan, false);
+        return;
+    }
+
+    std::vector<DirectoryEntry> chunkEntries;
+    auto processChunk = [this, &scan, &chunkEntries]() {
+        if (scan->queryMetadata) {
+            scan->numPendingTasks++;
+            metadataThreadPool->push([this, scan, entries = std::move(chunkEntries)]() mutable {
+                queryMetadataTask(scan, entries);
+            });
+            chunkEntries = {};
+        } else {
+            scan->publishEntries(chunkEntries);
+        }
+    };
+
+    struct dirent* dirEntry;
+    while (!scan->isCancelled && (dirEntry = readdir(dir)) != nullptr) {
+        const char* name = dirEntry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0) {
+            continue;
+        }
+        DirectoryEntry entry;
+        entry.name = name;
+#ifdef _DIRENT_HAVE_D_TYPE
+        switch (dirEntry->d_type) {
+            case DT_REG:
+                entry.type = DirectoryEntryType::FILE;
+                break;
+            case DT_DIR:
+                entry.type = DirectoryEntryType::DIRECTORY;
+                break;
+            case DT_LNK:
+                entry.type = DirectoryEntryType::SYMLINK;
+                break;
+            case DT_UNKNOWN: {
+                // Some file systems do not report the type of the entries.
+                struct stat entryStat{};
+                if (fstatat(dirfd(dir), name, &entryStat, AT_SYMLINK_NOFOLLOW) == 0) {
+                    if (S_ISREG(entryStat.st_mode)) {
+                        entry.type = DirectoryEntryType::FILE;
+                    } else if (S_ISDIR(entryStat.st_mode)) {
+                        entry.type = DirectoryEntryType::DIRECTORY;
+                    } else if (S_ISLNK(entryStat.st_mode)) {
+                        entry.type = DirectoryEntryType::SYMLINK;
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+#endif
+        chunkEntries.push_back(std::move(entry));
+        if (chunkEntries.size() >= DIRECTORY_SCAN_CHUNK_SIZE) {
+            processChunk();
+        }
+    }
+    closedir(dir);
+
+    if (!chunkEntries.empty()) {
+        processChunk();
+    }
+    if (--scan->numPendingTasks == 0) {
+        finishScan(scan, true);
+    }
+}
+
+void DirectoryScanner::queryMetadataTask(const DirectoryScanPtr& scan, std::vector<DirectoryEntry>& chunkEntries) {
+    if (!scan->isCancelled) {
+        std::string filePath;
+        for (DirectoryEntry& entry : chunkEntries) {
+            filePath = scan->path;
+            if (filePath.back() != '/') {
+                filePath += '/';
+            }
+            filePath += entry.name;
+            // Follows symbolic links, like the metadata displayed by file dialogs.
+            struct stat entryStat{};
+            if (stat(filePath.c_str(), &entryStat) == 0 || lstat(filePath.c_str(), &entryStat) == 0) {
+                entry.hasMetadata = true;
+                entry.fileSize = uint64_t(entryStat.st_size);
+                entry.modificationTime = int64_t(entryStat.st_mtime);
+                if (entry.type == DirectoryEntryType::OTHER) {
+                    if (S_ISREG(entryStat.st_mode)) {
+                        entry.type = DirectoryEntryType::FILE;
+                    } else if (S_ISDIR(entryStat.st_mode)) {
+                        entry.type = DirectoryEntryType::DIRECTORY;
+                    }
+                }
+            }
+        }
+        scan->publishEntries(chunkEntries);
+    }
+    if (--scan->numPendingTasks == 0) {
+        finishScan(scan, true);
+    }
+}
+
+#endif
+
+}
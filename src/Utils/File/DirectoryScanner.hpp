@@ -0,0 +1,179 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_DIRECTORYSCANNER_HPP
+#define SGL_DIRECTORYSCANNER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+
+#include <Utils/Singleton.hpp>
+
+namespace sgl {
+
+class ThreadPool;
+
+enum class DirectoryEntryType : uint8_t {
+    FILE, DIRECTORY, SYMLINK, OTHER
+};
+
+struct DirectoryEntry {
+    /// Name of the entry without the path of the directory, e.g., "Info.txt".
+    std::string name;
+    DirectoryEntryType type = DirectoryEntryType::OTHER;
+    /// Whether fileSize and modificationTime are valid (@see DirectoryScanner::scanDirectoryAsync).
+    bool hasMetadata = false;
+    uint64_t fileSize = 0;
+    /// Time of the last modification in seconds since the epoch.
+    int64_t modificationTime = 0;
+};
+
+struct DirectoryCacheEntry;
+
+/**
+ * Handle of a directory scan started by @see DirectoryScanner::scanDirectoryAsync. The entries are published
+ * incrementally while the scan is running and can be retrieved with @see fetchNewEntries, e.g., once per frame.
+ */
+class DLL_OBJECT DirectoryScan {
+    friend class DirectoryScanner;
+public:
+    DirectoryScan(std::string path, bool queryMetadata, std::shared_ptr<DirectoryCacheEntry> cacheEntry);
+
+    /// The normalized, absolute path of the scanned directory.
+    [[nodiscard]] inline const std::string& getPath() const { return path; }
+    /**
+     * Appends all entries found since the last call to 'entries'.
+     * @return The number of appended entries.
+     */
+    size_t fetchNewEntries(std::vector<DirectoryEntry>& entries);
+    /// Returns whether all entries were found (or the scan was cancelled or failed).
+    [[nodiscard]] inline bool getIsFinished() const { return isFinished; }
+    /// Returns whether the directory could not be opened.
+    [[nodiscard]] inline bool getHasError() const { return hasError; }
+    /// Returns whether the results were retrieved from the cache of the directory scanner.
+    [[nodiscard]] inline bool getIsFromCache() const { return isFromCache; }
+    /// Returns whether the directory was changed after the scan was started. A new scan should be started then.
+    [[nodiscard]] bool getIsOutdated() const;
+    /// Stops the scan as soon as possible. The entries found up to now can still be fetched.
+    void cancel();
+    [[nodiscard]] inline bool getIsCancelled() const { return isCancelled; }
+    /// Blocks until the scan has finished.
+    void wait();
+
+private:
+    void publishEntries(std::vector<DirectoryEntry>& newEntries);
+    void finish();
+
+    std::string path;
+    bool queryMetadata;
+    std::shared_ptr<DirectoryCacheEntry> cacheEntry;
+    uint64_t cacheGeneration = 0;
+
+    std::mutex entriesMutex;
+    std::condition_variable finishedCondition;
+    /// Only appended to while the scan is running; shared with the cache afterwards.
+    std::shared_ptr<std::vector<DirectoryEntry>> entries;
+    size_t numFetchedEntries = 0;
+    std::atomic<bool> isFinished{false};
+    std::atomic<bool> hasError{false};
+    std::atomic<bool> isCancelled{false};
+    bool isFromCache = false;
+    /// Enumeration of the directory plus outstanding metadata queries.
+    std::atomic<size_t> numPendingTasks{1};
+};
+
+typedef std::shared_ptr<DirectoryScan> DirectoryScanPtr;
+
+/**
+ * Scans directories asynchronously on background threads, so that, e.g., file dialogs do not block the UI on network
+ * file systems or directories with many files. On POSIX systems, the (potentially slow) metadata queries of the files
+ * of a directory are split into chunks that are processed in parallel.
+ * The listings of completed scans are cached. Cached directories are watched via @see PathWatchManager, and their
+ * listings are invalidated on changes. Please note that this requires PathWatchManager::update to be called regularly
+ * (which is done by AppLogic).
+ *
+ * Example usage:
+ * DirectoryScanPtr scan = DirectoryScanner::get()->scanDirectoryAsync("Data/Meshes");
+ * // Once per frame:
+ * scan->fetchNewEntries(entries);
+ */
+class DLL_OBJECT DirectoryScanner : public Singleton<DirectoryScanner> {
+public:
+    DirectoryScanner();
+    ~DirectoryScanner();
+
+    /**
+     * Starts scanning the passed directory. If a valid listing is cached, the returned scan is already finished.
+     * @param dirPath The path of the directory.
+     * @param queryMetadata Whether to query the file size and modification time of all entries.
+     */
+    DirectoryScanPtr scanDirectoryAsync(const std::string& dirPath, bool queryMetadata = true);
+    /// Synchronous version of @see scanDirectoryAsync. Returns false if the directory could not be opened.
+    bool scanDirectory(
+            const std::string& dirPath, std::vector<DirectoryEntry>& entries, bool queryMetadata = true);
+
+    /// Removes the cached listing of the passed directory.
+    void invalidate(const std::string& dirPath);
+    void clearCache();
+    /// The cached directories are evicted in least recently used order if more than this number are cached.
+    void setMaxNumCachedDirectories(size_t maxNum);
+
+private:
+    std::shared_ptr<DirectoryCacheEntry> getOrCreateCacheEntry(const std::string& normalizedPath);
+    void storeListing(
+            const std::shared_ptr<DirectoryCacheEntry>& cacheEntry, uint64_t generation,
+            const std::shared_ptr<std::vector<DirectoryEntry>>& entries, bool hasMetadata);
+    void evictCacheEntries();
+    void removeCacheEntry(std::map<std::string, std::shared_ptr<DirectoryCacheEntry>>::iterator it);
+    void scanTask(const DirectoryScanPtr& scan);
+#ifndef _WIN32
+    void queryMetadataTask(const DirectoryScanPtr& scan, std::vector<DirectoryEntry>& chunkEntries);
+#endif
+    void finishScan(const DirectoryScanPtr& scan, bool success);
+
+    /// Shared with the callbacks of the path watches, which may outlive the scanner.
+    std::shared_ptr<std::mutex> cacheMutex = std::make_shared<std::mutex>();
+    std::map<std::string, std::shared_ptr<DirectoryCacheEntry>> cacheEntries;
+    size_t maxNumCachedDirectories = 64;
+    uint64_t accessCounter = 0;
+
+    /// Enumerates directories.
+    ThreadPool* scanThreadPool = nullptr;
+    /// Queries the metadata of chunks of directory entries.
+    ThreadPool* metadataThreadPool = nullptr;
+};
+
+}
+
+#endif //SGL_DIRECTORYSCANNER_HPP
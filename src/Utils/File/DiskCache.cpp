@@ -0,0 +1,419 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+#include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Logfile.hpp"
+#include "FileUtils.hpp"
+#include "DiskCache.hpp"
+
+namespace sgl {
+
+static const uint32_t DISK_CACHE_MAGIC = 0x434C4753u; // "SGLC"
+static const uint32_t DISK_CACHE_CONTAINER_VERSION = 1u;
+static const char* const DISK_CACHE_FILE_EXTENSION = ".sglcache";
+
+static uint64_t getProcessId() {
+#ifdef _WIN32
+    return uint64_t(_getpid());
+#else
+    return uint64_t(getpid());
+#endif
+}
+
+struct DiskCacheFileHeader {
+    uint32_t magic;
+    uint32_t containerVersion;
+    uint32_t formatVersion;
+    uint32_t reserved;
+    uint64_t keyHash;
+    uint64_t payloadSize;
+    /// XXH64 hash of the payload for detecting truncated or corrupted files.
+    uint64_t payloadHash;
+};
+
+DiskCacheKey::DiskCacheKey(const std::string& _category) {
+    // Only characters that are safe in filenames on all platforms are kept.
+    for (char c : _category) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_') {
+            category += c;
+        } else {
+            category += '_';
+        }
+    }
+    addParameter(category);
+}
+
+bool DiskCacheKey::addFile(const std::string& filename) {
+    uint64_t fileHash = 0;
+    if (!computeFileXXHash64(filename, fileHash)) {
+        isValid = false;
+        return false;
+    }
+    addParameter(fileHash);
+    return true;
+}
+
+bool DiskCacheKey::addFileMetadata(const std::string& filename) {
+    boost::system::error_code errorCode;
+    boost::filesystem::path path = boost::filesystem::absolute(filename);
+    uint64_t fileSize = boost::filesystem::file_size(path, errorCode);
+    if (errorCode) {
+        isValid = false;
+        return false;
+    }
+    int64_t lastWriteTime = int64_t(boost::filesystem::last_write_time(path, errorCode));
+    if (errorCode) {
+        isValid = false;
+        return false;
+    }
+    addParameter(path.generic_string());
+    addParameter(fileSize);
+    addParameter(lastWriteTime);
+    return true;
+}
+
+void DiskCacheKey::addData(const void* data, size_t size) {
+    hasher.update(data, size);
+}
+
+void DiskCacheKey::addParameter(const std::string& value) {
+    // The length is added so that, e.g., ("ab", "c") and ("a", "bc") result in different keys.
+    addParameter(uint64_t(value.size()));
+    addData(value.data(), value.size());
+}
+
+void DiskCacheKey::addParameter(const char* value) {
+    addParameter(std::string(value));
+}
+
+std::string DiskCacheKey::getFilename() const {
+    char hashString[17];
+    snprintf(hashString, sizeof(hashString), "%016llx", static_cast<unsigned long long>(getHash()));
+    return category + "_" + hashString + DISK_CACHE_FILE_EXTENSION;
+}
+
+
+void DiskCache::setCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cacheDirectory = directory;
+    if (!cacheDirectory.empty() && cacheDirectory.back() != '/' && cacheDirectory.back() != '\\') {
+        cacheDirectory += '/';
+    }
+}
+
+std::string DiskCache::getCacheDirectory() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return getCacheDirectoryLocked();
+}
+
+std::string DiskCache::getCacheDirectoryLocked() {
+    if (cacheDirectory.empty()) {
+        cacheDirectory = FileUtils::get()->getCacheDirectory();
+    }
+    return cacheDirectory;
+}
+
+bool DiskCache::getHasCacheDirectoryLocked() {
+    if (!getCacheDirectoryLocked().empty()) {
+        return true;
+    }
+    // Otherwise, the entries would be stored in (and evicted from) the working directory.
+    if (!hasWarnedAboutMissingDirectory) {
+        hasWarnedAboutMissingDirectory = true;
+        sgl::Logfile::get()->writeWarning(
+                "Warning in DiskCache: No cache directory is set (FileUtils::initialize was not called). "
+                "The disk cache is not used.", false);
+    }
+    return false;
+}
+
+void DiskCache::setMaxCacheSizeInBytes(uint64_t maxSize) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    maxCacheSizeInBytes = maxSize;
+    evictLocked();
+}
+
+bool DiskCache::store(const DiskCacheKey& key, uint32_t formatVersion, const BinaryWriteStream& stream) {
+    // The segments of the stream are written one after another, so they do not need to be merged.
+    return storeSegments(key, formatVersion, stream.getSize(), [&stream](const SegmentCallback& callback) {
+        stream.forEachSegment(callback);
+    });
+}
+
+bool DiskCache::store(const DiskCacheKey& key, uint32_t formatVersion, const void* data, size_t size) {
+    return storeSegments(key, formatVersion, size, [data, size](const SegmentCallback& callback) {
+        callback(static_cast<const uint8_t*>(data), size);
+    });
+}
+
+bool DiskCache::storeSegments(
+        const DiskCacheKey& key, uint32_t formatVersion, size_t size,
+        const std::function<void(const SegmentCallback&)>& forEachSegment) {
+    if (!isEnabled || !key.getIsValid()) {
+        return false;
+    }
+
+    DiskCacheFileHeader header{};
+    header.magic = DISK_CACHE_MAGIC;
+    header.containerVersion = DISK_CACHE_CONTAINER_VERSION;
+    header.formatVersion = formatVersion;
+    header.keyHash = key.getHash();
+    header.payloadSize = uint64_t(size);
+    XXHash64 payloadHasher;
+    forEachSegment([&payloadHasher](const uint8_t* segmentData, size_t segmentSize) {
+        payloadHasher.update(segmentData, segmentSize);
+    });
+    header.payloadHash = payloadHasher.digest();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!getHasCacheDirectoryLocked()) {
+        return false;
+    }
+    std::string directory = getCacheDirectoryLocked();
+    FileUtils::get()->ensureDirectoryExists(directory);
+    std::string filename = directory + key.getFilename();
+
+    // Write to a temporary file first, so that other processes never see partially written entries. The process ID
+    // keeps the names of the temporary files of multiple processes storing the same entry apart.
+    std::string tempFilename =
+            filename + ".tmp" + std::to_string(getProcessId()) + "_" + std::to_string(tempFileCounter++);
+    FILE* file = fopen(tempFilename.c_str(), "wb");
+    if (!file) {
+        sgl::Logfile::get()->writeError(
+                "Error in DiskCache::store: File \"" + tempFilename + "\" could not be opened for writing.");
+        return false;
+    }
+    bool success = fwrite(&header, sizeof(DiskCacheFileHeader), 1, file) == 1;
+    forEachSegment([&success, file](const uint8_t* segmentData, size_t segmentSize) {
+        if (success && segmentSize > 0) {
+            success = fwrite(segmentData, 1, segmentSize, file) == segmentSize;
+        }
+    });
+    success = fclose(file) == 0 && success;
+
+    boost::system::error_code errorCode;
+    if (success) {
+        boost::filesystem::rename(tempFilename, filename, errorCode);
+        success = !errorCode;
+    }
+    if (!success) {
+        sgl::Logfile::get()->writeError("Error in DiskCache::store: File \"" + filename + "\" could not be written.");
+        boost::filesystem::remove(tempFilename, errorCode);
+        return false;
+    }
+
+    evictLocked();
+    return true;
+}
+
+ReadStreamPtr DiskCache::load(const DiskCacheKey& key, uint32_t formatVersion) {
+    if (!isEnabled || !key.getIsValid()) {
+        return {};
+    }
+
+    // The file is read and verified without holding the mutex, so that large entries do not block other threads.
+    // Entries are replaced atomically by store, so a concurrent store cannot lead to partially read data.
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (!getHasCacheDirectoryLocked()) {
+            return {};
+        }
+        filename = getCacheDirectoryLocked() + key.getFilename();
+    }
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (!file) {
+        return {};
+    }
+
+    boost::system::error_code errorCode;
+    uintmax_t fileSize = boost::filesystem::file_size(filename, errorCode);
+    if (errorCode) {
+        fileSize = 0;
+    }
+
+    // The payload size is checked against the file size before allocating, as the header might be corrupted.
+    DiskCacheFileHeader header{};
+    bool isValidEntry =
+            fileSize >= sizeof(DiskCacheFileHeader)
+            && fread(&header, sizeof(DiskCacheFileHeader), 1, file) == 1
+            && header.magic == DISK_CACHE_MAGIC
+            && header.containerVersion == DISK_CACHE_CONTAINER_VERSION
+            && header.keyHash == key.getHash()
+            && header.payloadSize == uint64_t(fileSize - sizeof(DiskCacheFileHeader));
+    if (isValidEntry && header.formatVersion != formatVersion) {
+        // The entry was written by another version of the application; it will be overwritten.
+        fclose(file);
+        return {};
+    }
+
+    uint8_t* buffer = nullptr;
+    if (isValidEntry) {
+        buffer = new uint8_t[header.payloadSize];
+        isValidEntry =
+                fread(buffer, 1, header.payloadSize, file) == header.payloadSize
+                && computeXXHash64(buffer, header.payloadSize) == header.payloadHash;
+    }
+    fclose(file);
+
+    if (!isValidEntry) {
+        sgl::Logfile::get()->writeWarning(
+                "Warning in DiskCache::load: Removing the corrupted cache file \"" + filename + "\".", false);
+        delete[] buffer;
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        boost::filesystem::remove(filename, errorCode);
+        return {};
+    }
+
+    // Mark the entry as recently used for the eviction policy.
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        boost::filesystem::last_write_time(filename, std::time(nullptr), errorCode);
+    }
+
+    // The stream takes ownership of the buffer.
+    return std::make_shared<BinaryReadStream>(
+            static_cast<const void*>(buffer), size_t(header.payloadSize), StreamBufferOwnership::TAKE);
+}
+
+void DiskCache::remove(const DiskCacheKey& key) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!getHasCacheDirectoryLocked()) {
+        return;
+    }
+    boost::system::error_code errorCode;
+    boost::filesystem::remove(getCacheDirectoryLocked() + key.getFilename(), errorCode);
+}
+
+struct DiskCacheEntryInfo {
+    boost::filesystem::path path;
+    uint64_t fileSize;
+    std::time_t lastUseTime;
+};
+
+static std::vector<DiskCacheEntryInfo> getDiskCacheEntries(const std::string& directory) {
+    std::vector<DiskCacheEntryInfo> entries;
+    boost::system::error_code errorCode;
+    boost::filesystem::directory_iterator it(directory, errorCode), end;
+    if (errorCode) {
+        return entries;
+    }
+    for (; it != end; it.increment(errorCode)) {
+        if (errorCode) {
+            break;
+        }
+        const boost::filesystem::path& path = it->path();
+        if (path.extension() != DISK_CACHE_FILE_EXTENSION) {
+            continue;
+        }
+        DiskCacheEntryInfo entry;
+        entry.path = path;
+        entry.fileSize = boost::filesystem::file_size(path, errorCode);
+        if (errorCode) {
+            continue;
+        }
+        entry.lastUseTime = boost::filesystem::last_write_time(path, errorCode);
+        if (errorCode) {
+            continue;
+        }
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+void DiskCache::clear() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!getHasCacheDirectoryLocked()) {
+        return;
+    }
+    boost::system::error_code errorCode;
+    for (const DiskCacheEntryInfo& entry : getDiskCacheEntries(getCacheDirectoryLocked())) {
+        boost::filesystem::remove(entry.path, errorCode);
+    }
+}
+
+uint64_t DiskCache::getCacheSizeInBytes() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    uint64_t cacheSize = 0;
+    if (!getHasCacheDirectoryLocked()) {
+        return cacheSize;
+    }
+    for (const DiskCacheEntryInfo& entry : getDiskCacheEntries(getCacheDirectoryLocked())) {
+        cacheSize += entry.fileSize;
+    }
+    return cacheSize;
+}
+
+void DiskCache::evict() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    evictLocked();
+}
+
+void DiskCache::evictLocked() {
+    if (!getHasCacheDirectoryLocked()) {
+        return;
+    }
+    std::vector<DiskCacheEntryInfo> entries = getDiskCacheEntries(getCacheDirectoryLocked());
+    uint64_t cacheSize = 0;
+    for (const DiskCacheEntryInfo& entry : entries) {
+        cacheSize += entry.fileSize;
+    }
+    if (cacheSize <= maxCacheSizeInBytes) {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const DiskCacheEntryInfo& a, const DiskCacheEntryInfo& b) {
+        return a.lastUseTime < b.lastUseTime;
+    });
+    boost::system::error_code errorCode;
+    for (const DiskCacheEntryInfo& entry : entries) {
+        if (cacheSize <= maxCacheSizeInBytes) {
+            break;
+        }
+        boost::filesystem::remove(entry.path, errorCode);
+        if (!errorCode) {
+            cacheSize -= entry.fileSize;
+        }
+    }
+}
+
+}
@@ -0,0 +1,166 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_DISKCACHE_HPP
+#define SGL_DISKCACHE_HPP
+
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+
+#include <Utils/Singleton.hpp>
+#include <Utils/Events/Stream/Stream.hpp>
+#include "ContentHash.hpp"
+
+namespace sgl {
+
+/**
+ * Identifies an entry of the @see DiskCache. The key combines a category name (e.g., "SharedIndexRepresentation")
+ * with the content hashes of the source files and all parameters influencing the derived data.
+ *
+ * Example usage:
+ * DiskCacheKey key("SmoothedMesh");
+ * key.addFile(meshFilename);
+ * key.addParameter(numIterations);
+ * key.addParameter(lambda);
+ */
+class DLL_OBJECT DiskCacheKey {
+public:
+    explicit DiskCacheKey(const std::string& category);
+
+    /// Adds the content hash of the file. Returns false if the file could not be read (the key is invalid then).
+    bool addFile(const std::string& filename);
+    /**
+     * Cheaper alternative to @see addFile for very large files: Only the path, size and modification time of the file
+     * are added to the key instead of its content.
+     */
+    bool addFileMetadata(const std::string& filename);
+    void addData(const void* data, size_t size);
+    /// Adds a parameter of a trivially copyable type (e.g., numbers, enums or structs without pointers).
+    template<class T>
+    void addParameter(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "DiskCacheKey::addParameter: Unsupported type.");
+        addData(&value, sizeof(T));
+    }
+    void addParameter(const std::string& value);
+    void addParameter(const char* value);
+
+    [[nodiscard]] inline const std::string& getCategory() const { return category; }
+    [[nodiscard]] inline uint64_t getHash() const { return hasher.digest(); }
+    [[nodiscard]] inline bool getIsValid() const { return isValid; }
+    /// Returns the name of the cache file, i.e., "<category>_<hash>.sglcache".
+    [[nodiscard]] std::string getFilename() const;
+
+private:
+    std::string category;
+    XXHash64 hasher;
+    bool isValid = true;
+};
+
+/**
+ * Stores derived data that is expensive to compute (e.g., shared index representations, smoothed meshes, histograms,
+ * search structures) across runs of the application. The entries are versioned binary blobs written via
+ * @see BinaryWriteStream. If the accumulated size of all entries exceeds the maximum cache size, the least recently
+ * used entries are removed. By default, the entries are stored in @see FileUtils::getCacheDirectory.
+ * The cache may be used from multiple threads.
+ *
+ * Example usage:
+ * ReadStreamPtr stream = DiskCache::get()->load(key, FORMAT_VERSION);
+ * if (stream) {
+ *     stream->readArray(indices);
+ * } else {
+ *     computeIndices(indices);
+ *     BinaryWriteStream writeStream;
+ *     writeStream.writeArray(indices);
+ *     DiskCache::get()->store(key, FORMAT_VERSION, writeStream);
+ * }
+ */
+class DLL_OBJECT DiskCache : public Singleton<DiskCache> {
+public:
+    /**
+     * Sets the directory the entries are stored in. The directory is created when the first entry is stored.
+     * Defaults to the cache directory of @see FileUtils. If neither is set, nothing is stored and all lookups fail.
+     */
+    void setCacheDirectory(const std::string& directory);
+    std::string getCacheDirectory();
+    /// Sets the maximum accumulated size of all entries (default: 2GiB).
+    void setMaxCacheSizeInBytes(uint64_t maxSize);
+    [[nodiscard]] inline uint64_t getMaxCacheSizeInBytes() const { return maxCacheSizeInBytes; }
+    /// If the cache is disabled, nothing is stored and all lookups fail.
+    inline void setIsEnabled(bool enabled) { isEnabled = enabled; }
+    [[nodiscard]] inline bool getIsEnabled() const { return isEnabled; }
+
+    /**
+     * Stores the data of the stream for the passed key.
+     * @param key The key of the entry.
+     * @param formatVersion The version of the serialization format of the data. Entries with a different version are
+     * treated as missing by @see load.
+     * @param stream The data to store.
+     * @return Whether the data could be stored.
+     */
+    bool store(const DiskCacheKey& key, uint32_t formatVersion, const BinaryWriteStream& stream);
+    bool store(const DiskCacheKey& key, uint32_t formatVersion, const void* data, size_t size);
+    /**
+     * Loads the data stored for the passed key.
+     * @return The stream containing the data, or an empty pointer if no valid entry with the same format version
+     * exists.
+     */
+    ReadStreamPtr load(const DiskCacheKey& key, uint32_t formatVersion);
+    /// Removes the entry with the passed key (if it exists).
+    void remove(const DiskCacheKey& key);
+    /// Removes all entries.
+    void clear();
+    /// Returns the accumulated size of all entries in bytes.
+    uint64_t getCacheSizeInBytes();
+    /// Removes the least recently used entries until the maximum cache size is no longer exceeded.
+    void evict();
+
+private:
+    typedef std::function<void(const uint8_t* data, size_t size)> SegmentCallback;
+    /// Stores the data passed to the callback of 'forEachSegment' in order, which needs to sum up to 'size' bytes.
+    bool storeSegments(
+            const DiskCacheKey& key, uint32_t formatVersion, size_t size,
+            const std::function<void(const SegmentCallback&)>& forEachSegment);
+    std::string getCacheDirectoryLocked();
+    /// Returns false (and warns once) if no cache directory is set, in which case the cache is not used.
+    bool getHasCacheDirectoryLocked();
+    void evictLocked();
+
+    std::mutex cacheMutex;
+    std::string cacheDirectory;
+    uint64_t maxCacheSizeInBytes = uint64_t(2) * 1024 * 1024 * 1024;
+    bool isEnabled = true;
+    bool hasWarnedAboutMissingDirectory = false;
+    uint64_t tempFileCounter = 0;
+};
+
+}
+
+#endif //SGL_DISKCACHE_HPP
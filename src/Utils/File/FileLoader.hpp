@@ -58,6 +58,7 @@ DLL_OBJECT bool loadFileFromSource(
 
 /**
  * Like @see loadFileFromSource, but only the first 'numBytesToRead' bytes are read.
+ * For repeated reads of arbitrary ranges of the same file, @see FileRangeReader should be used instead.
  */
 DLL_OBJECT bool loadFileFromSourceRanged(
         const std::string& filename, uint8_t*& buffer, size_t& bufferSize,
@@ -0,0 +1,492 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SGL_USE_IO_URING
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+#include <Utils/Parallel/ThreadPool.hpp>
+#include "Logfile.hpp"
+#include "FileLoader.hpp"
+#include "FileLoaderBatch.hpp"
+
+namespace sgl {
+
+static void loadFilesBatchThreadPool(
+        const std::vector<std::string>& filenames, const std::vector<size_t>& fileIndices,
+        std::vector<ResourceBufferPtr>& buffers, size_t maxNumRequestsInFlight) {
+    if (fileIndices.empty()) {
+        return;
+    }
+    size_t numThreads = std::min(fileIndices.size(), std::max(size_t(1), maxNumRequestsInFlight));
+    numThreads = std::min(numThreads, size_t(std::max(std::thread::hardware_concurrency(), 4u)) * 2);
+    ThreadPool threadPool(numThreads);
+    for (size_t fileIdx : fileIndices) {
+        threadPool.push([&filenames, &buffers, fileIdx]() {
+            uint8_t* buffer = nullptr;
+            size_t bufferSize = 0;
+            const ResourceBufferPtr& resource = buffers.at(fileIdx);
+            if (loadFileFromSource(filenames.at(fileIdx), buffer, bufferSize, true)) {
+                resource->setData(reinterpret_cast<char*>(buffer), bufferSize);
+            } else {
+                resource->setHasLoadingFailed();
+            }
+            resource->setIsLoaded();
+        });
+    }
+    threadPool.waitIdle();
+}
+
+#ifdef SGL_USE_IO_URING
+
+/**
+ * Minimal wrapper around the io_uring system calls. liburing is not used to avoid an additional dependency, as only
+ * the submission of opens and reads is needed.
+ */
+class IoUring {
+public:
+    ~IoUring() {
+        if (sqes) {
+            munmap(sqes, sqesSize);
+        }
+        if (cqPtr && cqPtr != sqPtr) {
+            munmap(cqPtr, cqSize);
+        }
+        if (sqPtr) {
+            munmap(sqPtr, sqSize);
+        }
+        if (ringFd >= 0) {
+            close(ringFd);
+        }
+    }
+
+    bool initialize(unsigned numEntries) {
+        io_uring_params params{};
+        ringFd = int(syscall(__NR_io_uring_setup, numEntries, &params));
+        if (ringFd < 0) {
+            return false;
+        }
+
+        sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMmap) {
+            sqSize = std::max(sqSize, cqSize);
+            cqSize = sqSize;
+        }
+        sqPtr = mmap(
+                nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqPtr == MAP_FAILED) {
+            sqPtr = nullptr;
+            return false;
+        }
+        if (singleMmap) {
+            cqPtr = sqPtr;
+        } else {
+            cqPtr = mmap(
+                    nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+            if (cqPtr == MAP_FAILED) {
+                cqPtr = nullptr;
+                return false;
+            }
+        }
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        auto* sqesPtr = mmap(
+                nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if (sqesPtr == MAP_FAILED) {
+            return false;
+        }
+        sqes = reinterpret_cast<io_uring_sqe*>(sqesPtr);
+
+        auto* sqBase = reinterpret_cast<uint8_t*>(sqPtr);
+        sqHead = reinterpret_cast<unsigned*>(sqBase + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+        sqRingMask = *reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+        auto* cqBase = reinterpret_cast<uint8_t*>(cqPtr);
+        cqHead = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+        cqRingMask = *reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+        numSqEntries = params.sq_entries;
+        localSqTail = *sqTail;
+        return true;
+    }
+
+    [[nodiscard]] inline unsigned getNumEntries() const { return numSqEntries; }
+    /// Returns the number of submission queue entries that can be queued without overwriting unconsumed ones.
+    [[nodiscard]] inline unsigned getNumFreeSqes() const {
+        return numSqEntries - (localSqTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE));
+    }
+
+    /// Returns a cleared submission queue entry. The caller must not queue more than @see getNumEntries entries.
+    io_uring_sqe* getSqe() {
+        unsigned index = localSqTail & sqRingMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(io_uring_sqe));
+        sqArray[index] = index;
+        localSqTail++;
+        numPendingSubmissions++;
+        return sqe;
+    }
+
+    /// Submits all queued entries and waits for at least 'minNumCompletions' completions.
+    bool submitAndWait(unsigned minNumCompletions) {
+        __atomic_store_n(sqTail, localSqTail, __ATOMIC_RELEASE);
+        while (true) {
+            int ret = int(syscall(
+                    __NR_io_uring_enter, ringFd, numPendingSubmissions, minNumCompletions,
+                    minNumCompletions > 0 ? IORING_ENTER_GETEVENTS : 0u, nullptr, size_t(0)));
+            if (ret >= 0) {
+                numPendingSubmissions -= std::min(unsigned(ret), numPendingSubmissions);
+                return true;
+            }
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                return false;
+            }
+        }
+    }
+
+    /// Calls 'callback(userData, result)' for all available completions.
+    template<class Func>
+    void forEachCompletion(Func callback) {
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = cqes[head & cqRingMask];
+            uint64_t userData = cqe.user_data;
+            int32_t result = cqe.res;
+            head++;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+            callback(userData, result);
+        }
+    }
+
+private:
+    int ringFd = -1;
+    void* sqPtr = nullptr;
+    void* cqPtr = nullptr;
+    size_t sqSize = 0, cqSize = 0, sqesSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqRingMask = 0;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqRingMask = 0;
+    unsigned numSqEntries = 0;
+    unsigned localSqTail = 0;
+    unsigned numPendingSubmissions = 0;
+};
+
+enum class BatchFileState {
+    OPENING, READING
+};
+
+struct BatchFileRequest {
+    size_t fileIdx = 0;
+    BatchFileState state = BatchFileState::OPENING;
+    int fd = -1;
+    uint8_t* buffer = nullptr;
+    size_t bufferSize = 0;
+    size_t numBytesRead = 0;
+    /// Whether an open or read operation was queued for which no completion was reaped yet.
+    bool isInFlight = false;
+    bool isCancelQueued = false;
+};
+
+// Reads are limited to 1GiB per request (the kernel caps single reads slightly below 2GiB); larger files are read in
+// multiple steps.
+static const size_t IO_URING_MAX_READ_SIZE = size_t(1) << 30;
+
+/**
+ * Loads the files using io_uring. Every file passes through the stages open -> (fstat) -> read (-> read ...).
+ * Files that cannot be opened directly (e.g., files stored in archives) are left unloaded for the fallback path.
+ * @return false if io_uring could not be initialized or failed.
+ */
+static bool loadFilesBatchIoUring(
+        const std::vector<std::string>& filenames, std::vector<ResourceBufferPtr>& buffers,
+        size_t maxNumRequestsInFlight) {
+    IoUring ring;
+    auto numEntries = unsigned(std::clamp(maxNumRequestsInFlight, size_t(1), size_t(4096)));
+    if (!ring.initialize(numEntries)) {
+        return false;
+    }
+    // The kernel may round the number of entries up.
+    size_t maxNumInFlight = std::min(size_t(ring.getNumEntries()), maxNumRequestsInFlight);
+
+    std::vector<BatchFileRequest> requests(maxNumInFlight);
+    std::vector<size_t> freeRequestIndices;
+    freeRequestIndices.reserve(maxNumInFlight);
+    for (size_t i = 0; i < maxNumInFlight; i++) {
+        freeRequestIndices.push_back(maxNumInFlight - i - 1);
+    }
+    std::vector<std::string> errorMessages;
+
+    auto queueOpen = [&](size_t requestIdx) {
+        BatchFileRequest& request = requests.at(requestIdx);
+        io_uring_sqe* sqe = ring.getSqe();
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(filenames.at(request.fileIdx).c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = requestIdx;
+        request.isInFlight = true;
+    };
+    auto queueRead = [&](size_t requestIdx) {
+        BatchFileRequest& request = requests.at(requestIdx);
+        io_uring_sqe* sqe = ring.getSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(request.buffer + request.numBytesRead);
+        sqe->len = unsigned(std::min(request.bufferSize - request.numBytesRead, IO_URING_MAX_READ_SIZE));
+        sqe->off = request.numBytesRead;
+        sqe->user_data = requestIdx;
+        request.isInFlight = true;
+    };
+    auto finishRequest = [&](size_t requestIdx, bool success) {
+        BatchFileRequest& request = requests.at(requestIdx);
+        if (request.fd >= 0) {
+            close(request.fd);
+            request.fd = -1;
+        }
+        const ResourceBufferPtr& resource = buffers.at(request.fileIdx);
+        if (success) {
+            resource->setData(reinterpret_cast<char*>(request.buffer), request.bufferSize);
+        } else {
+            delete[] request.buffer;
+            resource->setHasLoadingFailed();
+            errorMessages.push_back(
+                    "Error in loadFilesBatch: File \"" + filenames.at(request.fileIdx) + "\" could not be read.");
+        }
+        resource->setIsLoaded();
+        request.buffer = nullptr;
+        freeRequestIndices.push_back(requestIdx);
+    };
+
+    size_t nextFileIdx = 0;
+    size_t numInFlight = 0;
+    bool ringFailed = false;
+    while (nextFileIdx < filenames.size() || numInFlight > 0) {
+        // Keep the queue filled with open requests for the next files.
+        while (nextFileIdx < filenames.size() && !freeRequestIndices.empty()) {
+            size_t requestIdx = freeRequestIndices.back();
+            freeRequestIndices.pop_back();
+            BatchFileRequest& request = requests.at(requestIdx);
+            request = BatchFileRequest();
+            request.fileIdx = nextFileIdx++;
+            queueOpen(requestIdx);
+            numInFlight++;
+        }
+
+        if (!ring.submitAndWait(1)) {
+            ringFailed = true;
+            break;
+        }
+        ring.forEachCompletion([&](uint64_t requestIdx, int32_t result) {
+            BatchFileRequest& request = requests.at(requestIdx);
+            request.isInFlight = false;
+            if (request.state == BatchFileState::OPENING) {
+                if (result < 0) {
+                    // The file might be stored in an archive; let loadFileFromSource handle it.
+                    freeRequestIndices.push_back(requestIdx);
+                    numInFlight--;
+                    return;
+                }
+                request.fd = result;
+                struct stat fileStat{};
+                if (fstat(request.fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+                    finishRequest(requestIdx, false);
+                    numInFlight--;
+                    return;
+                }
+                request.bufferSize = size_t(fileStat.st_size);
+                request.buffer = new uint8_t[request.bufferSize];
+                request.state = BatchFileState::READING;
+                if (request.bufferSize == 0) {
+                    finishRequest(requestIdx, true);
+                    numInFlight--;
+                    return;
+                }
+                queueRead(requestIdx);
+            } else {
+                if (result <= 0) {
+                    // Error or unexpected end of file.
+                    finishRequest(requestIdx, false);
+                    numInFlight--;
+                    return;
+                }
+                request.numBytesRead += size_t(result);
+                if (request.numBytesRead < request.bufferSize) {
+                    // Short read; queue the remainder.
+                    queueRead(requestIdx);
+                } else {
+                    finishRequest(requestIdx, true);
+                    numInFlight--;
+                }
+            }
+        });
+    }
+
+    if (ringFailed) {
+        /*
+         * Operations that were already submitted may still be processed by the kernel, which might write to the
+         * request buffers or return new file descriptors. Thus, all outstanding operations are cancelled and their
+         * completions are reaped before the file descriptors are closed and the buffers are freed.
+         */
+        const uint64_t cancelUserData = std::numeric_limits<uint64_t>::max();
+        bool canReapCompletions = true;
+        while (numInFlight > 0 && canReapCompletions) {
+            for (size_t requestIdx = 0; requestIdx < requests.size() && ring.getNumFreeSqes() > 0; requestIdx++) {
+                BatchFileRequest& request = requests.at(requestIdx);
+                if (request.isInFlight && !request.isCancelQueued) {
+                    io_uring_sqe* sqe = ring.getSqe();
+                    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                    sqe->addr = uint64_t(requestIdx);
+                    sqe->user_data = cancelUserData;
+                    request.isCancelQueued = true;
+                }
+            }
+            canReapCompletions = ring.submitAndWait(1);
+            ring.forEachCompletion([&](uint64_t userData, int32_t result) {
+                if (userData == cancelUserData) {
+                    return;
+                }
+                BatchFileRequest& request = requests.at(userData);
+                request.isInFlight = false;
+                if (request.state == BatchFileState::OPENING && result >= 0) {
+                    request.fd = result;
+                }
+                numInFlight--;
+            });
+        }
+
+        // All files that did not finish yet are handed over to the fallback path.
+        for (BatchFileRequest& request : requests) {
+            if (request.isInFlight) {
+                // The kernel might still write to the buffer, so it can only be leaked.
+                continue;
+            }
+            if (request.fd >= 0) {
+                close(request.fd);
+                request.fd = -1;
+            }
+            delete[] request.buffer;
+            request.buffer = nullptr;
+        }
+        if (numInFlight > 0) {
+            errorMessages.emplace_back(
+                    "Error in loadFilesBatch: Outstanding io_uring requests could not be cancelled.");
+        }
+    }
+
+    for (const std::string& errorMessage : errorMessages) {
+        sgl::Logfile::get()->writeError(errorMessage);
+    }
+    return !ringFailed;
+}
+
+static std::atomic<int> isIoUringAvailableCache{-1};
+
+bool getIsIoUringAvailable() {
+    int isAvailable = isIoUringAvailableCache.load();
+    if (isAvailable < 0) {
+        IoUring ring;
+        isAvailable = ring.initialize(1) ? 1 : 0;
+        isIoUringAvailableCache.store(isAvailable);
+    }
+    return isAvailable != 0;
+}
+
+#else
+
+bool getIsIoUringAvailable() {
+    return false;
+}
+
+#endif
+
+bool loadFilesBatch(
+        const std::vector<std::string>& filenames, std::vector<ResourceBufferPtr>& buffers,
+        size_t maxNumRequestsInFlight) {
+    if (buffers.size() != filenames.size()) {
+        buffers.clear();
+        buffers.reserve(filenames.size());
+        for (size_t i = 0; i < filenames.size(); i++) {
+            buffers.push_back(std::make_shared<ResourceBuffer>());
+        }
+    }
+    if (filenames.empty()) {
+        return true;
+    }
+    maxNumRequestsInFlight = std::max(maxNumRequestsInFlight, size_t(1));
+
+#ifdef SGL_USE_IO_URING
+    if (getIsIoUringAvailable()) {
+        loadFilesBatchIoUring(filenames, buffers, maxNumRequestsInFlight);
+    }
+#endif
+
+    // Files in archives, files that could not be opened and all files if io_uring is not available.
+    std::vector<size_t> fallbackFileIndices;
+    for (size_t fileIdx = 0; fileIdx < filenames.size(); fileIdx++) {
+        if (!buffers.at(fileIdx)->getIsLoaded()) {
+            fallbackFileIndices.push_back(fileIdx);
+        }
+    }
+    loadFilesBatchThreadPool(filenames, fallbackFileIndices, buffers, maxNumRequestsInFlight);
+
+    return std::none_of(buffers.begin(), buffers.end(), [](const ResourceBufferPtr& buffer) {
+        return buffer->getHasLoadingFailed();
+    });
+}
+
+std::future<std::vector<ResourceBufferPtr>> loadFilesBatchAsync(
+        const std::vector<std::string>& filenames, size_t maxNumRequestsInFlight) {
+    return std::async(std::launch::async, [filenames, maxNumRequestsInFlight]() {
+        std::vector<ResourceBufferPtr> buffers;
+        loadFilesBatch(filenames, buffers, maxNumRequestsInFlight);
+        return buffers;
+    });
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_FILELOADERBATCH_HPP
+#define SGL_FILELOADERBATCH_HPP
+
+#include <string>
+#include <vector>
+#include <future>
+
+#include "ResourceBuffer.hpp"
+
+namespace sgl {
+
+/**
+ * Loads many (usually small) files at once, e.g., the time steps of a time-series data set.
+ * On Linux, the files are opened and read through io_uring with a deep queue of requests in flight. If io_uring is not
+ * available (e.g., old kernels or restricted containers) or on other platforms, the files are loaded by a pool of
+ * threads instead. Files inside of archives are supported if sgl was built with libarchive support.
+ * @param filenames The files to load.
+ * @param buffers The loaded files in the order of 'filenames'. For files that could not be loaded, the buffer has the
+ * flag @see ResourceBuffer::getHasLoadingFailed set. If 'buffers' already contains one empty buffer per file (e.g.,
+ * buffers already handed out to the user), these are filled instead of creating new ones.
+ * @param maxNumRequestsInFlight The maximum number of files opened or read concurrently.
+ * @return Whether all files could be loaded successfully.
+ */
+DLL_OBJECT bool loadFilesBatch(
+        const std::vector<std::string>& filenames, std::vector<ResourceBufferPtr>& buffers,
+        size_t maxNumRequestsInFlight = 64);
+
+/**
+ * Like @see loadFilesBatch, but returns immediately. The future becomes ready once all files have been processed.
+ */
+DLL_OBJECT std::future<std::vector<ResourceBufferPtr>> loadFilesBatchAsync(
+        const std::vector<std::string>& filenames, size_t maxNumRequestsInFlight = 64);
+
+/// Returns whether io_uring can be used by @see loadFilesBatch on this system.
+DLL_OBJECT bool getIsIoUringAvailable();
+
+}
+
+#endif //SGL_FILELOADERBATCH_HPP
@@ -33,6 +33,9 @@
 #include <map>
 #include <memory>
 
+#include "Logfile.hpp"
+#include "RetentionCache.hpp"
+
 namespace sgl {
 
 template <class AssetType, class AssetInfo>
@@ -43,9 +46,37 @@ public:
     typedef std::weak_ptr<AssetType> WeakAssetPtr;
     AssetPtr getAsset(AssetInfo &assetInfo);
 
+    /**
+     * Optionally keeps the most recently used assets strongly referenced, so that they are not reloaded when the last
+     * user drops them, e.g., when switching between data sets back and forth.
+     * @param maxNumAssets The maximum number of retained assets (0 = no limit).
+     * @param maxNumBytes The maximum accumulated size of the retained assets (0 = no limit). Only has an effect if the
+     * manager overrides @see getAssetSizeInBytes. A policy limiting only the size is rejected otherwise, as it would
+     * retain all assets forever.
+     * If both limits are 0, no assets are retained (default).
+     */
+    void setRetentionPolicy(size_t maxNumAssets, size_t maxNumBytes) {
+        if (maxNumAssets == 0 && maxNumBytes != 0 && !getHasAssetSizes()) {
+            sgl::Logfile::get()->writeError(
+                    "Error in FileManager::setRetentionPolicy: The manager does not provide asset sizes, so the "
+                    "retention policy needs to limit the number of assets.", false);
+            return;
+        }
+        retentionCache.setRetentionPolicy(maxNumAssets, maxNumBytes);
+    }
+    /// Drops all retained assets.
+    void clearRetainedAssets() { retentionCache.clear(); }
+    /// Returns the hit, miss and eviction counters of @see getAsset.
+    [[nodiscard]] const RetentionCacheStatistics& getCacheStatistics() const { return retentionCache.getStatistics(); }
+
 protected:
     virtual AssetPtr loadAsset(AssetInfo &assetInfo)=0;
+    /// Used for the byte budget of the retention policy.
+    virtual size_t getAssetSizeInBytes(const AssetPtr& asset) { return 0; }
+    /// Needs to return true if @see getAssetSizeInBytes is overridden.
+    [[nodiscard]] virtual bool getHasAssetSizes() const { return false; }
     std::map<AssetInfo, WeakAssetPtr> assetMap;
+    RetentionCache<AssetInfo, AssetType> retentionCache;
 };
 
 template <class AssetType, class AssetInfo>
@@ -54,12 +85,21 @@ std::shared_ptr<AssetType> FileManager<AssetType, AssetInfo>::getAsset(AssetInfo
 
     //! Do we need to (re-)load the asset?
     if (it == assetMap.end() || it->second.expired()) {
+        retentionCache.recordMiss();
         std::shared_ptr<AssetType> asset = loadAsset(assetInfo);
         assetMap[assetInfo] = std::weak_ptr<AssetType>(asset);
+        if (retentionCache.getIsEnabled() && asset) {
+            retentionCache.retain(assetInfo, asset, getAssetSizeInBytes(asset));
+        }
         return asset;
     }
 
-    return it->second.lock();
+    retentionCache.recordHit();
+    std::shared_ptr<AssetType> asset = it->second.lock();
+    if (retentionCache.getIsEnabled()) {
+        retentionCache.retain(assetInfo, asset, getAssetSizeInBytes(asset));
+    }
+    return asset;
 }
 
 }
@@ -0,0 +1,403 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <algorithm>
+#include <numeric>
+#include <cstring>
+#include <climits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#endif
+
+#include "Logfile.hpp"
+#include "FileRangeReader.hpp"
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace sgl {
+
+struct FileRangeReaderImplData {
+#ifdef _WIN32
+    HANDLE fileHandle = INVALID_HANDLE_VALUE;
+#else
+    int fileDesc = -1;
+#endif
+};
+
+FileRangeReader::FileRangeReader() = default;
+
+FileRangeReader::FileRangeReader(const std::string& filename) {
+    open(filename);
+}
+
+FileRangeReader::~FileRangeReader() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool FileRangeReader::open(const std::string& _filename) {
+    close();
+    filename = _filename;
+    HANDLE fileHandle = ::CreateFileA(
+            filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::open: File \"" + filename + "\" could not be opened.");
+        return false;
+    }
+    LARGE_INTEGER fileSizeWin;
+    if (!::GetFileSizeEx(fileHandle, &fileSizeWin)) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::open: The size of file \"" + filename + "\" could not be retrieved.");
+        ::CloseHandle(fileHandle);
+        return false;
+    }
+    fileSize = uint64_t(fileSizeWin.QuadPart);
+    data = new FileRangeReaderImplData;
+    data->fileHandle = fileHandle;
+    return true;
+}
+
+void FileRangeReader::close() {
+    if (data) {
+        ::CloseHandle(data->fileHandle);
+        delete data;
+        data = nullptr;
+    }
+    fileSize = 0;
+    std::lock_guard<std::mutex> lock(blockCacheMutex);
+    blockCache.clear();
+}
+
+bool FileRangeReader::readUncached(uint64_t offset, void* destination, size_t numBytes) {
+    auto* destinationBytes = reinterpret_cast<uint8_t*>(destination);
+    while (numBytes > 0) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset = DWORD(offset & 0xFFFFFFFFull);
+        overlapped.OffsetHigh = DWORD(offset >> 32ull);
+        DWORD numBytesToRead = DWORD(std::min(numBytes, size_t(1) << 30));
+        DWORD numBytesRead = 0;
+        if (!::ReadFile(data->fileHandle, destinationBytes, numBytesToRead, &numBytesRead, &overlapped)
+                || numBytesRead == 0) {
+            return false;
+        }
+        destinationBytes += numBytesRead;
+        offset += numBytesRead;
+        numBytes -= numBytesRead;
+    }
+    return true;
+}
+
+bool FileRangeReader::readVectored(
+        const std::vector<FileReadRange>& ranges, size_t rangeBegin, size_t rangeEnd) {
+    for (size_t i = rangeBegin; i < rangeEnd; i++) {
+        const FileReadRange& range = ranges.at(i);
+        if (!readUncached(range.offset, range.destination, range.numBytes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#else
+
+bool FileRangeReader::open(const std::string& _filename) {
+    close();
+    filename = _filename;
+    int fileDesc = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDesc < 0) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::open: File \"" + filename + "\" could not be opened.");
+        return false;
+    }
+    struct stat fileStat{};
+    if (fstat(fileDesc, &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::open: \"" + filename + "\" is not a regular file.");
+        ::close(fileDesc);
+        return false;
+    }
+    fileSize = uint64_t(fileStat.st_size);
+    data = new FileRangeReaderImplData;
+    data->fileDesc = fileDesc;
+    return true;
+}
+
+void FileRangeReader::close() {
+    if (data) {
+        ::close(data->fileDesc);
+        delete data;
+        data = nullptr;
+    }
+    fileSize = 0;
+    std::lock_guard<std::mutex> lock(blockCacheMutex);
+    blockCache.clear();
+}
+
+bool FileRangeReader::readUncached(uint64_t offset, void* destination, size_t numBytes) {
+    auto* destinationBytes = reinterpret_cast<uint8_t*>(destination);
+    while (numBytes > 0) {
+        ssize_t numBytesRead = ::pread(data->fileDesc, destinationBytes, numBytes, off_t(offset));
+        if (numBytesRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (numBytesRead <= 0) {
+            return false;
+        }
+        destinationBytes += numBytesRead;
+        offset += uint64_t(numBytesRead);
+        numBytes -= size_t(numBytesRead);
+    }
+    return true;
+}
+
+bool FileRangeReader::readVectored(
+        const std::vector<FileReadRange>& ranges, size_t rangeBegin, size_t rangeEnd) {
+    std::vector<iovec> ioVectors;
+    ioVectors.reserve(std::min(rangeEnd - rangeBegin, size_t(IOV_MAX)));
+    size_t chunkBegin = rangeBegin;
+    while (chunkBegin < rangeEnd) {
+        size_t chunkEnd = std::min(rangeEnd, chunkBegin + size_t(IOV_MAX));
+        uint64_t chunkOffset = ranges.at(chunkBegin).offset;
+        size_t chunkSize = 0;
+        ioVectors.clear();
+        for (size_t i = chunkBegin; i < chunkEnd; i++) {
+            const FileReadRange& range = ranges.at(i);
+            ioVectors.push_back(iovec{ range.destination, range.numBytes });
+            chunkSize += range.numBytes;
+        }
+
+        ssize_t numBytesRead;
+        do {
+            numBytesRead = ::preadv(data->fileDesc, ioVectors.data(), int(ioVectors.size()), off_t(chunkOffset));
+        } while (numBytesRead < 0 && errno == EINTR);
+        if (numBytesRead < 0) {
+            return false;
+        }
+
+        if (size_t(numBytesRead) < chunkSize) {
+            // Short read; read the remainder of the affected ranges one by one.
+            for (size_t i = chunkBegin; i < chunkEnd; i++) {
+                const FileReadRange& range = ranges.at(i);
+                uint64_t rangeStartInChunk = range.offset - chunkOffset;
+                size_t numBytesDone = size_t(std::min(
+                        uint64_t(range.numBytes),
+                        uint64_t(numBytesRead) - std::min(uint64_t(numBytesRead), rangeStartInChunk)));
+                if (numBytesDone < range.numBytes && !readUncached(
+                        range.offset + numBytesDone, reinterpret_cast<uint8_t*>(range.destination) + numBytesDone,
+                        range.numBytes - numBytesDone)) {
+                    return false;
+                }
+            }
+        }
+        chunkBegin = chunkEnd;
+    }
+    return true;
+}
+
+#endif
+
+bool FileRangeReader::getIsOpen() const {
+    return data != nullptr;
+}
+
+bool FileRangeReader::read(uint64_t offset, void* destination, size_t numBytes) {
+    if (!data) {
+        sgl::Logfile::get()->writeError("Error in FileRangeReader::read: No file is opened.");
+        return false;
+    }
+    if (offset > fileSize || numBytes > fileSize - offset) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::read: The range exceeds the end of the file \"" + filename + "\".");
+        return false;
+    }
+    if (numBytes == 0) {
+        return true;
+    }
+
+    bool success;
+    size_t cachedBlockSize = getCachedBlockSize();
+    if (cachedBlockSize != 0 && numBytes < cachedBlockSize) {
+        success = readCached(offset, destination, numBytes);
+    } else {
+        success = readUncached(offset, destination, numBytes);
+    }
+    if (!success) {
+        sgl::Logfile::get()->writeError(
+                "Error in FileRangeReader::read: File \"" + filename + "\" could not be read.");
+    }
+    return success;
+}
+
+bool FileRangeReader::readAlloc(uint64_t offset, size_t numBytes, uint8_t*& buffer) {
+    buffer = new uint8_t[numBytes];
+    if (!read(offset, buffer, numBytes)) {
+        delete[] buffer;
+        buffer = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool FileRangeReader::readRanges(const std::vector<FileReadRange>& ranges) {
+    if (!data) {
+        sgl::Logfile::get()->writeError("Error in FileRangeReader::readRanges: No file is opened.");
+        return false;
+    }
+
+    // Small ranges are served by the block cache (if enabled), the rest is sorted and merged into vectored reads.
+    size_t cachedBlockSize = getCachedBlockSize();
+    std::vector<FileReadRange> sortedRanges;
+    sortedRanges.reserve(ranges.size());
+    for (const FileReadRange& range : ranges) {
+        if (range.offset > fileSize || range.numBytes > fileSize - range.offset) {
+            sgl::Logfile::get()->writeError(
+                    "Error in FileRangeReader::readRanges: A range exceeds the end of the file \"" + filename + "\".");
+            return false;
+        }
+        if (range.numBytes == 0) {
+            continue;
+        }
+        if (cachedBlockSize != 0 && range.numBytes < cachedBlockSize) {
+            if (!readCached(range.offset, range.destination, range.numBytes)) {
+                sgl::Logfile::get()->writeError(
+                        "Error in FileRangeReader::readRanges: File \"" + filename + "\" could not be read.");
+                return false;
+            }
+        } else {
+            sortedRanges.push_back(range);
+        }
+    }
+    std::sort(sortedRanges.begin(), sortedRanges.end(), [](const FileReadRange& a, const FileReadRange& b) {
+        return a.offset < b.offset;
+    });
+
+    size_t groupBegin = 0;
+    while (groupBegin < sortedRanges.size()) {
+        size_t groupEnd = groupBegin + 1;
+        uint64_t groupEndOffset = sortedRanges.at(groupBegin).offset + sortedRanges.at(groupBegin).numBytes;
+        while (groupEnd < sortedRanges.size() && sortedRanges.at(groupEnd).offset == groupEndOffset) {
+            groupEndOffset += sortedRanges.at(groupEnd).numBytes;
+            groupEnd++;
+        }
+        if (!readVectored(sortedRanges, groupBegin, groupEnd)) {
+            sgl::Logfile::get()->writeError(
+                    "Error in FileRangeReader::readRanges: File \"" + filename + "\" could not be read.");
+            return false;
+        }
+        groupBegin = groupEnd;
+    }
+
+    return true;
+}
+
+bool FileRangeReader::readCached(uint64_t offset, void* destination, size_t numBytes) {
+    auto* destinationBytes = reinterpret_cast<uint8_t*>(destination);
+    size_t currentBlockSize;
+    {
+        std::lock_guard<std::mutex> lock(blockCacheMutex);
+        currentBlockSize = blockCache.getIsEnabled() ? blockSize : 0;
+    }
+    if (currentBlockSize == 0) {
+        // The block cache was disabled after the caller queried the block size.
+        return readUncached(offset, destination, numBytes);
+    }
+
+    // The mutex is only held for accessing the cache, so that concurrent readers are not serialized behind the I/O.
+    // If the block size changes in the meantime, the blocks read with the old size are not inserted.
+    uint64_t firstBlockIdx = offset / currentBlockSize;
+    uint64_t lastBlockIdx = (offset + numBytes - 1) / currentBlockSize;
+    for (uint64_t blockIdx = firstBlockIdx; blockIdx <= lastBlockIdx; blockIdx++) {
+        uint64_t blockOffset = blockIdx * currentBlockSize;
+        std::shared_ptr<CachedBlock> block;
+        {
+            std::lock_guard<std::mutex> lock(blockCacheMutex);
+            if (blockSize == currentBlockSize) {
+                block = blockCache.get(blockIdx);
+                if (block) {
+                    blockCache.recordHit();
+                } else {
+                    blockCache.recordMiss();
+                }
+            }
+        }
+        if (!block) {
+            block = std::make_shared<CachedBlock>();
+            block->blockData.resize(size_t(std::min(uint64_t(currentBlockSize), fileSize - blockOffset)));
+            if (!readUncached(blockOffset, block->blockData.data(), block->blockData.size())) {
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(blockCacheMutex);
+            if (blockSize == currentBlockSize) {
+                blockCache.retain(blockIdx, block, block->blockData.size());
+            }
+        }
+
+        uint64_t copyStart = std::max(offset, blockOffset);
+        uint64_t copyEnd = std::min(offset + numBytes, blockOffset + block->blockData.size());
+        memcpy(
+                destinationBytes + (copyStart - offset), block->blockData.data() + (copyStart - blockOffset),
+                size_t(copyEnd - copyStart));
+    }
+    return true;
+}
+
+size_t FileRangeReader::getCachedBlockSize() {
+    std::lock_guard<std::mutex> lock(blockCacheMutex);
+    return blockCache.getIsEnabled() ? blockSize : 0;
+}
+
+void FileRangeReader::setBlockCache(size_t _blockSize, size_t maxNumBytes) {
+    std::lock_guard<std::mutex> lock(blockCacheMutex);
+    if (_blockSize != blockSize) {
+        blockCache.clear();
+    }
+    blockSize = _blockSize;
+    blockCache.setRetentionPolicy(0, blockSize == 0 ? 0 : maxNumBytes);
+}
+
+RetentionCacheStatistics FileRangeReader::getBlockCacheStatistics() {
+    std::lock_guard<std::mutex> lock(blockCacheMutex);
+    return blockCache.getStatistics();
+}
+
+}
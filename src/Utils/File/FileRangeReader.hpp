@@ -0,0 +1,124 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_FILERANGEREADER_HPP
+#define SGL_FILERANGEREADER_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include "RetentionCache.hpp"
+
+namespace sgl {
+
+/// A range of a file that should be read to 'destination' (@see FileRangeReader::readRanges).
+struct FileReadRange {
+    uint64_t offset;
+    size_t numBytes;
+    void* destination;
+};
+
+struct FileRangeReaderImplData;
+
+/**
+ * Reads arbitrary byte ranges of a file while keeping the file handle open, e.g., for header-then-payload formats or
+ * for bricked or slice-wise access to large binary volumes. In contrast to @see loadFileFromSourceRanged, the file is
+ * neither reopened nor seeked for every access, and reads of multiple ranges are batched using vectored I/O (preadv).
+ * Optionally, a small least recently used block cache can be enabled for many small reads of neighboring data.
+ * Reading is thread-safe, as positional reads are used. Files inside of archives are not supported.
+ *
+ * Example usage:
+ * FileRangeReader reader("volume.raw");
+ * Header header;
+ * reader.read(0, &header, sizeof(Header));
+ * reader.read(header.sliceOffsets[z], sliceData, header.sliceSize);
+ */
+class DLL_OBJECT FileRangeReader {
+public:
+    FileRangeReader();
+    explicit FileRangeReader(const std::string& filename);
+    ~FileRangeReader();
+    FileRangeReader(const FileRangeReader&) = delete;
+    FileRangeReader& operator=(const FileRangeReader&) = delete;
+
+    /// Opens the file. A previously opened file is closed.
+    bool open(const std::string& filename);
+    void close();
+    [[nodiscard]] bool getIsOpen() const;
+    [[nodiscard]] inline const std::string& getFilename() const { return filename; }
+    [[nodiscard]] inline uint64_t getFileSize() const { return fileSize; }
+
+    /// Reads 'numBytes' bytes starting at 'offset'. Fails if the range exceeds the end of the file.
+    bool read(uint64_t offset, void* destination, size_t numBytes);
+    /**
+     * Like @see read, but the buffer is allocated by the function.
+     * IMPORTANT: The user must use "delete[]" to free the memory of "buffer" if true is returned.
+     */
+    bool readAlloc(uint64_t offset, size_t numBytes, uint8_t*& buffer);
+    /**
+     * Reads multiple ranges. Ranges that are adjacent in the file are merged into a single vectored read.
+     * @return Whether all ranges could be read.
+     */
+    bool readRanges(const std::vector<FileReadRange>& ranges);
+
+    /**
+     * Enables a block cache for reads smaller than 'blockSize'. Larger reads bypass the cache.
+     * @param blockSize The size of the cached blocks in bytes (e.g., 64KiB).
+     * @param maxNumBytes The maximum accumulated size of all cached blocks. 0 disables the cache (default).
+     */
+    void setBlockCache(size_t blockSize, size_t maxNumBytes);
+    /// Returns the hit, miss and eviction counters of the block cache.
+    [[nodiscard]] RetentionCacheStatistics getBlockCacheStatistics();
+
+private:
+    /// Reads directly from the file without going through the block cache.
+    bool readUncached(uint64_t offset, void* destination, size_t numBytes);
+    /// Reads a contiguous range of the file into multiple destination buffers.
+    bool readVectored(const std::vector<FileReadRange>& ranges, size_t rangeBegin, size_t rangeEnd);
+    bool readCached(uint64_t offset, void* destination, size_t numBytes);
+    /// Returns the block size if the block cache is enabled and 0 otherwise.
+    size_t getCachedBlockSize();
+
+    std::string filename;
+    uint64_t fileSize = 0;
+    FileRangeReaderImplData* data = nullptr;
+
+    // Block cache.
+    struct CachedBlock {
+        std::vector<uint8_t> blockData;
+    };
+    size_t blockSize = 0; ///< Protected by blockCacheMutex like blockCache.
+    std::mutex blockCacheMutex;
+    RetentionCache<uint64_t, CachedBlock> blockCache;
+};
+
+}
+
+#endif //SGL_FILERANGEREADER_HPP
@@ -79,6 +79,12 @@ void FileUtils::initialize(const std::string &_appName, int _argc, const char *_
 
     configDir = homeDirectory + "/.config/" + boost::to_lower_copy(appNameNoWhitespace) + "/";
     userDir = homeDirectory + "/";
+    const char* xdgCacheHome = getenv("XDG_CACHE_HOME");
+    if (xdgCacheHome && xdgCacheHome[0] != '\0') {
+        cacheDir = std::string() + xdgCacheHome + "/" + boost::to_lower_copy(appNameNoWhitespace) + "/";
+    } else {
+        cacheDir = homeDirectory + "/.cache/" + boost::to_lower_copy(appNameNoWhitespace) + "/";
+    }
 
     // Use the system-wide path "/var/games" if it is available on the system
     if (exists("/var/games")) {
@@ -96,6 +102,7 @@ void FileUtils::initialize(const std::string &_appName, int _argc, const char *_
 
     configDir = homeDirectory + "/Library/Preferences/" + appNameNoWhitespace + "/";
     userDir = homeDirectory + "/";
+    cacheDir = homeDirectory + "/Library/Caches/" + appNameNoWhitespace + "/";
     sharedDir = "/Library/Preferences/" + appNameNoWhitespace + "/";
 #endif
 #else
@@ -126,6 +133,15 @@ void FileUtils::initialize(const std::string &_appName, int _argc, const char *_
         if (*it == '\\') *it = '/';
     }
     userDir = dir;
+
+    // Cached data should not roam with the user profile, so the local AppData folder is used.
+    char localAppDataPath[MAX_PATH];
+    SHGetSpecialFolderPathA(NULL, localAppDataPath, CSIDL_LOCAL_APPDATA, true);
+    dir = std::string() + localAppDataPath + "/";
+    for (std::string::iterator it = dir.begin(); it != dir.end(); ++it) {
+        if (*it == '\\') *it = '/';
+    }
+    cacheDir = dir + appNameNoWhitespace + "/Cache/";
 #endif
 
     // Create the usage directory on first use/after deletion
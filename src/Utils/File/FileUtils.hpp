@@ -58,6 +58,8 @@ public:
     inline std::string getConfigDirectory() { return configDir; }
     /// Directory of the user, e.g. C:/Users/<Name> (Windows) or /home/<Name> (Linux).
     inline std::string getUserDirectory() { return userDir; }
+    /// Directory for cached data that can be regenerated, e.g. ~/.cache/<app> (Linux) or AppData/Local (Windows).
+    inline std::string getCacheDirectory() { return cacheDir; }
     /// Directoy available for all users on the system, e.g. /var/games (Linux) or just the configDir (Windows).
     inline std::string getSharedDirectory() { return sharedDir; }
 
@@ -75,6 +77,7 @@ public:
     /// "/home/user/Info.txt" -> "/home/user/"
     std::string getPathToFile(const std::string &path);
 
+    /// Synchronous and uncached; for big directories or slow file systems, @see DirectoryScanner.
     std::list<std::string> getFilesInDirectoryList(const std::string &dirPath);
     std::vector<std::string> getFilesInDirectoryVector(const std::string &dirPath);
     std::vector<std::string> getPathAsList(const std::string &dirPath);
@@ -116,6 +119,8 @@ private:
     std::string configDir;
     /// Directory of the user, e.g. C:/Users/<Name> (Windows) or /home/<Name> (Linux).
     std::string userDir;
+    /// Directory for cached data that can be regenerated. It is not created by @see initialize.
+    std::string cacheDir;
     /// Directoy available for all users on the system, e.g. /var/games (Linux) or just the configDir (Windows).
     std::string sharedDir;
 };
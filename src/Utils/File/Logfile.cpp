@@ -29,6 +29,12 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+#include <memory>
 
 #ifdef USE_TBB
 #if __has_include(<tbb/version.h>)
@@ -42,6 +48,7 @@
 
 #include <Utils/Convert.hpp>
 #include <Utils/Dialog.hpp>
+#include <Utils/Parallel/RingBuffer.hpp>
 #ifdef __unix__
 #include <Utils/File/Execute.hpp>
 #endif
@@ -50,6 +57,79 @@
 
 namespace sgl {
 
+struct LogRecord {
+    std::string text;
+    int color;
+};
+
+// Records are truncated to this length in asynchronous mode to bound the memory used by the queue.
+static const size_t MAX_ASYNC_RECORD_LENGTH = 64 * 1024;
+
+struct LogfileAsyncData {
+    explicit LogfileAsyncData(size_t queueCapacity) : queue(queueCapacity) {}
+    /// Written by all threads, read by the writer thread.
+    MpmcRingBuffer<LogRecord> queue;
+    std::thread writerThread;
+    /// Copy of the ID of 'writerThread', which is not modified when the thread is joined.
+    std::thread::id writerThreadId;
+    std::atomic<bool> shallStop{false};
+    std::atomic<bool> isWriterStopped{false};
+    std::atomic<bool> flushRequested{false};
+    std::atomic<uint64_t> numEnqueuedRecords{0};
+    std::atomic<uint64_t> numWrittenRecords{0};
+    /// Dropped records not yet reported in the log file.
+    std::atomic<uint64_t> numDroppedRecordsPending{0};
+    std::mutex conditionMutex;
+    std::condition_variable writerConditionVariable;
+    std::condition_variable flushConditionVariable;
+};
+
+static std::atomic<uint64_t> numDroppedLogRecordsTotal{0};
+
+/// Increments the user counter of the asynchronous data while in scope (@see Logfile::setAsyncMode).
+class LogfileAsyncDataUserScope {
+public:
+    explicit LogfileAsyncDataUserScope(std::atomic<uint32_t>& numUsers) : numUsers(numUsers) { numUsers++; }
+    ~LogfileAsyncDataUserScope() { numUsers--; }
+private:
+    std::atomic<uint32_t>& numUsers;
+};
+
+static void appendFormattedRecord(std::string& output, const std::string& text, int color) {
+    if (color < 0) {
+        output += text;
+        return;
+    }
+    switch (color) {
+    case BLACK:
+        output += "<font color=black>";  break;
+    case WHITE:
+        output += "<font color=white>";  break;
+    case RED:
+        output += "<font color=red>";    break;
+    case GREEN:
+        output += "<font color=green>";  break;
+    case BLUE:
+        output += "<font color=blue>";   break;
+    case PURPLE:
+        output += "<font color=purple>"; break;
+    case ORANGE:
+        output += "<font color=FF9200>"; break;
+    };
+    output += text;
+    output += "</font><br>";
+}
+
+// Writes the queued records if the application is terminated due to an uncaught exception.
+static std::terminate_handler previousTerminateHandler = nullptr;
+static void logfileTerminateHandler() {
+    Logfile::get()->flush();
+    if (previousTerminateHandler) {
+        previousTerminateHandler();
+    }
+    std::abort();
+}
+
 Logfile::Logfile () : closedLogfile(false) {
 }
 
@@ -62,11 +142,177 @@ void Logfile::closeLogfile() {
         std::cerr << "Tried to close logfile multiple times!" << std::endl;
         return;
     }
+    setAsyncMode(false);
     write("<br><br>End of file.</font></body></html>");
     logfile.close();
     closedLogfile = true;
 }
 
+void Logfile::setAsyncMode(bool enabled, size_t queueCapacity) {
+    LogfileAsyncData* data = asyncData.load();
+    if (enabled == (data != nullptr)) {
+        return;
+    }
+    if (enabled) {
+        data = new LogfileAsyncData(queueCapacity);
+        data->writerThread = std::thread(&Logfile::asyncWriterThreadFunction, this, data);
+        data->writerThreadId = data->writerThread.get_id();
+        asyncData.store(data);
+        if (!previousTerminateHandler) {
+            previousTerminateHandler = std::set_terminate(logfileTerminateHandler);
+        }
+        return;
+    }
+
+    // Stop the writer thread. Records pushed from now on stay in the queue and are written below.
+    {
+        std::lock_guard<std::mutex> lock(data->conditionMutex);
+        data->shallStop = true;
+    }
+    data->writerConditionVariable.notify_one();
+    data->writerThread.join();
+    {
+        std::lock_guard<std::mutex> lock(data->conditionMutex);
+        data->isWriterStopped = true;
+    }
+    data->flushConditionVariable.notify_all();
+
+    /*
+     * Switch to the synchronous mode while holding the file mutex, so that records written synchronously by other
+     * threads are not written before the remaining queued records. Threads that loaded the pointer before the switch
+     * may still push records; thus, the queue is only drained and freed once no thread uses it anymore.
+     */
+    std::lock_guard<std::mutex> lock(logfileMutex);
+    asyncData.store(nullptr);
+    while (numAsyncDataUsers.load() != 0) {
+        std::this_thread::yield();
+    }
+    std::string batch;
+    LogRecord record;
+    while (data->queue.tryPop(record)) {
+        appendFormattedRecord(batch, record.text, record.color);
+    }
+    uint64_t numDroppedRecords = data->numDroppedRecordsPending.exchange(0);
+    if (numDroppedRecords > 0) {
+        appendFormattedRecord(
+                batch, std::to_string(numDroppedRecords) + " log messages were dropped (queue full).", ORANGE);
+    }
+    if (!batch.empty()) {
+        logfile.write(batch.c_str(), std::streamsize(batch.size()));
+    }
+    logfile.flush();
+    delete data;
+}
+
+uint64_t Logfile::getNumDroppedRecords() const {
+    return numDroppedLogRecordsTotal.load();
+}
+
+void Logfile::flush() {
+    {
+        // The scope must end before locking the file mutex (see setAsyncMode).
+        LogfileAsyncDataUserScope userScope(numAsyncDataUsers);
+        LogfileAsyncData* data = asyncData.load();
+        if (data && std::this_thread::get_id() != data->writerThreadId) {
+            uint64_t numRecordsToWrite = data->numEnqueuedRecords.load();
+            std::unique_lock<std::mutex> lock(data->conditionMutex);
+            data->flushRequested = true;
+            data->writerConditionVariable.notify_one();
+            // The timeout guards against waiting forever, e.g., if the writer thread is blocked by a crashed thread.
+            data->flushConditionVariable.wait_for(lock, std::chrono::seconds(5), [data, numRecordsToWrite]() {
+                return (data->numWrittenRecords.load() >= numRecordsToWrite && !data->flushRequested)
+                        || data->isWriterStopped.load();
+            });
+            return;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(logfileMutex);
+    logfile.flush();
+}
+
+void Logfile::asyncWriterThreadFunction(LogfileAsyncData* data) {
+    const auto flushInterval = std::chrono::milliseconds(250);
+    auto lastFlushTime = std::chrono::steady_clock::now();
+    std::string batch;
+    LogRecord record;
+    while (true) {
+        bool shallStop = data->shallStop.load();
+        bool flushRequested = data->flushRequested.load();
+
+        uint64_t numRecordsInBatch = 0;
+        while (data->queue.tryPop(record)) {
+            appendFormattedRecord(batch, record.text, record.color);
+            numRecordsInBatch++;
+        }
+        uint64_t numDroppedRecords = data->numDroppedRecordsPending.exchange(0);
+        if (numDroppedRecords > 0) {
+            appendFormattedRecord(
+                    batch, std::to_string(numDroppedRecords) + " log messages were dropped (queue full).", ORANGE);
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        bool shallFlush = flushRequested || shallStop || now - lastFlushTime >= flushInterval;
+        if (!batch.empty() || shallFlush) {
+            std::lock_guard<std::mutex> lock(logfileMutex);
+            if (!batch.empty()) {
+                logfile.write(batch.c_str(), std::streamsize(batch.size()));
+                batch.clear();
+            }
+            if (shallFlush) {
+                logfile.flush();
+                lastFlushTime = now;
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(data->conditionMutex);
+        data->numWrittenRecords += numRecordsInBatch;
+        if (flushRequested) {
+            data->flushRequested = false;
+        }
+        data->flushConditionVariable.notify_all();
+        if (shallStop) {
+            // Records pushed concurrently to stopping are written by setAsyncMode.
+            break;
+        }
+        if (numRecordsInBatch == 0) {
+            data->writerConditionVariable.wait_for(lock, std::chrono::milliseconds(20), [data]() {
+                return data->shallStop.load() || data->flushRequested.load();
+            });
+        }
+    }
+}
+
+void Logfile::writeRecord(const std::string &text, int color) {
+    {
+        // The scope must end before locking the file mutex (see setAsyncMode).
+        LogfileAsyncDataUserScope userScope(numAsyncDataUsers);
+        LogfileAsyncData* data = asyncData.load();
+        if (data) {
+            bool isPushed;
+            if (text.size() > MAX_ASYNC_RECORD_LENGTH) {
+                isPushed = data->queue.tryEmplace(
+                        LogRecord{ text.substr(0, MAX_ASYNC_RECORD_LENGTH) + "...", color });
+            } else {
+                isPushed = data->queue.tryEmplace(LogRecord{ text, color });
+            }
+            if (isPushed) {
+                data->numEnqueuedRecords++;
+            } else {
+                data->numDroppedRecordsPending++;
+                numDroppedLogRecordsTotal++;
+            }
+            return;
+        }
+    }
+
+    std::string formattedText;
+    appendFormattedRecord(formattedText, text, color);
+    std::lock_guard<std::mutex> lock(logfileMutex);
+    logfile.write(formattedText.c_str(), std::streamsize(formattedText.size()));
+    logfile.flush();
+}
+
 void Logfile::createLogfile(const std::string& filename, const std::string& appName) {
     // Open the file and write the header.
     logfile.open(filename);
@@ -127,41 +373,19 @@ void Logfile::createLogfile(const std::string& filename, const std::string& appN
 
 // Writes the header.
 void Logfile::writeTopic (const std::string &text, int size) {
-    write("<table width='100%%' ");
-    write("bgcolor='#E0E0E5'><tr><td><font face='arial' ");
-    write(std::string() + "size='+" + toString(size) + "'>");
-    write(text);
-    write("</font></td></tr></table>\n<br>");
+    write(
+            std::string() + "<table width='100%%' bgcolor='#E0E0E5'><tr><td><font face='arial' size='+"
+            + toString(size) + "'>" + text + "</font></td></tr></table>\n<br>");
 }
 
 // Writes black text to the file.
 void Logfile::write(const std::string &text) {
-    logfile.write(text.c_str(), text.size());
-    logfile.flush();
+    writeRecord(text, -1);
 }
 
 // Writes colored text to the logfile.
 void Logfile::write(const std::string &text, int color) {
-    switch (color) {
-    case BLACK:
-        write("<font color=black>");  break;
-    case WHITE:
-        write("<font color=white>");  break;
-    case RED:
-        write("<font color=red>");    break;
-    case GREEN:
-        write("<font color=green>");  break;
-    case BLUE:
-        write("<font color=blue>");   break;
-    case PURPLE:
-        write("<font color=purple>"); break;
-    case ORANGE:
-        write("<font color=FF9200>"); break;
-    };
-
-    write(text);
-    write("</font>");
-    write("<br>");
+    writeRecord(text, color);
 }
 
 void Logfile::writeWarning(const std::string &text, bool openMessageBox) {
@@ -175,6 +399,8 @@ void Logfile::writeWarning(const std::string &text, bool openMessageBox) {
 void Logfile::writeError(const std::string &text, bool openMessageBox) {
     std::cerr << text << std::endl;
     write(text, RED);
+    // Make sure errors reach the file, e.g., in case the application crashes afterwards.
+    flush();
     if (openMessageBox) {
         dialog::openMessageBoxBlocking("Error occurred", text, dialog::Icon::ERROR);
     }
@@ -182,6 +408,7 @@ void Logfile::writeError(const std::string &text, bool openMessageBox) {
 
 void Logfile::throwError(const std::string &text, bool openMessageBox) {
     write(text, RED);
+    flush();
     if (openMessageBox) {
         dialog::openMessageBoxBlocking("Fatal error occurred", text, dialog::Icon::ERROR);
     }
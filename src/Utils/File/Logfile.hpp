@@ -30,6 +30,9 @@
 #define SRC_UTILS_FILE_LOGFILE_HPP_
 
 #include <fstream>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
 #include <Utils/Singleton.hpp>
 
 namespace sgl {
@@ -39,6 +42,8 @@ enum FontColors {
     BLACK, WHITE, RED, GREEN, BLUE, PURPLE, ORANGE
 };
 
+struct LogfileAsyncData;
+
 class DLL_OBJECT Logfile : public Singleton<Logfile> {
 public:
     Logfile();
@@ -46,6 +51,23 @@ public:
     void createLogfile(const std::string& filename, const std::string& appName);
     void closeLogfile();
 
+    /**
+     * In asynchronous mode, the write functions only push the text into a lock-free queue, and a background thread
+     * formats the records, writes them to the file and flushes it periodically. This avoids blocking worker threads
+     * that log messages. Errors flush the queue synchronously. In both modes, the functions may be called from any
+     * thread.
+     * @param enabled Whether to use the asynchronous mode.
+     * @param queueCapacity The maximum number of queued records (rounded up to a power of two). If the queue is full,
+     * new records are dropped, and a message with the number of dropped records is written later on.
+     * NOTE: Must not be called concurrently with itself (the write functions may be called concurrently, though).
+     */
+    void setAsyncMode(bool enabled, size_t queueCapacity = 8192);
+    [[nodiscard]] inline bool getIsAsyncMode() const { return asyncData.load() != nullptr; }
+    /// Blocks until all queued records were written, and flushes the file.
+    void flush();
+    /// Returns the number of records dropped in asynchronous mode because the queue was full.
+    [[nodiscard]] uint64_t getNumDroppedRecords() const;
+
     /// Write to log file.
     void writeTopic(const std::string &text, int size);
     void write(const std::string &text);
@@ -60,8 +82,16 @@ public:
     void writeInfo(const std::string &text);
 
 private:
+    /// Writes the text (color < 0) or the text formatted with the passed color.
+    void writeRecord(const std::string &text, int color);
+    void asyncWriterThreadFunction(LogfileAsyncData* data);
+
     bool closedLogfile;
     std::ofstream logfile;
+    std::mutex logfileMutex;
+    std::atomic<LogfileAsyncData*> asyncData{nullptr};
+    /// Number of threads currently using 'asyncData'. It is only freed once no thread uses it anymore.
+    std::atomic<uint32_t> numAsyncDataUsers{0};
 };
 
 }
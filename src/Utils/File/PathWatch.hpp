@@ -42,6 +42,7 @@ struct PathWatchImplData;
 
 /**
  * Watches a file or directory inside some parent directory for changes.
+ * For watching many paths or directory trees, @see PathWatchManager should be preferred.
  */
 class DLL_OBJECT PathWatch {
 public:
@@ -0,0 +1,539 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+
+#include "Logfile.hpp"
+#include "PathWatchManager.hpp"
+
+#if defined(__linux__)
+#include <cstring>
+#include <cerrno>
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#endif
+
+namespace sgl {
+
+static std::string normalizeWatchPath(const std::string& path) {
+    std::string normalizedPath = boost::filesystem::absolute(path).lexically_normal().generic_string();
+    // E.g., "/home/user/data/." -> "/home/user/data".
+    if (boost::ends_with(normalizedPath, "/.")) {
+        normalizedPath.resize(normalizedPath.size() - 2);
+    }
+    while (normalizedPath.size() > 1 && normalizedPath.back() == '/') {
+        normalizedPath.pop_back();
+    }
+    return normalizedPath;
+}
+
+/// Returns whether 'path' is 'directory' itself or lies inside of it (directly, if not recursive).
+static bool getIsPathInDirectory(const std::string& path, const std::string& directory, bool recursive) {
+    if (path.size() <= directory.size() + 1 || path.compare(0, directory.size(), directory) != 0
+            || path.at(directory.size()) != '/') {
+        return false;
+    }
+    return recursive || path.find('/', directory.size() + 1) == std::string::npos;
+}
+
+PathWatchManager::PathWatchManager() = default;
+
+PathWatchManager::~PathWatchManager() {
+    if (isRunning) {
+        isRunning = false;
+        wakeBackgroundThread();
+        backgroundThread.join();
+    }
+    if (isPlatformInitialized) {
+        shutdownPlatform();
+    }
+}
+
+uint32_t PathWatchManager::addWatch(const std::string& path, bool recursive, PathWatchCallback callback) {
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    if (!isPlatformInitialized) {
+        if (!initializePlatform()) {
+            return 0;
+        }
+        isPlatformInitialized = true;
+    }
+
+    uint32_t watchId = nextWatchId++;
+    WatchEntry& watchEntry = watches[watchId];
+    watchEntry.path = normalizeWatchPath(path);
+    watchEntry.recursive = recursive;
+    watchEntry.callback = std::move(callback);
+    addPlatformWatch(watchId, watchEntry);
+
+    if (!isRunning) {
+        isRunning = true;
+        backgroundThread = std::thread(&PathWatchManager::backgroundThreadFunction, this);
+    }
+    return watchId;
+}
+
+void PathWatchManager::removeWatch(uint32_t watchId) {
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    auto it = watches.find(watchId);
+    if (it != watches.end()) {
+        removePlatformWatch(watchId, it->second);
+        watches.erase(it);
+    }
+}
+
+void PathWatchManager::setDebounceTime(std::chrono::milliseconds _debounceTime) {
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    debounceTime = _debounceTime;
+}
+
+void PathWatchManager::setPollingInterval(std::chrono::milliseconds _pollingInterval) {
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    pollingInterval = _pollingInterval;
+}
+
+void PathWatchManager::update() {
+    if (!hasReadyChanges.exchange(false)) {
+        return;
+    }
+    std::vector<std::pair<uint32_t, std::vector<std::string>>> readyChangesLocal;
+    {
+        std::lock_guard<std::mutex> lock(readyChangesMutex);
+        readyChangesLocal.swap(readyChanges);
+    }
+
+    for (auto& readyChange : readyChangesLocal) {
+        PathWatchCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(watchesMutex);
+            auto it = watches.find(readyChange.first);
+            if (it == watches.end()) {
+                // The watch was removed in the meantime.
+                continue;
+            }
+            callback = it->second.callback;
+        }
+        // The lock is not held, so that callbacks may add or remove watches.
+        callback(readyChange.second);
+    }
+}
+
+void PathWatchManager::backgroundThreadFunction() {
+    while (isRunning) {
+        std::chrono::milliseconds timeout = flushDebouncedChanges();
+        waitForChanges(timeout);
+    }
+}
+
+void PathWatchManager::recordChange(const std::string& changedPath) {
+    auto now = std::chrono::steady_clock::now();
+    for (auto& watchPair : watches) {
+        recordChange(watchPair.second, changedPath, now);
+    }
+}
+
+void PathWatchManager::recordChange(
+        WatchEntry& watchEntry, const std::string& changedPath, std::chrono::steady_clock::time_point now) {
+    if (changedPath == watchEntry.path || getIsPathInDirectory(changedPath, watchEntry.path, watchEntry.recursive)) {
+        watchEntry.pendingChanges.insert(changedPath);
+        watchEntry.lastChangeTime = now;
+    } else if (getIsPathInDirectory(watchEntry.path, changedPath, true)) {
+        // A parent directory of the watched path was created, deleted or moved.
+        watchEntry.pendingChanges.insert(watchEntry.path);
+        watchEntry.lastChangeTime = now;
+    }
+}
+
+std::chrono::milliseconds PathWatchManager::flushDebouncedChanges() {
+    std::vector<std::pair<uint32_t, std::vector<std::string>>> debouncedChanges;
+    std::chrono::milliseconds timeout = std::chrono::milliseconds(1000);
+    {
+        std::lock_guard<std::mutex> lock(watchesMutex);
+        auto now = std::chrono::steady_clock::now();
+        for (auto& watchPair : watches) {
+            WatchEntry& watchEntry = watchPair.second;
+            if (watchEntry.pendingChanges.empty()) {
+                continue;
+            }
+            auto timeSinceLastChange = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    now - watchEntry.lastChangeTime);
+            if (timeSinceLastChange >= debounceTime) {
+                debouncedChanges.emplace_back(
+                        watchPair.first, std::vector<std::string>(
+                                watchEntry.pendingChanges.begin(), watchEntry.pendingChanges.end()));
+                watchEntry.pendingChanges.clear();
+            } else {
+                timeout = std::min(timeout, debounceTime - timeSinceLastChange);
+            }
+        }
+#if !defined(__linux__)
+        timeout = std::min(timeout, pollingInterval);
+#endif
+    }
+
+    if (!debouncedChanges.empty()) {
+        std::lock_guard<std::mutex> lock(readyChangesMutex);
+        for (auto& debouncedChange : debouncedChanges) {
+            readyChanges.push_back(std::move(debouncedChange));
+        }
+        hasReadyChanges = true;
+    }
+    return std::max(timeout, std::chrono::milliseconds(1));
+}
+
+#if defined(__linux__)
+
+struct InotifyDirectoryWatch {
+    std::string path;
+    std::set<uint32_t> watchIds;
+};
+
+struct PathWatchManagerImplData {
+    int inotifyFileDesc = -1;
+    /// eventfd for waking up the background thread.
+    int wakeFileDesc = -1;
+    std::map<int, InotifyDirectoryWatch> directoryWatches;
+    std::map<std::string, int> pathToWatchDesc;
+    std::vector<uint8_t> eventBuffer;
+};
+
+static const uint32_t INOTIFY_DIRECTORY_MASK =
+        IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO
+        | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+bool PathWatchManager::initializePlatform() {
+    data = new PathWatchManagerImplData;
+    data->inotifyFileDesc = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (data->inotifyFileDesc == -1) {
+        sgl::Logfile::get()->writeError(
+                "Error in PathWatchManager::initializePlatform: inotify_init1 returned errno "
+                + std::to_string(errno) + ": " + strerror(errno));
+        delete data;
+        data = nullptr;
+        return false;
+    }
+    data->wakeFileDesc = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (data->wakeFileDesc == -1) {
+        sgl::Logfile::get()->writeError(
+                "Error in PathWatchManager::initializePlatform: eventfd returned errno "
+                + std::to_string(errno) + ": " + strerror(errno));
+        close(data->inotifyFileDesc);
+        delete data;
+        data = nullptr;
+        return false;
+    }
+    data->eventBuffer.resize((sizeof(struct inotify_event) + NAME_MAX + 1) * 64);
+    return true;
+}
+
+void PathWatchManager::shutdownPlatform() {
+    // Closing the inotify file descriptor also removes all of its watches.
+    close(data->inotifyFileDesc);
+    close(data->wakeFileDesc);
+    delete data;
+    data = nullptr;
+}
+
+static void addInotifyDirectoryWatch(PathWatchManagerImplData* data, const std::string& path, uint32_t watchId) {
+    int watchDesc = inotify_add_watch(data->inotifyFileDesc, path.c_str(), INOTIFY_DIRECTORY_MASK);
+    if (watchDesc == -1) {
+        if (errno != ENOENT && errno != ENOTDIR) {
+            sgl::Logfile::get()->writeError(
+                    "Error in PathWatchManager::addWatch: inotify_add_watch for '" + path + "' returned errno "
+                    + std::to_string(errno) + ": " + strerror(errno));
+        }
+        return;
+    }
+    // inotify returns the same descriptor if the directory is already watched.
+    InotifyDirectoryWatch& directoryWatch = data->directoryWatches[watchDesc];
+    directoryWatch.path = path;
+    directoryWatch.watchIds.insert(watchId);
+    data->pathToWatchDesc[path] = watchDesc;
+}
+
+void PathWatchManager::addPlatformWatch(uint32_t watchId, WatchEntry& watchEntry) {
+    // The nearest existing parent directory is watched to be notified when the path is (re-)created or deleted.
+    boost::system::error_code errorCode;
+    boost::filesystem::path parentPath = boost::filesystem::path(watchEntry.path).parent_path();
+    while (!parentPath.empty() && !boost::filesystem::is_directory(parentPath, errorCode)) {
+        parentPath = parentPath.parent_path();
+    }
+    if (!parentPath.empty()) {
+        addInotifyDirectoryWatch(data, parentPath.generic_string(), watchId);
+    }
+
+    if (!boost::filesystem::is_directory(watchEntry.path, errorCode)) {
+        return;
+    }
+    addInotifyDirectoryWatch(data, watchEntry.path, watchId);
+    if (watchEntry.recursive) {
+        boost::filesystem::recursive_directory_iterator it(watchEntry.path, errorCode), end;
+        for (; !errorCode && it != end; it.increment(errorCode)) {
+            if (boost::filesystem::is_directory(it->symlink_status())) {
+                addInotifyDirectoryWatch(data, normalizeWatchPath(it->path().string()), watchId);
+            }
+        }
+    }
+}
+
+void PathWatchManager::removePlatformWatch(uint32_t watchId, WatchEntry& /*watchEntry*/) {
+    for (auto it = data->directoryWatches.begin(); it != data->directoryWatches.end();) {
+        InotifyDirectoryWatch& directoryWatch = it->second;
+        directoryWatch.watchIds.erase(watchId);
+        if (directoryWatch.watchIds.empty()) {
+            inotify_rm_watch(data->inotifyFileDesc, it->first);
+            data->pathToWatchDesc.erase(directoryWatch.path);
+            it = data->directoryWatches.erase(it);
+        } else {
+            it++;
+        }
+    }
+}
+
+void PathWatchManager::wakeBackgroundThread() {
+    uint64_t value = 1;
+    if (write(data->wakeFileDesc, &value, sizeof(uint64_t)) != sizeof(uint64_t)) {
+        sgl::Logfile::get()->writeError("Error in PathWatchManager::wakeBackgroundThread: write failed.");
+    }
+}
+
+void PathWatchManager::waitForChanges(std::chrono::milliseconds timeout) {
+    struct pollfd pollFileDescs[2] = {
+            { data->inotifyFileDesc, POLLIN, 0 },
+            { data->wakeFileDesc, POLLIN, 0 }
+    };
+    int retVal = poll(pollFileDescs, 2, int(timeout.count()));
+    if (retVal < 0) {
+        if (errno != EINTR) {
+            sgl::Logfile::get()->writeError(
+                    "Error in PathWatchManager::waitForChanges: poll returned errno " + std::to_string(errno) + ": "
+                    + strerror(errno));
+        }
+        return;
+    }
+    if (pollFileDescs[1].revents & POLLIN) {
+        uint64_t value;
+        if (read(data->wakeFileDesc, &value, sizeof(uint64_t)) < 0) {
+            // The counter was already reset; nothing to do.
+        }
+    }
+    if (!(pollFileDescs[0].revents & POLLIN)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    std::set<uint32_t> watchIdsToRefresh;
+    while (true) {
+        ssize_t size = read(data->inotifyFileDesc, data->eventBuffer.data(), data->eventBuffer.size());
+        if (size <= 0) {
+            if (size < 0 && errno != EAGAIN && errno != EINTR) {
+                sgl::Logfile::get()->writeError(
+                        "Error in PathWatchManager::waitForChanges: read returned errno " + std::to_string(errno)
+                        + ": " + strerror(errno));
+            }
+            break;
+        }
+
+        const uint8_t* eventPtr = data->eventBuffer.data();
+        const uint8_t* eventPtrEnd = eventPtr + size;
+        while (eventPtr < eventPtrEnd) {
+            const auto* inotifyEvent = reinterpret_cast<const inotify_event*>(eventPtr);
+            eventPtr += sizeof(inotify_event) + inotifyEvent->len;
+
+            if (inotifyEvent->mask & IN_Q_OVERFLOW) {
+                // Events were lost; report all watched paths as changed.
+                for (auto& watchPair : watches) {
+                    recordChange(watchPair.second.path);
+                    watchIdsToRefresh.insert(watchPair.first);
+                }
+                continue;
+            }
+            auto it = data->directoryWatches.find(inotifyEvent->wd);
+            if (it == data->directoryWatches.end()) {
+                continue;
+            }
+            if (inotifyEvent->mask & IN_IGNORED) {
+                // The directory was deleted or the watch was removed.
+                auto itPath = data->pathToWatchDesc.find(it->second.path);
+                if (itPath != data->pathToWatchDesc.end() && itPath->second == inotifyEvent->wd) {
+                    data->pathToWatchDesc.erase(itPath);
+                }
+                data->directoryWatches.erase(it);
+                continue;
+            }
+
+            std::string changedPath = it->second.path;
+            if (inotifyEvent->len > 0 && inotifyEvent->name[0] != '\0') {
+                changedPath += changedPath == "/" ? inotifyEvent->name : std::string("/") + inotifyEvent->name;
+            }
+            recordChange(changedPath);
+
+            // New directories need to be watched if they are (a parent of) a watched path or in a recursive watch.
+            if ((inotifyEvent->mask & IN_ISDIR) && (inotifyEvent->mask & (IN_CREATE | IN_MOVED_TO))) {
+                for (auto& watchPair : watches) {
+                    const WatchEntry& watchEntry = watchPair.second;
+                    if (changedPath == watchEntry.path || getIsPathInDirectory(watchEntry.path, changedPath, true)
+                            || (watchEntry.recursive && getIsPathInDirectory(changedPath, watchEntry.path, true))) {
+                        watchIdsToRefresh.insert(watchPair.first);
+                    }
+                }
+            }
+        }
+    }
+
+    for (uint32_t watchId : watchIdsToRefresh) {
+        auto it = watches.find(watchId);
+        if (it != watches.end()) {
+            addPlatformWatch(watchId, it->second);
+        }
+    }
+}
+
+#else
+
+struct PathWatchFileState {
+    std::time_t lastWriteTime;
+    uintmax_t fileSize;
+    bool operator!=(const PathWatchFileState& other) const {
+        return lastWriteTime != other.lastWriteTime || fileSize != other.fileSize;
+    }
+};
+typedef std::map<std::string, PathWatchFileState> PathWatchSnapshot;
+
+/**
+ * Fallback for platforms without inotify: The watched paths are scanned periodically and compared with the previous
+ * scan.
+ */
+struct PathWatchManagerImplData {
+    std::map<uint32_t, PathWatchSnapshot> snapshots;
+    std::mutex wakeMutex;
+    std::condition_variable wakeConditionVariable;
+    bool wakeRequested = false;
+};
+
+static void addFileStateToSnapshot(PathWatchSnapshot& snapshot, const boost::filesystem::path& path) {
+    boost::system::error_code errorCode;
+    PathWatchFileState fileState{};
+    fileState.lastWriteTime = boost::filesystem::last_write_time(path, errorCode);
+    if (errorCode) {
+        return;
+    }
+    if (boost::filesystem::is_regular_file(path, errorCode)) {
+        fileState.fileSize = boost::filesystem::file_size(path, errorCode);
+    }
+    snapshot[normalizeWatchPath(path.string())] = fileState;
+}
+
+static PathWatchSnapshot scanWatchedPath(const std::string& path, bool recursive) {
+    PathWatchSnapshot snapshot;
+    boost::system::error_code errorCode;
+    if (!boost::filesystem::exists(path, errorCode)) {
+        return snapshot;
+    }
+    addFileStateToSnapshot(snapshot, path);
+    if (!boost::filesystem::is_directory(path, errorCode)) {
+        return snapshot;
+    }
+    if (recursive) {
+        boost::filesystem::recursive_directory_iterator it(path, errorCode), end;
+        for (; !errorCode && it != end; it.increment(errorCode)) {
+            addFileStateToSnapshot(snapshot, it->path());
+        }
+    } else {
+        boost::filesystem::directory_iterator it(path, errorCode), end;
+        for (; !errorCode && it != end; it.increment(errorCode)) {
+            addFileStateToSnapshot(snapshot, it->path());
+        }
+    }
+    return snapshot;
+}
+
+bool PathWatchManager::initializePlatform() {
+    data = new PathWatchManagerImplData;
+    return true;
+}
+
+void PathWatchManager::shutdownPlatform() {
+    delete data;
+    data = nullptr;
+}
+
+void PathWatchManager::addPlatformWatch(uint32_t watchId, WatchEntry& watchEntry) {
+    data->snapshots[watchId] = scanWatchedPath(watchEntry.path, watchEntry.recursive);
+}
+
+void PathWatchManager::removePlatformWatch(uint32_t watchId, WatchEntry& /*watchEntry*/) {
+    data->snapshots.erase(watchId);
+}
+
+void PathWatchManager::wakeBackgroundThread() {
+    std::lock_guard<std::mutex> lock(data->wakeMutex);
+    data->wakeRequested = true;
+    data->wakeConditionVariable.notify_one();
+}
+
+void PathWatchManager::waitForChanges(std::chrono::milliseconds timeout) {
+    {
+        std::unique_lock<std::mutex> lock(data->wakeMutex);
+        data->wakeConditionVariable.wait_for(lock, timeout, [this]() { return data->wakeRequested; });
+        data->wakeRequested = false;
+    }
+    if (!isRunning) {
+        return;
+    }
+
+    // Only the watch that scanned a path is notified; e.g., the modification time of a directory changes whenever
+    // files are added, which should not be reported to watches of other files in that directory.
+    std::lock_guard<std::mutex> lock(watchesMutex);
+    auto now = std::chrono::steady_clock::now();
+    for (auto& watchPair : watches) {
+        PathWatchSnapshot& oldSnapshot = data->snapshots[watchPair.first];
+        PathWatchSnapshot newSnapshot = scanWatchedPath(watchPair.second.path, watchPair.second.recursive);
+        for (auto& entry : newSnapshot) {
+            auto it = oldSnapshot.find(entry.first);
+            if (it == oldSnapshot.end() || it->second != entry.second) {
+                recordChange(watchPair.second, entry.first, now);
+            }
+        }
+        for (auto& entry : oldSnapshot) {
+            if (newSnapshot.find(entry.first) == newSnapshot.end()) {
+                recordChange(watchPair.second, entry.first, now);
+            }
+        }
+        oldSnapshot = std::move(newSnapshot);
+    }
+}
+
+#endif
+
+}
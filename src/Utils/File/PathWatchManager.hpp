@@ -0,0 +1,133 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_PATHWATCHMANAGER_HPP
+#define SGL_PATHWATCHMANAGER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include <Utils/Singleton.hpp>
+
+namespace sgl {
+
+/// Called with the (absolute, '/'-separated) paths of all files and directories changed since the last call.
+typedef std::function<void(const std::vector<std::string>& changedPaths)> PathWatchCallback;
+
+struct PathWatchManagerImplData;
+
+/**
+ * Watches many files and directories (optionally recursively) for changes, e.g., for hot reloading of shaders or data
+ * files. In contrast to @see PathWatch, all watches share a single inotify instance on Linux, which is read by a
+ * background thread. Bursts of events (e.g., editors writing a file multiple times when saving) are coalesced: The
+ * changes of a watch are only reported once no further change occurred for the debounce time.
+ * The callbacks are invoked on the main thread by @see update (called by AppLogic), which only checks an atomic flag
+ * if nothing changed. On other platforms, the watched paths are periodically scanned by the background thread.
+ *
+ * Example usage:
+ * uint32_t watchId = PathWatchManager::get()->addWatch(
+ *         "Data/Shaders/", true, [](const std::vector<std::string>& changedPaths) {
+ *     for (const std::string& path : changedPaths) {
+ *         reloadShader(path);
+ *     }
+ * });
+ */
+class DLL_OBJECT PathWatchManager : public Singleton<PathWatchManager> {
+public:
+    PathWatchManager();
+    ~PathWatchManager() override;
+
+    /**
+     * Adds a watch. The path does not need to exist yet; it is reported as changed once it is created.
+     * @param path The file or directory to watch.
+     * @param recursive Whether changes in subdirectories (including newly created ones) should be reported.
+     * @param callback The callback invoked on the main thread when the path or its content changed.
+     * @return The ID of the watch (for @see removeWatch), or 0 if the watch could not be added.
+     */
+    uint32_t addWatch(const std::string& path, bool recursive, PathWatchCallback callback);
+    void removeWatch(uint32_t watchId);
+    /// Sets the time after the last change of a watch before the changes are reported (default: 100ms).
+    void setDebounceTime(std::chrono::milliseconds debounceTime);
+    /// Sets the interval of the scans used on platforms without inotify support (default: 500ms).
+    void setPollingInterval(std::chrono::milliseconds pollingInterval);
+
+    /// Invokes the callbacks of watches with pending changes. Called once per frame by AppLogic.
+    void update();
+
+private:
+    struct WatchEntry {
+        std::string path; ///< Absolute and normalized, without trailing separator.
+        bool recursive = false;
+        PathWatchCallback callback;
+        std::set<std::string> pendingChanges;
+        std::chrono::steady_clock::time_point lastChangeTime;
+    };
+
+    // Platform-specific code (see PathWatchManager.cpp).
+    bool initializePlatform();
+    void shutdownPlatform();
+    void addPlatformWatch(uint32_t watchId, WatchEntry& watchEntry);
+    void removePlatformWatch(uint32_t watchId, WatchEntry& watchEntry);
+    /// Waits for changes for at most 'timeout' and records them using @see recordChange.
+    void waitForChanges(std::chrono::milliseconds timeout);
+    void wakeBackgroundThread();
+
+    void backgroundThreadFunction();
+    /// Adds a changed path to all matching watches. Expects that 'watchesMutex' is locked.
+    void recordChange(const std::string& changedPath);
+    void recordChange(
+            WatchEntry& watchEntry, const std::string& changedPath, std::chrono::steady_clock::time_point now);
+    /// Moves the changes of all watches whose debounce time elapsed to 'readyChanges'.
+    std::chrono::milliseconds flushDebouncedChanges();
+
+    PathWatchManagerImplData* data = nullptr;
+    bool isPlatformInitialized = false;
+    std::thread backgroundThread;
+    std::atomic<bool> isRunning{false};
+
+    std::mutex watchesMutex;
+    std::map<uint32_t, WatchEntry> watches;
+    uint32_t nextWatchId = 1;
+    std::chrono::milliseconds debounceTime{100};
+    std::chrono::milliseconds pollingInterval{500};
+
+    std::mutex readyChangesMutex;
+    std::vector<std::pair<uint32_t, std::vector<std::string>>> readyChanges;
+    std::atomic<bool> hasReadyChanges{false};
+};
+
+}
+
+#endif //SGL_PATHWATCHMANAGER_HPP
@@ -36,19 +36,33 @@ namespace sgl {
 
 class DLL_OBJECT ResourceBuffer {
 public:
-    explicit ResourceBuffer(size_t size) : bufferSize(size), loaded(false) { data = new char[bufferSize]; }
+    explicit ResourceBuffer(size_t size) : bufferSize(size), loaded(false), loadingFailed(false) {
+        data = new char[bufferSize];
+    }
+    /// Creates an empty buffer for asynchronously loaded resources (@see setData).
+    ResourceBuffer() : data(nullptr), bufferSize(0), loaded(false), loadingFailed(false) {}
     ~ResourceBuffer() { if (data) { delete[] data; data = nullptr; } }
     inline char *getBuffer() { return data; }
     [[nodiscard]] inline const char *getBuffer() const { return data; }
     [[nodiscard]] inline size_t getBufferSize() const { return bufferSize; }
     inline bool getIsLoaded() { return loaded; }
     inline void setIsLoaded() { loaded = true; }
+    /// Whether asynchronous loading finished unsuccessfully.
+    inline bool getHasLoadingFailed() { return loadingFailed; }
+    inline void setHasLoadingFailed() { loadingFailed = true; }
+    /// Takes ownership of a buffer allocated with "new[]". Must be called before @see setIsLoaded.
+    inline void setData(char* _data, size_t _bufferSize) {
+        if (data) { delete[] data; }
+        data = _data;
+        bufferSize = _bufferSize;
+    }
 
 private:
     char *data;
     size_t bufferSize;
     /// For asynchronously loaded resources
     std::atomic<bool> loaded;
+    std::atomic<bool> loadingFailed;
     /// optional!
     std::shared_ptr<ResourceBuffer> parentZipFileResource;
 };
@@ -29,12 +29,23 @@
 #include "ResourceManager.hpp"
 #include "ResourceBuffer.hpp"
 #include <Utils/File/FileUtils.hpp>
+#include <Utils/File/FileLoader.hpp>
+#include <Utils/File/FileLoaderBatch.hpp>
+#include <Utils/Parallel/ThreadPool.hpp>
 #include <fstream>
+#include <algorithm>
 #include <memory>
 #include <boost/shared_ptr.hpp>
 
 namespace sgl {
 
+ResourceManager::ResourceManager() = default;
+
+ResourceManager::~ResourceManager() {
+    // Join the loader threads before the state they write to is destroyed.
+    loaderPool = {};
+}
+
 ResourceBufferPtr ResourceManager::getFileSync(const char *filename) {
     ResourceBufferPtr resource = getResourcePointer(filename);
 
@@ -49,11 +60,43 @@ ResourceBufferPtr ResourceManager::getFileSync(const char *filename) {
             return {};
         }
         resourceFiles.insert(std::make_pair(filename, resource));
+        retentionCache.retain(filename, resource, resource->getBufferSize());
     }
 
     return resource;
 }
 
+std::vector<ResourceBufferPtr> ResourceManager::getFilesSync(const std::vector<std::string>& filenames) {
+    std::vector<ResourceBufferPtr> resources(filenames.size());
+    std::vector<std::string> filenamesToLoad;
+    std::vector<size_t> resourceIndicesToLoad;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        resources.at(i) = getResourcePointer(filenames.at(i).c_str());
+        if (!resources.at(i)) {
+            filenamesToLoad.push_back(filenames.at(i));
+            resourceIndicesToLoad.push_back(i);
+        }
+    }
+    if (filenamesToLoad.empty()) {
+        return resources;
+    }
+
+    std::vector<ResourceBufferPtr> loadedResources;
+    loadFilesBatch(filenamesToLoad, loadedResources);
+    for (size_t i = 0; i < filenamesToLoad.size(); i++) {
+        ResourceBufferPtr& resource = loadedResources.at(i);
+        if (resource->getHasLoadingFailed()) {
+            continue;
+        }
+        const std::string& filename = filenamesToLoad.at(i);
+        resourceFiles[filename] = resource;
+        retentionCache.retain(filename, resource, resource->getBufferSize());
+        resources.at(resourceIndicesToLoad.at(i)) = resource;
+    }
+
+    return resources;
+}
+
 bool ResourceManager::loadFile(const char *filename, ResourceBufferPtr &resource) {
     //assert(resource.get() && "ResourceManager::loadFile: resource.get()");
     std::streampos size;
@@ -64,18 +107,123 @@ bool ResourceManager::loadFile(const char *filename, ResourceBufferPtr &resource
         file.seekg(0, std::ios::beg);
         file.read(resource->getBuffer(), size);
         file.close();
-        //resource->setIsLoaded();
+        resource->setIsLoaded();
         return true;
     }
     return false;
 }
 
-/*ResourceBufferPtr ResourceManager::getFileAsync(const char *filename) {
-    ResourceBufferPtr resource;
-    ResourceManager::get()->queue.push(make_pair(filename, resource));
-    resourceFiles.insert(make_pair(filename, resource));
-    return ResourceBufferPtr();
-}*/
+ResourceBufferPtr ResourceManager::getFileAsync(const char *filename) {
+    // Deduplicate requests for files that are still being loaded.
+    auto itInFlight = inFlightResources.find(filename);
+    if (itInFlight != inFlightResources.end()) {
+        retentionCache.recordHit();
+        return itInFlight->second;
+    }
+
+    ResourceBufferPtr resource = getResourcePointer(filename);
+    if (!resource) {
+        resource = std::make_shared<ResourceBuffer>();
+        std::string filenameString = filename;
+        getLoaderPool()->push([this, filenameString, resource]() {
+            uint8_t* buffer = nullptr;
+            size_t bufferSize = 0;
+            if (loadFileFromSource(filenameString, buffer, bufferSize, true)) {
+                resource->setData(reinterpret_cast<char*>(buffer), bufferSize);
+            } else {
+                resource->setHasLoadingFailed();
+            }
+            resource->setIsLoaded();
+            std::lock_guard<std::mutex> lock(finishedResourcesMutex);
+            finishedResources.emplace_back(filenameString, resource);
+        });
+    } else {
+        // The file is already loaded; the event is still posted so listeners behave the same in both cases.
+        std::lock_guard<std::mutex> lock(finishedResourcesMutex);
+        finishedResources.emplace_back(filename, resource);
+    }
+    inFlightResources.insert(std::make_pair(filename, resource));
+
+    return resource;
+}
+
+std::vector<ResourceBufferPtr> ResourceManager::getFilesAsync(const std::vector<std::string>& filenames) {
+    std::vector<ResourceBufferPtr> resources(filenames.size());
+    std::vector<std::string> filenamesToLoad;
+    std::vector<ResourceBufferPtr> resourcesToLoad;
+    for (size_t i = 0; i < filenames.size(); i++) {
+        const std::string& filename = filenames.at(i);
+        auto itInFlight = inFlightResources.find(filename);
+        if (itInFlight != inFlightResources.end()) {
+            retentionCache.recordHit();
+            resources.at(i) = itInFlight->second;
+            continue;
+        }
+        ResourceBufferPtr resource = getResourcePointer(filename.c_str());
+        if (resource) {
+            std::lock_guard<std::mutex> lock(finishedResourcesMutex);
+            finishedResources.emplace_back(filename, resource);
+        } else {
+            resource = std::make_shared<ResourceBuffer>();
+            filenamesToLoad.push_back(filename);
+            resourcesToLoad.push_back(resource);
+        }
+        inFlightResources.insert(std::make_pair(filename, resource));
+        resources.at(i) = resource;
+    }
+
+    if (!filenamesToLoad.empty()) {
+        getLoaderPool()->push([this, filenamesToLoad, resourcesToLoad]() mutable {
+            loadFilesBatch(filenamesToLoad, resourcesToLoad);
+            std::lock_guard<std::mutex> lock(finishedResourcesMutex);
+            for (size_t i = 0; i < filenamesToLoad.size(); i++) {
+                finishedResources.emplace_back(filenamesToLoad.at(i), resourcesToLoad.at(i));
+            }
+        });
+    }
+
+    return resources;
+}
+
+void ResourceManager::update() {
+    std::vector<std::pair<std::string, ResourceBufferPtr>> finishedResourcesLocal;
+    {
+        std::lock_guard<std::mutex> lock(finishedResourcesMutex);
+        if (finishedResources.empty()) {
+            return;
+        }
+        finishedResourcesLocal.swap(finishedResources);
+    }
+
+    for (auto& entry : finishedResourcesLocal) {
+        inFlightResources.erase(entry.first);
+        if (!entry.second->getHasLoadingFailed()) {
+            resourceFiles[entry.first] = entry.second;
+            retentionCache.retain(entry.first, entry.second, entry.second->getBufferSize());
+        }
+        EventManager::get()->queueEvent(EventManager::makeEvent<ResourceLoadedEvent>(entry.first, entry.second));
+    }
+}
+
+void ResourceManager::waitForAsyncLoads() {
+    if (loaderPool) {
+        loaderPool->waitIdle();
+    }
+    update();
+}
+
+size_t ResourceManager::getNumPendingAsyncLoads() {
+    return inFlightResources.size();
+}
+
+ThreadPool* ResourceManager::getLoaderPool() {
+    if (!loaderPool) {
+        // Loading is I/O bound, so more threads than cores can still be beneficial on network file systems.
+        size_t numThreads = std::max(size_t(std::thread::hardware_concurrency()), size_t(4));
+        loaderPool = std::make_unique<ThreadPool>(numThreads);
+    }
+    return loaderPool.get();
+}
 
 ResourceBufferPtr ResourceManager::getResourcePointer(const char *filename) {
     auto it = resourceFiles.find(filename);
@@ -88,10 +236,26 @@ ResourceBufferPtr ResourceManager::getResourcePointer(const char *filename) {
             resourceFiles.erase(it);
 
         // Return an empty pointer, as the file still needs to be loaded
+        retentionCache.recordMiss();
         return {};
     }
 
-    return it->second.lock();
+    retentionCache.recordHit();
+    ResourceBufferPtr resource = it->second.lock();
+    retentionCache.retain(filename, resource, resource->getBufferSize());
+    return resource;
+}
+
+void ResourceManager::setRetentionPolicy(size_t maxNumFiles, size_t maxNumBytes) {
+    retentionCache.setRetentionPolicy(maxNumFiles, maxNumBytes);
+}
+
+void ResourceManager::clearRetainedFiles() {
+    retentionCache.clear();
+}
+
+const RetentionCacheStatistics& ResourceManager::getCacheStatistics() const {
+    return retentionCache.getStatistics();
 }
 
 }
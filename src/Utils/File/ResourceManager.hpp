@@ -30,25 +30,80 @@
 #define UTILS_FILE_RESOURCEMANAGER_HPP_
 
 #include <map>
+#include <vector>
 #include <memory>
+#include <mutex>
 
-//#include <System/Multithreading/MultithreadedQueue.hpp>
 #include "ResourceBuffer.hpp"
+#include "RetentionCache.hpp"
 #include <Utils/Singleton.hpp>
+#include <Utils/Events/EventManager.hpp>
 
 namespace sgl {
 
 const uint32_t RESOURCE_LOADED_ASYNC_EVENT = 1041457103U;
 
-class ResourceLoadingProcess;
+/// Event triggered on the main thread when a resource requested via @see ResourceManager::getFileAsync was loaded.
+class DLL_OBJECT ResourceLoadedEvent : public Event {
+public:
+    ResourceLoadedEvent(std::string filename, ResourceBufferPtr resource)
+            : Event(RESOURCE_LOADED_ASYNC_EVENT), filename(std::move(filename)), resource(std::move(resource)) {}
+    [[nodiscard]] inline const std::string& getFilename() const { return filename; }
+    [[nodiscard]] inline const ResourceBufferPtr& getResource() const { return resource; }
+    /// Whether the file could be loaded successfully.
+    [[nodiscard]] inline bool getIsSuccessful() const { return !resource->getHasLoadingFailed(); }
+
+private:
+    std::string filename;
+    ResourceBufferPtr resource;
+};
+
+class ThreadPool;
+
 class DLL_OBJECT ResourceManager : public Singleton<ResourceManager> {
-friend class ResourceLoadingProcess;
 public:
+    ResourceManager();
+    ~ResourceManager() override;
+
     /// Interface
     /// Loads the resource from the hard-drive
     ResourceBufferPtr getFileSync(const char *filename);
-    /// Returns empty buffer; RESOURCE_LOADED_ASYNC_EVENT is triggered when the file was loaded
-    //ResourceBufferPtr getFileAsync(const char *filename);
+    /**
+     * Loads multiple files at once using @see loadFilesBatch for all files not loaded yet. This is considerably faster
+     * than calling @see getFileSync for each file when loading many small files.
+     * @return The buffers in the order of 'filenames'. The pointers of files that could not be loaded are empty.
+     */
+    std::vector<ResourceBufferPtr> getFilesSync(const std::vector<std::string>& filenames);
+    /**
+     * Returns an empty buffer that is filled on a worker thread; RESOURCE_LOADED_ASYNC_EVENT is triggered (with a
+     * @see ResourceLoadedEvent) when the file was loaded. Files in archives are supported if sgl was built with
+     * libarchive. Multiple requests for a file that is still being loaded return the same buffer.
+     */
+    ResourceBufferPtr getFileAsync(const char *filename);
+    /**
+     * Like @see getFileAsync, but all files not loaded yet are loaded together by a single batch loader task
+     * (@see loadFilesBatch). One @see ResourceLoadedEvent is triggered per file.
+     */
+    std::vector<ResourceBufferPtr> getFilesAsync(const std::vector<std::string>& filenames);
+
+    /// Posts the events of finished asynchronous loads. Called once per frame by AppLogic.
+    void update();
+    /// Blocks until all asynchronous loads have finished and posts their events.
+    void waitForAsyncLoads();
+    /// Returns the number of asynchronous loads that were requested but whose events were not yet posted.
+    size_t getNumPendingAsyncLoads();
+
+    /**
+     * Optionally keeps the most recently used files in memory after their last user dropped them.
+     * @param maxNumFiles The maximum number of retained files (0 = no limit).
+     * @param maxNumBytes The maximum accumulated size of the retained files (0 = no limit).
+     * If both limits are 0, no files are retained (default).
+     */
+    void setRetentionPolicy(size_t maxNumFiles, size_t maxNumBytes);
+    /// Drops all retained files.
+    void clearRetainedFiles();
+    /// Returns the hit, miss and eviction counters of @see getFileSync and @see getFileAsync.
+    [[nodiscard]] const RetentionCacheStatistics& getCacheStatistics() const;
 
 private:
     /// Internal interface for querying already loaded files
@@ -58,7 +113,16 @@ private:
     bool loadFile(const char *filename, ResourceBufferPtr &resource);
 
     std::map<std::string, std::weak_ptr<ResourceBuffer>> resourceFiles;
-    //MultithreadedQueue<std::pair<std::string, std::shared_ptr<ResourceBuffer>>> queue;
+    RetentionCache<std::string, ResourceBuffer> retentionCache;
+
+    /// Asynchronous loading.
+    ThreadPool* getLoaderPool();
+    std::unique_ptr<ThreadPool> loaderPool;
+    /// Only accessed by the main thread.
+    std::map<std::string, ResourceBufferPtr> inFlightResources;
+    /// Written by the loader threads, read by the main thread in @see update.
+    std::mutex finishedResourcesMutex;
+    std::vector<std::pair<std::string, ResourceBufferPtr>> finishedResources;
 };
 
 }
@@ -0,0 +1,163 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_RETENTIONCACHE_HPP
+#define SGL_RETENTIONCACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+
+namespace sgl {
+
+struct RetentionCacheStatistics {
+    /// Number of requests that could be served without reloading the asset.
+    uint64_t numHits = 0;
+    /// Number of requests that needed to (re-)load the asset.
+    uint64_t numMisses = 0;
+    /// Number of strong references dropped due to the retention policy.
+    uint64_t numEvictions = 0;
+    /// Current number of retained entries and their accumulated size in bytes.
+    size_t numEntries = 0;
+    size_t numBytes = 0;
+};
+
+/**
+ * Keeps strong references to the most recently used values, so that they are not freed (and later reloaded) as soon
+ * as their last user drops them. Entries are evicted in least recently used order when the number of entries exceeds
+ * 'maxNumEntries' or their accumulated size exceeds 'maxNumBytes'. A limit of 0 means the limit is disabled; if both
+ * limits are disabled, nothing is retained (the default).
+ */
+template <class Key, class Value>
+class RetentionCache {
+public:
+    typedef std::shared_ptr<Value> ValuePtr;
+
+    void setRetentionPolicy(size_t _maxNumEntries, size_t _maxNumBytes) {
+        maxNumEntries = _maxNumEntries;
+        maxNumBytes = _maxNumBytes;
+        evict();
+    }
+    [[nodiscard]] inline bool getIsEnabled() const { return maxNumEntries != 0 || maxNumBytes != 0; }
+
+    /// Inserts the value or marks it as the most recently used one.
+    void retain(const Key& key, const ValuePtr& value, size_t sizeInBytes) {
+        if (!getIsEnabled() || !value) {
+            return;
+        }
+        auto it = entryMap.find(key);
+        if (it != entryMap.end()) {
+            Entry& entry = *it->second;
+            statistics.numBytes -= entry.sizeInBytes;
+            entry.value = value;
+            entry.sizeInBytes = sizeInBytes;
+            statistics.numBytes += sizeInBytes;
+            lruList.splice(lruList.begin(), lruList, it->second);
+        } else {
+            lruList.push_front(Entry{ key, value, sizeInBytes });
+            entryMap.insert(std::make_pair(key, lruList.begin()));
+            statistics.numEntries++;
+            statistics.numBytes += sizeInBytes;
+        }
+        evict();
+    }
+
+    /// Returns the retained value with the passed key (or an empty pointer) and marks it as the most recently used one.
+    ValuePtr get(const Key& key) {
+        auto it = entryMap.find(key);
+        if (it == entryMap.end()) {
+            return {};
+        }
+        lruList.splice(lruList.begin(), lruList, it->second);
+        return it->second->value;
+    }
+
+    /// Drops the strong reference to the value with the passed key (e.g., when the asset was reloaded).
+    void release(const Key& key) {
+        auto it = entryMap.find(key);
+        if (it != entryMap.end()) {
+            statistics.numEntries--;
+            statistics.numBytes -= it->second->sizeInBytes;
+            lruList.erase(it->second);
+            entryMap.erase(it);
+        }
+    }
+
+    inline void recordHit() { statistics.numHits++; }
+    inline void recordMiss() { statistics.numMisses++; }
+
+    /// Drops all strong references. The statistics counters are kept.
+    void clear() {
+        lruList.clear();
+        entryMap.clear();
+        statistics.numEntries = 0;
+        statistics.numBytes = 0;
+    }
+    inline void resetStatistics() {
+        statistics.numHits = 0;
+        statistics.numMisses = 0;
+        statistics.numEvictions = 0;
+    }
+    [[nodiscard]] inline const RetentionCacheStatistics& getStatistics() const { return statistics; }
+
+private:
+    struct Entry {
+        Key key;
+        ValuePtr value;
+        size_t sizeInBytes;
+    };
+
+    void evict() {
+        if (!getIsEnabled()) {
+            statistics.numEvictions += uint64_t(lruList.size());
+            clear();
+            return;
+        }
+        // The most recently used entry is always kept, even if it exceeds the byte budget on its own.
+        while (lruList.size() > 1 && ((maxNumEntries != 0 && lruList.size() > maxNumEntries)
+                || (maxNumBytes != 0 && statistics.numBytes > maxNumBytes))) {
+            Entry& entry = lruList.back();
+            statistics.numEntries--;
+            statistics.numBytes -= entry.sizeInBytes;
+            statistics.numEvictions++;
+            entryMap.erase(entry.key);
+            lruList.pop_back();
+        }
+    }
+
+    size_t maxNumEntries = 0;
+    size_t maxNumBytes = 0;
+    std::list<Entry> lruList;
+    std::map<Key, typename std::list<Entry>::iterator> entryMap;
+    RetentionCacheStatistics statistics;
+};
+
+}
+
+#endif //SGL_RETENTIONCACHE_HPP
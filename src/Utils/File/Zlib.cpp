@@ -26,6 +26,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <zlib.h>
 
 #include "Logfile.hpp"
@@ -49,4 +50,234 @@ DLL_OBJECT bool decompressZlibData(
     return true;
 }
 
+bool compressZlibData(
+        const uint8_t* uncompressedBuffer, size_t uncompressedBufferSize,
+        uint8_t*& compressedBuffer, size_t& compressedBufferSize, int compressionLevel) {
+    auto sourceLen = uLong(uncompressedBufferSize);
+    auto destLen = compressBound(sourceLen);
+    compressedBuffer = new uint8_t[destLen];
+    if (compress2(compressedBuffer, &destLen, uncompressedBuffer, sourceLen, compressionLevel) != Z_OK) {
+        sgl::Logfile::get()->writeError("Error in compressZlibData: compress2 failed.");
+        delete[] compressedBuffer;
+        compressedBuffer = nullptr;
+        compressedBufferSize = 0;
+        return false;
+    }
+    compressedBufferSize = size_t(destLen);
+    return true;
+}
+
+
+struct ZlibStreamImplData {
+    z_stream stream{};
+    std::vector<uint8_t> pendingInput;
+    size_t pendingInputOffset = 0;
+
+    void appendInput(const uint8_t* data, size_t size) {
+        // Drop the already consumed part of the input before it grows without bounds.
+        if (pendingInputOffset > 0 && pendingInputOffset * 2 >= pendingInput.size()) {
+            pendingInput.erase(pendingInput.begin(), pendingInput.begin() + ptrdiff_t(pendingInputOffset));
+            pendingInputOffset = 0;
+        }
+        pendingInput.insert(pendingInput.end(), data, data + size);
+    }
+    void bindInput() {
+        stream.next_in = pendingInput.data() + pendingInputOffset;
+        stream.avail_in = uInt(std::min(pendingInput.size() - pendingInputOffset, size_t(UINT32_MAX)));
+    }
+    void consumeInput() {
+        pendingInputOffset = size_t(stream.next_in - pendingInput.data());
+    }
+};
+
+ZlibStreamCompressor::ZlibStreamCompressor(int compressionLevel) {
+    data = new ZlibStreamImplData;
+    if (deflateInit(&data->stream, compressionLevel) != Z_OK) {
+        sgl::Logfile::get()->writeError("Error in ZlibStreamCompressor::ZlibStreamCompressor: deflateInit failed.");
+        hasError = true;
+    }
+}
+
+ZlibStreamCompressor::~ZlibStreamCompressor() {
+    if (data) {
+        deflateEnd(&data->stream);
+        delete data;
+        data = nullptr;
+    }
+}
+
+ZlibStreamCompressor::ZlibStreamCompressor(ZlibStreamCompressor&& other) noexcept
+        : data(other.data), isFinishing(other.isFinishing), isFinished(other.isFinished), hasError(other.hasError) {
+    // The z_stream object stays at the same address, as only the pointer to the implementation data is moved.
+    other.data = nullptr;
+    other.hasError = true;
+}
+
+ZlibStreamCompressor& ZlibStreamCompressor::operator=(ZlibStreamCompressor&& other) noexcept {
+    if (this != &other) {
+        if (data) {
+            deflateEnd(&data->stream);
+            delete data;
+        }
+        data = other.data;
+        isFinishing = other.isFinishing;
+        isFinished = other.isFinished;
+        hasError = other.hasError;
+        other.data = nullptr;
+        other.hasError = true;
+    }
+    return *this;
+}
+
+bool ZlibStreamCompressor::push(const uint8_t* inputData, size_t size) {
+    if (isFinishing || hasError) {
+        sgl::Logfile::get()->writeError("Error in ZlibStreamCompressor::push: The stream was already finished.");
+        return false;
+    }
+    data->appendInput(inputData, size);
+    return true;
+}
+
+void ZlibStreamCompressor::finish() {
+    isFinishing = true;
+}
+
+size_t ZlibStreamCompressor::pull(uint8_t* outputData, size_t maxSize) {
+    if (isFinished || hasError || maxSize == 0) {
+        return 0;
+    }
+
+    z_stream& stream = data->stream;
+    stream.next_out = outputData;
+    stream.avail_out = uInt(std::min(maxSize, size_t(UINT32_MAX)));
+    while (stream.avail_out > 0) {
+        data->bindInput();
+        if (!isFinishing && stream.avail_in == 0) {
+            break;
+        }
+        int returnCode = deflate(&stream, isFinishing ? Z_FINISH : Z_NO_FLUSH);
+        data->consumeInput();
+        if (returnCode == Z_STREAM_END) {
+            isFinished = true;
+            break;
+        }
+        if (returnCode == Z_BUF_ERROR) {
+            // No progress was possible; more output space or input is needed.
+            break;
+        }
+        if (returnCode != Z_OK) {
+            sgl::Logfile::get()->writeError("Error in ZlibStreamCompressor::pull: deflate failed.");
+            hasError = true;
+            break;
+        }
+    }
+    return size_t(stream.next_out - outputData);
+}
+
+
+ZlibStreamDecompressor::ZlibStreamDecompressor() {
+    data = new ZlibStreamImplData;
+    if (inflateInit(&data->stream) != Z_OK) {
+        sgl::Logfile::get()->writeError(
+                "Error in ZlibStreamDecompressor::ZlibStreamDecompressor: inflateInit failed.");
+        hasError = true;
+    }
+}
+
+ZlibStreamDecompressor::~ZlibStreamDecompressor() {
+    if (data) {
+        inflateEnd(&data->stream);
+        delete data;
+        data = nullptr;
+    }
+}
+
+ZlibStreamDecompressor::ZlibStreamDecompressor(ZlibStreamDecompressor&& other) noexcept
+        : data(other.data), isFinished(other.isFinished), hasError(other.hasError) {
+    other.data = nullptr;
+    other.hasError = true;
+}
+
+ZlibStreamDecompressor& ZlibStreamDecompressor::operator=(ZlibStreamDecompressor&& other) noexcept {
+    if (this != &other) {
+        if (data) {
+            inflateEnd(&data->stream);
+            delete data;
+        }
+        data = other.data;
+        isFinished = other.isFinished;
+        hasError = other.hasError;
+        other.data = nullptr;
+        other.hasError = true;
+    }
+    return *this;
+}
+
+bool ZlibStreamDecompressor::push(const uint8_t* inputData, size_t size) {
+    if (hasError) {
+        return false;
+    }
+    data->appendInput(inputData, size);
+    return true;
+}
+
+size_t ZlibStreamDecompressor::pull(uint8_t* outputData, size_t maxSize) {
+    if (isFinished || hasError || maxSize == 0) {
+        return 0;
+    }
+
+    z_stream& stream = data->stream;
+    stream.next_out = outputData;
+    stream.avail_out = uInt(std::min(maxSize, size_t(UINT32_MAX)));
+    /*
+     * inflate may keep decompressed data buffered internally (e.g., the window of the last block) even if all input
+     * was consumed. Thus, inflate is called until the stream ended or no more progress is possible.
+     */
+    while (stream.avail_out > 0) {
+        data->bindInput();
+        int returnCode = inflate(&stream, Z_NO_FLUSH);
+        data->consumeInput();
+        if (returnCode == Z_STREAM_END) {
+            isFinished = true;
+            break;
+        }
+        if (returnCode == Z_BUF_ERROR) {
+            // No progress was possible; more input is needed.
+            break;
+        }
+        if (returnCode != Z_OK) {
+            sgl::Logfile::get()->writeError("Error in ZlibStreamDecompressor::pull: inflate failed.");
+            hasError = true;
+            break;
+        }
+    }
+    return size_t(stream.next_out - outputData);
+}
+
+
+ZlibCompressorSink::ZlibCompressorSink(WriteStreamSink outputSink, int compressionLevel)
+        : compressor(compressionLevel), outputSink(std::move(outputSink)), outputBuffer(size_t(1) << 16) {
+}
+
+WriteStreamSink ZlibCompressorSink::getSink() {
+    return [this](const uint8_t* data, size_t size) {
+        return compressor.push(data, size) && pullToOutputSink();
+    };
+}
+
+bool ZlibCompressorSink::finish() {
+    compressor.finish();
+    return pullToOutputSink() && compressor.getIsFinished();
+}
+
+bool ZlibCompressorSink::pullToOutputSink() {
+    size_t numBytesCompressed;
+    while ((numBytesCompressed = compressor.pull(outputBuffer.data(), outputBuffer.size())) > 0) {
+        if (!outputSink(outputBuffer.data(), numBytesCompressed)) {
+            return false;
+        }
+    }
+    return !compressor.getHasError();
+}
+
 }
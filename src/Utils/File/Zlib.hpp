@@ -30,6 +30,9 @@
 #define SGL_ZLIB_HPP
 
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <Utils/Events/Stream/SegmentedWriteBuffer.hpp>
 
 namespace sgl {
 
@@ -45,6 +48,125 @@ DLL_OBJECT bool decompressZlibData(
         const uint8_t* compressedBuffer, size_t compressedBufferSize,
         uint8_t* decompressedBuffer, size_t decompressedBufferSize);
 
+/**
+ * Compresses data using zlib.
+ * IMPORTANT: The user must use "delete[]" to free the memory of "compressedBuffer" if true is returned.
+ * @param uncompressedBuffer The buffer storing the uncompressed data.
+ * @param uncompressedBufferSize The size of the uncompressed data in bytes.
+ * @param compressedBuffer A reference to where the newly allocated buffer should be stored.
+ * @param compressedBufferSize The size of the compressed data in bytes.
+ * @param compressionLevel The zlib compression level (0-9, -1 for the default level).
+ * @return Whether compression finished successfully.
+ */
+DLL_OBJECT bool compressZlibData(
+        const uint8_t* uncompressedBuffer, size_t uncompressedBufferSize,
+        uint8_t*& compressedBuffer, size_t& compressedBufferSize, int compressionLevel = -1);
+
+struct ZlibStreamImplData;
+
+/**
+ * Streaming zlib compressor. Input chunks are pushed to the compressor, and compressed output chunks can be pulled
+ * from it. The size of the data does not need to be known in advance.
+ *
+ * Example usage:
+ * ZlibStreamCompressor compressor;
+ * compressor.push(chunk0, chunk0Size);
+ * compressor.push(chunk1, chunk1Size);
+ * compressor.finish();
+ * size_t numBytesRead;
+ * while ((numBytesRead = compressor.pull(outputBuffer, outputBufferSize)) > 0) {
+ *     // Write the data to disk.
+ * }
+ */
+class DLL_OBJECT ZlibStreamCompressor {
+public:
+    explicit ZlibStreamCompressor(int compressionLevel = -1);
+    ~ZlibStreamCompressor();
+    ZlibStreamCompressor(const ZlibStreamCompressor&) = delete;
+    ZlibStreamCompressor& operator=(const ZlibStreamCompressor&) = delete;
+    ZlibStreamCompressor(ZlibStreamCompressor&& other) noexcept;
+    ZlibStreamCompressor& operator=(ZlibStreamCompressor&& other) noexcept;
+
+    /// Passes uncompressed data to the compressor. The data is copied internally.
+    bool push(const uint8_t* data, size_t size);
+    /// Signals that no more data will be pushed.
+    void finish();
+    /**
+     * Pulls compressed data from the compressor.
+     * @return The number of bytes written to 'data'. 0 means all data pushed so far was consumed.
+     */
+    size_t pull(uint8_t* data, size_t maxSize);
+    /// Returns whether @see finish was called and all compressed data was pulled.
+    [[nodiscard]] bool getIsFinished() const { return isFinished; }
+    /// Returns whether an error occurred.
+    [[nodiscard]] bool getHasError() const { return hasError; }
+
+private:
+    ZlibStreamImplData* data = nullptr;
+    bool isFinishing = false;
+    bool isFinished = false;
+    bool hasError = false;
+};
+
+/**
+ * Streaming zlib decompressor. Compressed chunks are pushed to the decompressor, and decompressed output chunks can be
+ * pulled from it. In contrast to @see decompressZlibData, the decompressed size does not need to be known in advance.
+ */
+class DLL_OBJECT ZlibStreamDecompressor {
+public:
+    ZlibStreamDecompressor();
+    ~ZlibStreamDecompressor();
+    ZlibStreamDecompressor(const ZlibStreamDecompressor&) = delete;
+    ZlibStreamDecompressor& operator=(const ZlibStreamDecompressor&) = delete;
+    ZlibStreamDecompressor(ZlibStreamDecompressor&& other) noexcept;
+    ZlibStreamDecompressor& operator=(ZlibStreamDecompressor&& other) noexcept;
+
+    /// Passes compressed data to the decompressor. The data is copied internally.
+    bool push(const uint8_t* data, size_t size);
+    /**
+     * Pulls decompressed data from the decompressor.
+     * @return The number of bytes written to 'data'. 0 means more input needs to be pushed or the stream ended.
+     */
+    size_t pull(uint8_t* data, size_t maxSize);
+    /// Returns whether the end of the compressed stream was reached.
+    [[nodiscard]] bool getIsFinished() const { return isFinished; }
+    /// Returns whether an error occurred.
+    [[nodiscard]] bool getHasError() const { return hasError; }
+
+private:
+    ZlibStreamImplData* data = nullptr;
+    bool isFinished = false;
+    bool hasError = false;
+};
+
+/**
+ * Compresses the data of a write stream in streaming mode before passing it on to another sink.
+ *
+ * Example usage:
+ * ZlibCompressorSink compressorSink(createFileDescriptorSink(fd));
+ * BinaryWriteStream stream;
+ * stream.setSink(compressorSink.getSink());
+ * // Write data to the stream.
+ * stream.flush();
+ * compressorSink.finish();
+ */
+class DLL_OBJECT ZlibCompressorSink {
+public:
+    explicit ZlibCompressorSink(WriteStreamSink outputSink, int compressionLevel = -1);
+    ZlibCompressorSink(const ZlibCompressorSink&) = delete;
+    ZlibCompressorSink& operator=(const ZlibCompressorSink&) = delete;
+    /// The returned sink references this object, which must outlive it.
+    WriteStreamSink getSink();
+    /// Finishes the compressed stream and passes the remaining data to the output sink.
+    bool finish();
+
+private:
+    bool pullToOutputSink();
+    ZlibStreamCompressor compressor;
+    WriteStreamSink outputSink;
+    std::vector<uint8_t> outputBuffer;
+};
+
 }
 
 #endif //SGL_ZLIB_HPP
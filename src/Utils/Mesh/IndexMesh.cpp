@@ -26,21 +26,354 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <chrono>
-#include <iostream>
+#include <cmath>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
 
 #include <Math/Math.hpp>
 #include <Math/Geometry/AABB3.hpp>
 #include <Utils/File/Logfile.hpp>
 #include <Utils/Parallel/Reduction.hpp>
+#include <Utils/Parallel/RadixSort.hpp>
+#include <Utils/Parallel/PrefixSum.hpp>
 
 #include <tracy/Tracy.hpp>
-#include "Utils/SearchStructures/KdTree.hpp"
-#include "Utils/SearchStructures/HashedGrid.hpp"
 #include "IndexMesh.hpp"
 
 namespace sgl {
 
+/// Packs the lower 21 bits of the grid cell coordinates. Cells far apart may alias, which only adds candidates.
+static inline uint64_t getWeldingCellKey(int64_t x, int64_t y, int64_t z) {
+    const uint64_t mask = (uint64_t(1) << 21) - 1;
+    return ((uint64_t(x) & mask) << 42) | ((uint64_t(y) & mask) << 21) | (uint64_t(z) & mask);
+}
+
+static inline int64_t getWeldingCellCoordinate(float value, float minValue, float invCellSize) {
+    float cellCoordinate = std::floor((value - minValue) * invCellSize);
+    // Non-finite values would overflow; their vertices can never be merged anyways.
+    if (!std::isfinite(cellCoordinate)) {
+        return 0;
+    }
+    // Finite values outside of the range of int64_t (e.g., due to a tiny epsilon) would make the conversion undefined.
+    const float maxCellCoordinate = float(int64_t(1) << 62);
+    cellCoordinate = std::clamp(cellCoordinate, -maxCellCoordinate, maxCellCoordinate);
+    return int64_t(cellCoordinate);
+}
+
+/*
+ * Lock-free union-find. Roots are always linked to the root with the smaller index, so the root of every component is
+ * its vertex with the smallest index, independently of the order of the union operations. Relaxed atomics suffice, as
+ * every parent written is a valid ancestor of the node.
+ */
+static uint32_t findWeldingRoot(std::atomic<uint32_t>* parents, uint32_t idx) {
+    while (true) {
+        uint32_t parent = parents[idx].load(std::memory_order_relaxed);
+        if (parent == idx) {
+            return idx;
+        }
+        uint32_t grandParent = parents[parent].load(std::memory_order_relaxed);
+        if (parent != grandParent) {
+            // Path halving.
+            parents[idx].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+        }
+        idx = grandParent;
+    }
+}
+
+static void uniteWeldingComponents(std::atomic<uint32_t>* parents, uint32_t idx0, uint32_t idx1) {
+    while (true) {
+        idx0 = findWeldingRoot(parents, idx0);
+        idx1 = findWeldingRoot(parents, idx1);
+        if (idx0 == idx1) {
+            return;
+        }
+        if (idx0 < idx1) {
+            std::swap(idx0, idx1);
+        }
+        uint32_t expected = idx0;
+        if (parents[idx0].compare_exchange_strong(expected, idx1, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+/// Number of unique vertices of a component above which a local hashed grid is used instead of a linear search.
+static const size_t WELDING_LINEAR_SEARCH_LIMIT = 64;
+
+/**
+ * Performs the serial sweep over the vertices of one connected component of the "closer than EPSILON" graph.
+ * Components are independent of each other, as vertices of different components can never be merged.
+ */
+static void weldComponent(
+        const std::vector<glm::vec3>& vertexPositions, const uint32_t* componentVertices, size_t numComponentVertices,
+        float squaredEpsilon, const glm::vec3& gridMin, float invCellSize, uint32_t* representatives) {
+    // The first vertex is the root of the component, i.e., it has the smallest index.
+    std::vector<uint32_t> uniqueVertices;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> uniqueVertexGrid;
+    for (size_t i = 0; i < numComponentVertices; i++) {
+        uint32_t vertexIdx = componentVertices[i];
+        const glm::vec3& vertexPosition = vertexPositions[vertexIdx];
+        uint32_t closestIdx = vertexIdx;
+        float closestSquaredDistance = std::numeric_limits<float>::max();
+        auto checkCandidate = [&](uint32_t uniqueIdx) {
+            glm::vec3 diff = vertexPositions[uniqueIdx] - vertexPosition;
+            float squaredDistance = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+            // Ties are resolved in favor of the smaller index.
+            if (squaredDistance <= squaredEpsilon && (squaredDistance < closestSquaredDistance
+                    || (squaredDistance == closestSquaredDistance && uniqueIdx < closestIdx))) {
+                closestSquaredDistance = squaredDistance;
+                closestIdx = uniqueIdx;
+            }
+        };
+
+        int64_t cx = getWeldingCellCoordinate(vertexPosition.x, gridMin.x, invCellSize);
+        int64_t cy = getWeldingCellCoordinate(vertexPosition.y, gridMin.y, invCellSize);
+        int64_t cz = getWeldingCellCoordinate(vertexPosition.z, gridMin.z, invCellSize);
+        if (uniqueVertexGrid.empty()) {
+            for (uint32_t uniqueIdx : uniqueVertices) {
+                checkCandidate(uniqueIdx);
+            }
+        } else {
+            for (int64_t oz = -1; oz <= 1; oz++) {
+                for (int64_t oy = -1; oy <= 1; oy++) {
+                    for (int64_t ox = -1; ox <= 1; ox++) {
+                        auto it = uniqueVertexGrid.find(getWeldingCellKey(cx + ox, cy + oy, cz + oz));
+                        if (it != uniqueVertexGrid.end()) {
+                            for (uint32_t uniqueIdx : it->second) {
+                                checkCandidate(uniqueIdx);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        representatives[vertexIdx] = closestIdx;
+        if (closestIdx == vertexIdx) {
+            uniqueVertices.push_back(vertexIdx);
+            if (!uniqueVertexGrid.empty()) {
+                uniqueVertexGrid[getWeldingCellKey(cx, cy, cz)].push_back(vertexIdx);
+            } else if (uniqueVertices.size() > WELDING_LINEAR_SEARCH_LIMIT) {
+                for (uint32_t uniqueIdx : uniqueVertices) {
+                    const glm::vec3& uniquePosition = vertexPositions[uniqueIdx];
+                    uniqueVertexGrid[getWeldingCellKey(
+                            getWeldingCellCoordinate(uniquePosition.x, gridMin.x, invCellSize),
+                            getWeldingCellCoordinate(uniquePosition.y, gridMin.y, invCellSize),
+                            getWeldingCellCoordinate(uniquePosition.z, gridMin.z, invCellSize))].push_back(uniqueIdx);
+                }
+            }
+        }
+    }
+}
+
+void computeVertexWelding(
+        const std::vector<glm::vec3>& vertexPositions, float EPSILON,
+        std::vector<uint32_t>& vertexToSharedIndex, std::vector<uint32_t>& sharedToVertexIndex) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositions.size();
+    vertexToSharedIndex.resize(numVertices);
+    sharedToVertexIndex.clear();
+    if (numVertices == 0) {
+        return;
+    }
+
+    sgl::AABB3 aabb = sgl::reduceVec3ArrayAabb(vertexPositions);
+    const glm::vec3 gridMin = aabb.min;
+    glm::vec3 dimensions = aabb.getDimensions();
+    float maxDimension = std::max(dimensions.x, std::max(dimensions.y, dimensions.z));
+    // For EPSILON = 0, only identical vertices are merged, so any cell size works.
+    const float cellSize = EPSILON > 0.0f ? EPSILON : std::max(maxDimension * 1e-6f, 1e-30f);
+    const float invCellSize = 1.0f / cellSize;
+    const float squaredEpsilon = EPSILON * EPSILON;
+
+    // 1. Sort the vertices by their grid cell keys. The radix sort is stable, so the vertices of a cell stay sorted.
+    std::vector<uint64_t> sortedCellKeys(numVertices);
+    std::vector<uint32_t> sortedVertexIndices(numVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertexPositions, numVertices, gridMin, invCellSize) \
+    shared(sortedCellKeys, sortedVertexIndices) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        const glm::vec3& p = vertexPositions[vertexIdx];
+        sortedCellKeys[vertexIdx] = getWeldingCellKey(
+                getWeldingCellCoordinate(p.x, gridMin.x, invCellSize),
+                getWeldingCellCoordinate(p.y, gridMin.y, invCellSize),
+                getWeldingCellCoordinate(p.z, gridMin.z, invCellSize));
+        sortedVertexIndices[vertexIdx] = uint32_t(vertexIdx);
+    }
+#ifdef USE_TBB
+    });
+#endif
+    radixSortKeyValuePairs(sortedCellKeys, sortedVertexIndices, 63);
+
+    // 2. Compute the connected components of vertices closer than EPSILON using the 27 neighboring cells.
+    std::unique_ptr<std::atomic<uint32_t>[]> parentsArray(new std::atomic<uint32_t>[numVertices]);
+    std::atomic<uint32_t>* parents = parentsArray.get();
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(parents, numVertices) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        parents[vertexIdx].store(uint32_t(vertexIdx), std::memory_order_relaxed);
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertexPositions, numVertices, gridMin, invCellSize, squaredEpsilon) \
+    shared(sortedCellKeys, sortedVertexIndices, parents) schedule(dynamic, 4096) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        const glm::vec3& p = vertexPositions[vertexIdx];
+        int64_t cx = getWeldingCellCoordinate(p.x, gridMin.x, invCellSize);
+        int64_t cy = getWeldingCellCoordinate(p.y, gridMin.y, invCellSize);
+        int64_t cz = getWeldingCellCoordinate(p.z, gridMin.z, invCellSize);
+        for (int64_t oz = -1; oz <= 1; oz++) {
+            for (int64_t oy = -1; oy <= 1; oy++) {
+                for (int64_t ox = -1; ox <= 1; ox++) {
+                    uint64_t cellKey = getWeldingCellKey(cx + ox, cy + oy, cz + oz);
+                    auto it = std::lower_bound(sortedCellKeys.begin(), sortedCellKeys.end(), cellKey);
+                    // Only vertices with a smaller index need to be checked, as the edges are undirected.
+                    for (size_t k = size_t(it - sortedCellKeys.begin());
+                            k < numVertices && sortedCellKeys[k] == cellKey; k++) {
+                        uint32_t otherIdx = sortedVertexIndices[k];
+                        if (otherIdx >= uint32_t(vertexIdx)) {
+                            break;
+                        }
+                        glm::vec3 diff = vertexPositions[otherIdx] - p;
+                        if (diff.x * diff.x + diff.y * diff.y + diff.z * diff.z <= squaredEpsilon) {
+                            uniteWeldingComponents(parents, uint32_t(vertexIdx), otherIdx);
+                        }
+                    }
+                }
+            }
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    // 3. Group the vertices by component (in the order of their indices) and weld each component separately.
+    std::vector<uint32_t> sortedRoots(numVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(parents, numVertices, sortedRoots, sortedVertexIndices) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        sortedRoots[vertexIdx] = findWeldingRoot(parents, uint32_t(vertexIdx));
+        sortedVertexIndices[vertexIdx] = uint32_t(vertexIdx);
+    }
+#ifdef USE_TBB
+    });
+#endif
+    parentsArray = {};
+    sortedCellKeys = {};
+    int numRootBits = 1;
+    while (numRootBits < 32 && (size_t(1) << numRootBits) < numVertices) {
+        numRootBits++;
+    }
+    radixSortKeyValuePairs(sortedRoots, sortedVertexIndices, numRootBits);
+
+    std::vector<uint32_t> representatives(numVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto k = r.begin(); k != r.end(); k++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertexPositions, numVertices, squaredEpsilon, gridMin, invCellSize) \
+    shared(sortedRoots, sortedVertexIndices, representatives) schedule(dynamic, 4096) default(none)
+#endif
+    for (size_t k = 0; k < numVertices; k++) {
+#endif
+        if (k != 0 && sortedRoots[k] == sortedRoots[k - 1]) {
+            continue;
+        }
+        size_t componentEnd = k + 1;
+        while (componentEnd < numVertices && sortedRoots[componentEnd] == sortedRoots[k]) {
+            componentEnd++;
+        }
+        if (componentEnd - k == 1) {
+            representatives[sortedVertexIndices[k]] = sortedVertexIndices[k];
+        } else {
+            weldComponent(
+                    vertexPositions, sortedVertexIndices.data() + k, componentEnd - k, squaredEpsilon,
+                    gridMin, invCellSize, representatives.data());
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    sortedRoots = {};
+    sortedVertexIndices = {};
+
+    // 4. Number the unique vertices in the order of their first occurrence.
+    std::vector<uint32_t> sharedIndices(numVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, representatives, sharedIndices) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        sharedIndices[vertexIdx] = representatives[vertexIdx] == uint32_t(vertexIdx) ? 1 : 0;
+    }
+#ifdef USE_TBB
+    });
+#endif
+    uint32_t numSharedVertices = exclusivePrefixSum(sharedIndices);
+    sharedToVertexIndex.resize(numSharedVertices);
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, representatives, sharedIndices) \
+    shared(vertexToSharedIndex, sharedToVertexIndex) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        uint32_t representative = representatives[vertexIdx];
+        vertexToSharedIndex[vertexIdx] = sharedIndices[representative];
+        if (representative == uint32_t(vertexIdx)) {
+            sharedToVertexIndex[sharedIndices[vertexIdx]] = uint32_t(vertexIdx);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
 void computeSharedIndexRepresentation(
         const std::vector<glm::vec3>& vertexPositions, const std::vector<glm::vec3>& vertexNormals,
         std::vector<uint32_t>& triangleIndices,
@@ -48,32 +381,31 @@ void computeSharedIndexRepresentation(
         float EPSILON) {
     ZoneScoped;
 
-    sgl::AABB3 aabb = sgl::reduceVec3ArrayAabb(vertexPositions);
-    size_t numEntries = std::max(vertexPositions.size() / 4, size_t(1));
-    float cellSize = glm::length(aabb.getExtent()) / std::cbrt(float(numEntries)) * 1.0f / sgl::PI;
-
-    SearchStructure<uint32_t>* searchStructure = new HashedGrid<uint32_t>(numEntries, cellSize);
-    searchStructure->reserveDynamic(vertexPositions.size());
-
-    uint32_t uniqueVertexCounter = 0;
-    std::vector<std::pair<glm::vec3, uint32_t>> searchCache;
-    for (size_t i = 0; i < vertexPositions.size(); i++) {
-        const glm::vec3& vertexPosition = vertexPositions.at(i);
-        const glm::vec3& vertexNormal = vertexNormals.at(i);
-        searchCache.clear();
-        auto closestPointIndex = searchStructure->findDataClosest(vertexPosition, EPSILON, searchCache);
-        if (closestPointIndex) {
-            triangleIndices.push_back(closestPointIndex.value());
-        } else {
-            searchStructure->add(vertexPositions.at(i), uniqueVertexCounter);
-            vertexPositionsShared.push_back(vertexPosition);
-            vertexNormalsShared.push_back(vertexNormal);
-            triangleIndices.push_back(uniqueVertexCounter);
-            uniqueVertexCounter++;
-        }
-    }
+    std::vector<uint32_t> vertexToSharedIndex, sharedToVertexIndex;
+    computeVertexWelding(vertexPositions, EPSILON, vertexToSharedIndex, sharedToVertexIndex);
 
-    delete searchStructure;
+    triangleIndices.insert(triangleIndices.end(), vertexToSharedIndex.begin(), vertexToSharedIndex.end());
+    const size_t numSharedVertices = sharedToVertexIndex.size();
+    const size_t sharedOffset = vertexPositionsShared.size();
+    vertexPositionsShared.resize(sharedOffset + numSharedVertices);
+    vertexNormalsShared.resize(sharedOffset + numSharedVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numSharedVertices), [&](auto const& r) {
+        for (auto sharedIdx = r.begin(); sharedIdx != r.end(); sharedIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertexPositions, vertexNormals, vertexPositionsShared, vertexNormalsShared) \
+    shared(sharedToVertexIndex, numSharedVertices, sharedOffset) default(none)
+#endif
+    for (size_t sharedIdx = 0; sharedIdx < numSharedVertices; sharedIdx++) {
+#endif
+        uint32_t vertexIdx = sharedToVertexIndex[sharedIdx];
+        vertexPositionsShared[sharedOffset + sharedIdx] = vertexPositions[vertexIdx];
+        vertexNormalsShared[sharedOffset + sharedIdx] = vertexNormals[vertexIdx];
+    }
+#ifdef USE_TBB
+    });
+#endif
 }
 
 void computeSharedIndexRepresentation(
@@ -89,27 +421,30 @@ void computeSharedIndexRepresentation(
         std::vector<uint32_t>& triangleIndices,
         std::vector<glm::vec3>& vertexPositionsShared,
         float EPSILON) {
-    SearchStructure<uint32_t>* searchStructure = new HashedGrid<uint32_t>(
-            std::max(vertexPositions.size() / 4, size_t(1)), 1.0f / sgl::PI);
-    searchStructure->reserveDynamic(vertexPositions.size());
-
-    uint32_t uniqueVertexCounter = 0;
-    std::vector<std::pair<glm::vec3, uint32_t>> searchCache;
-    for (size_t i = 0; i < vertexPositions.size(); i++) {
-        const glm::vec3& vertexPosition = vertexPositions.at(i);
-        searchCache.clear();
-        auto closestPointIndex = searchStructure->findDataClosest(vertexPosition, EPSILON, searchCache);
-        if (closestPointIndex) {
-            triangleIndices.push_back(closestPointIndex.value());
-        } else {
-            searchStructure->add(vertexPositions.at(i), uniqueVertexCounter);
-            vertexPositionsShared.push_back(vertexPosition);
-            triangleIndices.push_back(uniqueVertexCounter);
-            uniqueVertexCounter++;
-        }
-    }
+    ZoneScoped;
 
-    delete searchStructure;
+    std::vector<uint32_t> vertexToSharedIndex, sharedToVertexIndex;
+    computeVertexWelding(vertexPositions, EPSILON, vertexToSharedIndex, sharedToVertexIndex);
+
+    triangleIndices.insert(triangleIndices.end(), vertexToSharedIndex.begin(), vertexToSharedIndex.end());
+    const size_t numSharedVertices = sharedToVertexIndex.size();
+    const size_t sharedOffset = vertexPositionsShared.size();
+    vertexPositionsShared.resize(sharedOffset + numSharedVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numSharedVertices), [&](auto const& r) {
+        for (auto sharedIdx = r.begin(); sharedIdx != r.end(); sharedIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertexPositions, vertexPositionsShared, sharedToVertexIndex) \
+    shared(numSharedVertices, sharedOffset) default(none)
+#endif
+    for (size_t sharedIdx = 0; sharedIdx < numSharedVertices; sharedIdx++) {
+#endif
+        vertexPositionsShared[sharedOffset + sharedIdx] = vertexPositions[sharedToVertexIndex[sharedIdx]];
+    }
+#ifdef USE_TBB
+    });
+#endif
 }
 
 void computeSharedIndexRepresentation(
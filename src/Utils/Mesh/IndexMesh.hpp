@@ -30,13 +30,30 @@
 #define SGL_INDEXMESH_HPP
 
 #include <vector>
+#include <cstdint>
 
 #include <glm/vec3.hpp>
 
 namespace sgl {
 
 /**
- * Computes a shared index representation for the passed list of vertices.
+ * Welds all vertices with a distance of at most EPSILON (in parallel). Like in a serial sweep over the vertices, every
+ * vertex is merged into the closest unique vertex within EPSILON found before it (in the order of the input), or
+ * becomes a new unique vertex otherwise. The result is deterministic and independent of the number of threads.
+ * Internally, the positions are quantized to a grid with a cell size of EPSILON, the cell keys are sorted with a
+ * parallel radix sort, and the vertices of neighboring cells are matched. The shared vertices are numbered by a
+ * parallel prefix sum in the order of their first occurrence.
+ * @param vertexPositions The vertex positions.
+ * @param EPSILON The maximum distance of vertices to be merged.
+ * @param vertexToSharedIndex For every vertex, the index of the shared vertex it was merged into (output).
+ * @param sharedToVertexIndex For every shared vertex, the index of the input vertex it originates from (output).
+ */
+DLL_OBJECT void computeVertexWelding(
+        const std::vector<glm::vec3>& vertexPositions, float EPSILON,
+        std::vector<uint32_t>& vertexToSharedIndex, std::vector<uint32_t>& sharedToVertexIndex);
+
+/**
+ * Computes a shared index representation for the passed list of vertices (using @see computeVertexWelding).
  * @param vertexPositions The vertex positions.
  * @param vertexNormals The output vertex normals.
  * @param vertexPositionsShared The shared vertex positions (output).
@@ -54,7 +71,7 @@ DLL_OBJECT void computeSharedIndexRepresentation(
         std::vector<glm::vec3>& vertexPositionsShared, std::vector<glm::vec3>& vertexNormalsShared);
 
 /**
- * Computes a shared index representation for the passed list of vertices.
+ * Computes a shared index representation for the passed list of vertices (using @see computeVertexWelding).
  * @param vertexPositions The vertex positions.
  * @param vertexPositionsShared The shared vertex positions (output).
  * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
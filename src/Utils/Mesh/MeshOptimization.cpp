@@ -0,0 +1,435 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <numeric>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <tracy/Tracy.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include "TriangleNormals.hpp"
+#include "MeshOptimization.hpp"
+
+namespace sgl {
+
+enum TriangleState : uint8_t {
+    TRIANGLE_PENDING, TRIANGLE_EMITTED, TRIANGLE_INVALID
+};
+
+void optimizeVertexCache(
+        std::vector<uint32_t>& triangleIndices, size_t numVertices, uint32_t cacheSize,
+        std::vector<uint32_t>* clusterOffsets) {
+    ZoneScoped;
+
+    const size_t numTriangles = triangleIndices.size() / 3;
+    if (clusterOffsets) {
+        clusterOffsets->clear();
+    }
+    if (numTriangles == 0) {
+        return;
+    }
+
+    // Triangles with invalid vertex indices are neither part of the adjacency nor emitted by the fanning loop.
+    std::vector<uint8_t> triangleStates(numTriangles, TRIANGLE_PENDING);
+    size_t numInvalidTriangles = 0;
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+        for (size_t j = 0; j < 3; j++) {
+            if (triangleIndices[triangleIdx * 3 + j] >= numVertices) {
+                triangleStates[triangleIdx] = TRIANGLE_INVALID;
+            }
+        }
+        if (triangleStates[triangleIdx] == TRIANGLE_INVALID) {
+            numInvalidTriangles++;
+        }
+    }
+
+    VertexTriangleAdjacency adjacency;
+    computeVertexTriangleAdjacency(triangleIndices, numVertices, adjacency);
+    const std::vector<uint32_t>& offsets = adjacency.offsets;
+    const std::vector<uint32_t>& cornerIndices = adjacency.cornerIndices;
+
+    // Number of adjacent triangles that were not yet emitted.
+    std::vector<uint32_t> numLiveTriangles(numVertices);
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+        numLiveTriangles[vertexIdx] = offsets[vertexIdx + 1] - offsets[vertexIdx];
+    }
+    // A vertex is in the FIFO cache if it was inserted at most cacheSize insertions ago.
+    std::vector<uint32_t> cacheTimestamps(numVertices, 0);
+    uint32_t timestamp = cacheSize + 1;
+    std::vector<uint32_t> deadEndStack;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> triangleIndicesNew;
+    triangleIndicesNew.reserve(numTriangles * 3);
+
+    size_t vertexCursor = 0;
+    auto skipDeadEnd = [&]() -> int64_t {
+        while (!deadEndStack.empty()) {
+            uint32_t vertexIdx = deadEndStack.back();
+            deadEndStack.pop_back();
+            if (numLiveTriangles[vertexIdx] > 0) {
+                return int64_t(vertexIdx);
+            }
+        }
+        while (vertexCursor < numVertices) {
+            if (numLiveTriangles[vertexCursor] > 0) {
+                return int64_t(vertexCursor);
+            }
+            vertexCursor++;
+        }
+        return -1;
+    };
+
+    int64_t fanningVertex = skipDeadEnd();
+    bool isClusterStart = true;
+    while (fanningVertex >= 0) {
+        // Emit all remaining triangles adjacent to the fanning vertex.
+        candidates.clear();
+        for (uint32_t i = offsets[fanningVertex]; i < offsets[fanningVertex + 1]; i++) {
+            uint32_t triangleIdx = cornerIndices[i] / 3;
+            if (triangleStates[triangleIdx] != TRIANGLE_PENDING) {
+                continue;
+            }
+            if (isClusterStart && clusterOffsets) {
+                clusterOffsets->push_back(uint32_t(triangleIndicesNew.size() / 3));
+            }
+            isClusterStart = false;
+            for (size_t j = 0; j < 3; j++) {
+                uint32_t vertexIdx = triangleIndices[triangleIdx * 3 + j];
+                triangleIndicesNew.push_back(vertexIdx);
+                deadEndStack.push_back(vertexIdx);
+                candidates.push_back(vertexIdx);
+                numLiveTriangles[vertexIdx]--;
+                if (timestamp - cacheTimestamps[vertexIdx] > cacheSize) {
+                    cacheTimestamps[vertexIdx] = timestamp++;
+                }
+            }
+            triangleStates[triangleIdx] = TRIANGLE_EMITTED;
+        }
+
+        // Select the candidate that will still be in the cache after emitting its remaining triangles, preferring
+        // the one that entered the cache first.
+        int64_t nextVertex = -1;
+        int64_t bestPriority = -1;
+        for (uint32_t vertexIdx : candidates) {
+            if (numLiveTriangles[vertexIdx] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            int64_t age = int64_t(timestamp - cacheTimestamps[vertexIdx]);
+            if (age + 2 * int64_t(numLiveTriangles[vertexIdx]) <= int64_t(cacheSize)) {
+                priority = age;
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                nextVertex = int64_t(vertexIdx);
+            }
+        }
+        if (nextVertex < 0) {
+            nextVertex = skipDeadEnd();
+            isClusterStart = true;
+        }
+        fanningVertex = nextVertex;
+    }
+
+    // Keep the triangles with invalid vertex indices at the end.
+    if (numInvalidTriangles > 0) {
+        if (clusterOffsets) {
+            clusterOffsets->push_back(uint32_t(triangleIndicesNew.size() / 3));
+        }
+        for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+            if (triangleStates[triangleIdx] == TRIANGLE_INVALID) {
+                for (size_t j = 0; j < 3; j++) {
+                    triangleIndicesNew.push_back(triangleIndices[triangleIdx * 3 + j]);
+                }
+            }
+        }
+    }
+    triangleIndicesNew.insert(
+            triangleIndicesNew.end(), triangleIndices.begin() + ptrdiff_t(numTriangles * 3), triangleIndices.end());
+    triangleIndices = std::move(triangleIndicesNew);
+}
+
+/**
+ * Simulates a FIFO vertex cache of a fixed size. Small enough for a linear search.
+ */
+class FifoVertexCache {
+public:
+    explicit FifoVertexCache(uint32_t cacheSize) : entries(cacheSize, INVALID_VERTEX_INDEX) {}
+    void clear() {
+        std::fill(entries.begin(), entries.end(), INVALID_VERTEX_INDEX);
+        position = 0;
+    }
+    /// Returns true if the vertex was not in the cache.
+    bool access(uint32_t vertexIdx) {
+        if (std::find(entries.begin(), entries.end(), vertexIdx) != entries.end()) {
+            return false;
+        }
+        entries[position] = vertexIdx;
+        position = (position + 1) % entries.size();
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> entries;
+    size_t position = 0;
+};
+
+void optimizeOverdraw(
+        std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const std::vector<uint32_t>& clusterOffsets, uint32_t cacheSize, float threshold) {
+    ZoneScoped;
+
+    // The simulated FIFO cache needs at least one entry.
+    cacheSize = std::max(cacheSize, 1u);
+
+    const size_t numTriangles = triangleIndices.size() / 3;
+    const size_t numVertices = vertexPositions.size();
+    const size_t numHardClusters = clusterOffsets.size();
+    if (numTriangles == 0) {
+        return;
+    }
+    auto getHardClusterEnd = [&](size_t clusterIdx) {
+        return clusterIdx + 1 < numHardClusters ? size_t(clusterOffsets[clusterIdx + 1]) : numTriangles;
+    };
+
+    // 1. Split the hard clusters at soft boundaries, i.e., where the cache miss ratio of the current subsequence
+    // (starting with an empty cache) drops below threshold times the cache miss ratio of the whole cluster.
+    std::vector<std::vector<uint32_t>> softClusterOffsets(numHardClusters);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numHardClusters), [&](auto const& r) {
+        FifoVertexCache cache(cacheSize);
+        for (auto clusterIdx = r.begin(); clusterIdx != r.end(); clusterIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel default(none) shared(numHardClusters, clusterOffsets, softClusterOffsets) \
+    shared(triangleIndices, cacheSize, threshold, getHardClusterEnd)
+#endif
+    {
+    FifoVertexCache cache(cacheSize);
+#if _OPENMP >= 201107
+    #pragma omp for schedule(dynamic)
+#endif
+    for (size_t clusterIdx = 0; clusterIdx < numHardClusters; clusterIdx++) {
+#endif
+        size_t clusterStart = clusterOffsets[clusterIdx];
+        size_t clusterEnd = getHardClusterEnd(clusterIdx);
+        std::vector<uint32_t>& subclusterOffsets = softClusterOffsets[clusterIdx];
+        subclusterOffsets.push_back(uint32_t(clusterStart));
+
+        cache.clear();
+        size_t numClusterMisses = 0;
+        for (size_t i = clusterStart * 3; i < clusterEnd * 3; i++) {
+            numClusterMisses += cache.access(triangleIndices[i]) ? 1 : 0;
+        }
+        float clusterMissRatio = float(numClusterMisses) / float(std::max(clusterEnd - clusterStart, size_t(1)));
+
+        cache.clear();
+        size_t subclusterStart = clusterStart;
+        size_t numSubclusterMisses = 0;
+        for (size_t triangleIdx = clusterStart; triangleIdx < clusterEnd; triangleIdx++) {
+            for (size_t j = 0; j < 3; j++) {
+                numSubclusterMisses += cache.access(triangleIndices[triangleIdx * 3 + j]) ? 1 : 0;
+            }
+            size_t numSubclusterTriangles = triangleIdx + 1 - subclusterStart;
+            if (triangleIdx + 1 < clusterEnd
+                    && float(numSubclusterMisses) <= threshold * clusterMissRatio * float(numSubclusterTriangles)) {
+                subclusterStart = triangleIdx + 1;
+                subclusterOffsets.push_back(uint32_t(subclusterStart));
+                numSubclusterMisses = 0;
+                cache.clear();
+            }
+        }
+    }
+#ifdef USE_TBB
+    });
+#else
+    }
+#endif
+
+    std::vector<uint32_t> clusterStarts;
+    for (const std::vector<uint32_t>& subclusterOffsets : softClusterOffsets) {
+        clusterStarts.insert(clusterStarts.end(), subclusterOffsets.begin(), subclusterOffsets.end());
+    }
+    if (clusterStarts.empty() || clusterStarts.front() != 0) {
+        clusterStarts.insert(clusterStarts.begin(), 0);
+    }
+    const size_t numClusters = clusterStarts.size();
+    auto getClusterEnd = [&](size_t clusterIdx) {
+        return clusterIdx + 1 < numClusters ? size_t(clusterStarts[clusterIdx + 1]) : numTriangles;
+    };
+
+    // 2. Compute the area-weighted centroid and normal of every cluster. The normals use the same orientation
+    // convention as computeSmoothTriangleNormals.
+    std::vector<glm::vec3> clusterCentroids(numClusters);
+    std::vector<glm::vec3> clusterNormals(numClusters);
+    std::vector<float> clusterAreas(numClusters);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numClusters), [&](auto const& r) {
+        for (auto clusterIdx = r.begin(); clusterIdx != r.end(); clusterIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) shared(numClusters, clusterStarts, getClusterEnd, triangleIndices) \
+    shared(numVertices, vertexPositions, clusterCentroids, clusterNormals, clusterAreas)
+#endif
+    for (size_t clusterIdx = 0; clusterIdx < numClusters; clusterIdx++) {
+#endif
+        glm::vec3 centroidSum(0.0f), normalSum(0.0f);
+        float areaSum = 0.0f;
+        for (size_t triangleIdx = clusterStarts[clusterIdx]; triangleIdx < getClusterEnd(clusterIdx); triangleIdx++) {
+            const uint32_t* indices = triangleIndices.data() + triangleIdx * 3;
+            if (indices[0] >= numVertices || indices[1] >= numVertices || indices[2] >= numVertices) {
+                continue;
+            }
+            const glm::vec3& p0 = vertexPositions[triangleIndices[triangleIdx * 3]];
+            const glm::vec3& p1 = vertexPositions[triangleIndices[triangleIdx * 3 + 1]];
+            const glm::vec3& p2 = vertexPositions[triangleIndices[triangleIdx * 3 + 2]];
+            glm::vec3 normal = glm::cross(p2 - p0, p1 - p0);
+            float area = 0.5f * glm::length(normal);
+            centroidSum += area * (p0 + p1 + p2) / 3.0f;
+            normalSum += normal;
+            areaSum += area;
+        }
+        clusterCentroids[clusterIdx] = areaSum > 0.0f ? centroidSum / areaSum : centroidSum;
+        float normalLength = glm::length(normalSum);
+        clusterNormals[clusterIdx] = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+        clusterAreas[clusterIdx] = areaSum;
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    glm::vec3 meshCentroidSum(0.0f);
+    float meshArea = 0.0f;
+    for (size_t clusterIdx = 0; clusterIdx < numClusters; clusterIdx++) {
+        meshCentroidSum += clusterAreas[clusterIdx] * clusterCentroids[clusterIdx];
+        meshArea += clusterAreas[clusterIdx];
+    }
+    glm::vec3 meshCentroid = meshArea > 0.0f ? meshCentroidSum / meshArea : meshCentroidSum;
+
+    // 3. Sort the clusters such that clusters on the outside facing away from the centroid come first.
+    std::vector<float> sortKeys(numClusters);
+    for (size_t clusterIdx = 0; clusterIdx < numClusters; clusterIdx++) {
+        sortKeys[clusterIdx] = glm::dot(clusterCentroids[clusterIdx] - meshCentroid, clusterNormals[clusterIdx]);
+    }
+    std::vector<uint32_t> clusterOrder(numClusters);
+    std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+    std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](uint32_t a, uint32_t b) {
+        return sortKeys[a] > sortKeys[b];
+    });
+
+    std::vector<uint32_t> triangleIndicesNew;
+    triangleIndicesNew.reserve(triangleIndices.size());
+    for (uint32_t clusterIdx : clusterOrder) {
+        triangleIndicesNew.insert(
+                triangleIndicesNew.end(),
+                triangleIndices.begin() + ptrdiff_t(clusterStarts[clusterIdx] * 3),
+                triangleIndices.begin() + ptrdiff_t(getClusterEnd(clusterIdx) * 3));
+    }
+    triangleIndicesNew.insert(
+            triangleIndicesNew.end(), triangleIndices.begin() + ptrdiff_t(numTriangles * 3), triangleIndices.end());
+    triangleIndices = std::move(triangleIndicesNew);
+}
+
+size_t optimizeVertexFetch(
+        std::vector<uint32_t>& triangleIndices, size_t numVertices, std::vector<uint32_t>& vertexRemap) {
+    ZoneScoped;
+
+    vertexRemap.clear();
+    vertexRemap.resize(numVertices, INVALID_VERTEX_INDEX);
+    uint32_t numVerticesNew = 0;
+    for (uint32_t& vertexIdx : triangleIndices) {
+        if (vertexIdx >= numVertices) {
+            continue;
+        }
+        uint32_t& vertexIdxNew = vertexRemap[vertexIdx];
+        if (vertexIdxNew == INVALID_VERTEX_INDEX) {
+            vertexIdxNew = numVerticesNew++;
+        }
+        vertexIdx = vertexIdxNew;
+    }
+    return numVerticesNew;
+}
+
+float computeAverageCacheMissRatio(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, uint32_t cacheSize) {
+    const size_t numTriangles = triangleIndices.size() / 3;
+    if (numTriangles == 0) {
+        return 0.0f;
+    }
+    std::vector<uint32_t> cacheTimestamps(numVertices, 0);
+    uint32_t timestamp = cacheSize + 1;
+    size_t numMisses = 0;
+    for (size_t i = 0; i < numTriangles * 3; i++) {
+        uint32_t vertexIdx = triangleIndices[i];
+        if (vertexIdx < numVertices && timestamp - cacheTimestamps[vertexIdx] > cacheSize) {
+            cacheTimestamps[vertexIdx] = timestamp++;
+            numMisses++;
+        }
+    }
+    return float(numMisses) / float(numTriangles);
+}
+
+void optimizeMeshForRendering(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        std::vector<glm::vec3>& vertexNormals, bool optimizeForOverdraw) {
+    ZoneScoped;
+
+    if (!vertexNormals.empty() && vertexNormals.size() != vertexPositions.size()) {
+        sgl::Logfile::get()->writeError(
+                "Error in optimizeMeshForRendering: The number of vertex normals does not match the number of "
+                "vertex positions.", false);
+        return;
+    }
+
+    std::vector<uint32_t> clusterOffsets;
+    optimizeVertexCache(
+            triangleIndices, vertexPositions.size(), 16, optimizeForOverdraw ? &clusterOffsets : nullptr);
+    if (optimizeForOverdraw) {
+        optimizeOverdraw(triangleIndices, vertexPositions, clusterOffsets);
+    }
+    std::vector<uint32_t> vertexRemap;
+    size_t numVerticesNew = optimizeVertexFetch(triangleIndices, vertexPositions.size(), vertexRemap);
+    remapVertexAttribute(vertexPositions, vertexRemap, numVerticesNew);
+    if (!vertexNormals.empty()) {
+        remapVertexAttribute(vertexNormals, vertexRemap, numVerticesNew);
+    }
+}
+
+void optimizeMeshForRendering(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions, bool optimizeForOverdraw) {
+    std::vector<glm::vec3> vertexNormals;
+    optimizeMeshForRendering(triangleIndices, vertexPositions, vertexNormals, optimizeForOverdraw);
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_MESHOPTIMIZATION_HPP
+#define SGL_MESHOPTIMIZATION_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+
+namespace sgl {
+
+/**
+ * Reorders the triangles for the post-transform vertex cache of the GPU using the Tipsify algorithm.
+ * For more details see: P. V. Sander, D. Nehab, J. Barczak, "Fast triangle reordering for vertex locality and reduced
+ * overdraw", ACM Transactions on Graphics, 2007.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle (input and output).
+ * @param numVertices The number of vertices.
+ * @param cacheSize The assumed size of the vertex cache.
+ * @param clusterOffsets If not nullptr, the offsets of the triangles starting a new cluster (i.e., after a dead end of
+ * the algorithm) are stored in this list (output). These clusters can be reordered by @see optimizeOverdraw.
+ */
+DLL_OBJECT void optimizeVertexCache(
+        std::vector<uint32_t>& triangleIndices, size_t numVertices, uint32_t cacheSize = 16,
+        std::vector<uint32_t>* clusterOffsets = nullptr);
+
+/**
+ * Reorders the triangle clusters computed by @see optimizeVertexCache to reduce overdraw. The clusters are split at
+ * points where the cache efficiency is barely affected, and are then sorted such that clusters on the outside of the
+ * mesh facing outwards are rendered first (view-independent).
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle (input and output).
+ * @param vertexPositions The vertex positions.
+ * @param clusterOffsets The triangle offsets of the clusters computed by @see optimizeVertexCache.
+ * @param cacheSize The assumed size of the vertex cache.
+ * @param threshold Clusters are split where the average cache miss ratio is at most threshold times the ratio of the
+ * whole cluster. Values > 1 allow for more clusters, i.e., trade cache efficiency for less overdraw.
+ */
+DLL_OBJECT void optimizeOverdraw(
+        std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const std::vector<uint32_t>& clusterOffsets, uint32_t cacheSize = 16, float threshold = 1.05f);
+
+/**
+ * Computes a vertex remapping for fetch locality, i.e., the vertices are sorted in the order of their first use in the
+ * index buffer. The index buffer is remapped accordingly. Unreferenced vertices are removed.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle (input and output).
+ * @param numVertices The number of vertices.
+ * @param vertexRemap The new index of every vertex, or INVALID_VERTEX_INDEX if it is unreferenced (output).
+ * @return The number of vertices after the remapping.
+ */
+DLL_OBJECT size_t optimizeVertexFetch(
+        std::vector<uint32_t>& triangleIndices, size_t numVertices, std::vector<uint32_t>& vertexRemap);
+const uint32_t INVALID_VERTEX_INDEX = 0xFFFFFFFFu;
+
+/**
+ * Applies a vertex remapping computed by @see optimizeVertexFetch to a per-vertex attribute.
+ */
+template<class T>
+void remapVertexAttribute(
+        std::vector<T>& vertexAttribute, const std::vector<uint32_t>& vertexRemap, size_t numVerticesNew) {
+    std::vector<T> vertexAttributeNew(numVerticesNew);
+    for (size_t i = 0; i < vertexRemap.size(); i++) {
+        if (vertexRemap[i] != INVALID_VERTEX_INDEX) {
+            vertexAttributeNew[vertexRemap[i]] = vertexAttribute[i];
+        }
+    }
+    vertexAttribute = std::move(vertexAttributeNew);
+}
+
+/**
+ * Computes the average cache miss ratio (ACMR), i.e., the number of transformed vertices per triangle, for a FIFO
+ * vertex cache of the passed size. The optimum is approximately 0.5 for large regular meshes, the worst case 3.
+ */
+DLL_OBJECT float computeAverageCacheMissRatio(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, uint32_t cacheSize = 16);
+
+/**
+ * Convenience function applying @see optimizeVertexCache, @see optimizeOverdraw (if optimizeForOverdraw is true) and
+ * @see optimizeVertexFetch to a shared index representation as computed by @see computeSharedIndexRepresentation.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle (input and output).
+ * @param vertexPositions The vertex positions (input and output).
+ * @param vertexNormals The vertex normals (input and output). Either empty or of the same size as vertexPositions;
+ * otherwise, an error is logged and the mesh is left unchanged.
+ * @param optimizeForOverdraw Whether to reorder the triangles to reduce overdraw.
+ */
+DLL_OBJECT void optimizeMeshForRendering(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        std::vector<glm::vec3>& vertexNormals, bool optimizeForOverdraw = true);
+DLL_OBJECT void optimizeMeshForRendering(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        bool optimizeForOverdraw = true);
+
+}
+
+#endif //SGL_MESHOPTIMIZATION_HPP
@@ -0,0 +1,756 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <tracy/Tracy.hpp>
+
+#include <Utils/Parallel/RadixSort.hpp>
+#include <Utils/Parallel/PrefixSum.hpp>
+#include "TriangleNormals.hpp"
+#include "MeshSimplification.hpp"
+
+namespace sgl {
+
+/**
+ * Symmetric 4x4 quadric matrix of the squared distances to a set of planes (weighted by their triangle area).
+ */
+struct QemQuadric {
+    double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0, b2 = 0.0, bc = 0.0, bd = 0.0, c2 = 0.0, cd = 0.0, d2 = 0.0;
+    double weight = 0.0;
+
+    QemQuadric() = default;
+    QemQuadric(const glm::dvec3& n, double d, double w)
+            : a2(w * n.x * n.x), ab(w * n.x * n.y), ac(w * n.x * n.z), ad(w * n.x * d),
+              b2(w * n.y * n.y), bc(w * n.y * n.z), bd(w * n.y * d),
+              c2(w * n.z * n.z), cd(w * n.z * d), d2(w * d * d), weight(w) {}
+
+    QemQuadric& operator+=(const QemQuadric& q) {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd; d2 += q.d2; weight += q.weight;
+        return *this;
+    }
+
+    [[nodiscard]] double evaluate(const glm::dvec3& p) const {
+        return a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x
+                + b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y
+                + c2 * p.z * p.z + 2.0 * cd * p.z + d2;
+    }
+
+    /// Computes the position of minimal error. Returns false if the system is (nearly) singular.
+    bool computeOptimum(glm::dvec3& p) const {
+        double det = a2 * (b2 * c2 - bc * bc) - ab * (ab * c2 - bc * ac) + ac * (ab * bc - b2 * ac);
+        if (std::abs(det) <= 1e-12 * std::max(weight * weight * weight, std::numeric_limits<double>::min())) {
+            return false;
+        }
+        double invDet = 1.0 / det;
+        p.x = -invDet * (ad * (b2 * c2 - bc * bc) - ab * (bd * c2 - bc * cd) + ac * (bd * bc - b2 * cd));
+        p.y = -invDet * (a2 * (bd * c2 - cd * bc) - ad * (ab * c2 - bc * ac) + ac * (ab * cd - bd * ac));
+        p.z = -invDet * (a2 * (b2 * cd - bc * bd) - ab * (ab * cd - bd * ac) + ad * (ab * bc - b2 * ac));
+        return std::isfinite(p.x) && std::isfinite(p.y) && std::isfinite(p.z);
+    }
+};
+
+/**
+ * Unique undirected edges (sorted by their vertex indices) and the number of triangles sharing them.
+ */
+struct QemEdgeList {
+    std::vector<uint32_t> vertexIndices0, vertexIndices1, numTriangles;
+};
+
+static void computeQemEdges(const std::vector<uint32_t>& triangleIndices, size_t numVertices, QemEdgeList& edges) {
+    int numVertexBits = 1;
+    while (numVertexBits < 32 && (size_t(1) << numVertexBits) < numVertices) {
+        numVertexBits++;
+    }
+    const uint64_t vertexMask = (uint64_t(1) << numVertexBits) - 1;
+
+    std::vector<uint64_t> edgeKeys(triangleIndices.size());
+    const size_t numCorners = edgeKeys.size();
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numCorners), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numCorners, triangleIndices, edgeKeys, numVertexBits) default(none)
+#endif
+    for (size_t i = 0; i < numCorners; i++) {
+#endif
+        uint32_t idx0 = triangleIndices[i];
+        uint32_t idx1 = triangleIndices[i - i % 3 + (i + 1) % 3];
+        edgeKeys[i] = (uint64_t(std::min(idx0, idx1)) << numVertexBits) | uint64_t(std::max(idx0, idx1));
+    }
+#ifdef USE_TBB
+    });
+#endif
+    radixSortKeys(edgeKeys, 2 * numVertexBits);
+
+    std::vector<uint32_t> edgeOutputIndices(numCorners);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numCorners), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numCorners, edgeKeys, edgeOutputIndices) default(none)
+#endif
+    for (size_t i = 0; i < numCorners; i++) {
+#endif
+        edgeOutputIndices[i] = i == 0 || edgeKeys[i] != edgeKeys[i - 1] ? 1 : 0;
+    }
+#ifdef USE_TBB
+    });
+#endif
+    const uint32_t numEdges = exclusivePrefixSum(edgeOutputIndices);
+    edges.vertexIndices0.resize(numEdges);
+    edges.vertexIndices1.resize(numEdges);
+    edges.numTriangles.resize(numEdges);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numCorners), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numCorners, edgeKeys, edgeOutputIndices, edges, numVertexBits, vertexMask) \
+    default(none)
+#endif
+    for (size_t i = 0; i < numCorners; i++) {
+#endif
+        if (i == 0 || edgeKeys[i] != edgeKeys[i - 1]) {
+            size_t runLength = 1;
+            while (i + runLength < numCorners && edgeKeys[i + runLength] == edgeKeys[i]) {
+                runLength++;
+            }
+            uint32_t edgeIdx = edgeOutputIndices[i];
+            edges.vertexIndices0[edgeIdx] = uint32_t(edgeKeys[i] >> numVertexBits);
+            edges.vertexIndices1[edgeIdx] = uint32_t(edgeKeys[i] & vertexMask);
+            edges.numTriangles[edgeIdx] = uint32_t(runLength);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+/**
+ * Removes all triangles with duplicate vertex indices (in parallel, keeping the order).
+ */
+static void removeDegenerateTriangles(std::vector<uint32_t>& triangleIndices) {
+    const size_t numTriangles = triangleIndices.size() / 3;
+    std::vector<uint32_t> outputIndices(numTriangles);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numTriangles), [&](auto const& r) {
+        for (auto triangleIdx = r.begin(); triangleIdx != r.end(); triangleIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numTriangles, triangleIndices, outputIndices) default(none)
+#endif
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+#endif
+        const uint32_t* indices = triangleIndices.data() + triangleIdx * 3;
+        bool isDegenerate = indices[0] == indices[1] || indices[1] == indices[2] || indices[0] == indices[2];
+        outputIndices[triangleIdx] = isDegenerate ? 0 : 1;
+    }
+#ifdef USE_TBB
+    });
+#endif
+    const uint32_t numTrianglesNew = exclusivePrefixSum(outputIndices);
+    if (numTrianglesNew == numTriangles) {
+        triangleIndices.resize(numTriangles * 3);
+        return;
+    }
+
+    std::vector<uint32_t> triangleIndicesNew(size_t(numTrianglesNew) * 3);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numTriangles), [&](auto const& r) {
+        for (auto triangleIdx = r.begin(); triangleIdx != r.end(); triangleIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numTriangles, numTrianglesNew, triangleIndices, triangleIndicesNew) \
+    shared(outputIndices) default(none)
+#endif
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+#endif
+        uint32_t outputIdx = outputIndices[triangleIdx];
+        uint32_t nextOutputIdx = triangleIdx + 1 < numTriangles ? outputIndices[triangleIdx + 1] : numTrianglesNew;
+        if (nextOutputIdx != outputIdx) {
+            for (size_t j = 0; j < 3; j++) {
+                triangleIndicesNew[size_t(outputIdx) * 3 + j] = triangleIndices[triangleIdx * 3 + j];
+            }
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    triangleIndices = std::move(triangleIndicesNew);
+}
+
+/**
+ * Collapse of the edge (keptVertexIdx, removedVertexIdx) into keptVertexIdx at the passed position.
+ */
+struct QemCollapse {
+    uint32_t keptVertexIdx = 0, removedVertexIdx = 0;
+    glm::vec3 position{};
+    float error = 0.0f;
+    bool isValid = false;
+};
+
+class QemMeshSimplifier {
+public:
+    QemMeshSimplifier(
+            const std::vector<uint32_t>& triangleIndicesIn, const std::vector<glm::vec3>& vertexPositionsIn,
+            const MeshSimplificationSettings& settings);
+    void simplify(size_t targetTriangleCount, float maxError);
+    void getMesh(std::vector<uint32_t>& triangleIndicesOut, std::vector<glm::vec3>& vertexPositionsOut) const;
+    [[nodiscard]] inline size_t getNumTriangles() const { return triangleIndices.size() / 3; }
+    [[nodiscard]] inline float getError() const { return maxCollapseError; }
+
+private:
+    /// Performs one round of independent collapses. Returns false if no collapse was possible.
+    bool performRound(size_t targetTriangleCount, float maxError);
+    void evaluateCollapse(
+            uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t numEdgeTriangles,
+            const VertexTriangleAdjacency& adjacency, const std::vector<uint8_t>& vertexFlags,
+            std::vector<uint32_t>& ring0, std::vector<uint32_t>& ring1, QemCollapse& collapse) const;
+    void collectRing(
+            uint32_t vertexIdx, const VertexTriangleAdjacency& adjacency, std::vector<uint32_t>& ring) const;
+    [[nodiscard]] bool getIsCollapseFlippingTriangles(
+            uint32_t vertexIdx, uint32_t otherVertexIdx, const glm::vec3& position,
+            const VertexTriangleAdjacency& adjacency) const;
+    [[nodiscard]] bool getIsCollapseCreatingDuplicateTriangles(
+            uint32_t vertexIdx0, uint32_t vertexIdx1, const VertexTriangleAdjacency& adjacency) const;
+
+    MeshSimplificationSettings settings;
+    std::vector<uint32_t> triangleIndices;
+    std::vector<glm::vec3> vertexPositions;
+    std::vector<QemQuadric> quadrics;
+    float maxCollapseError = 0.0f;
+};
+
+static const uint8_t QEM_VERTEX_BOUNDARY = 1;
+static const uint8_t QEM_VERTEX_NON_MANIFOLD = 2;
+
+QemMeshSimplifier::QemMeshSimplifier(
+        const std::vector<uint32_t>& triangleIndicesIn, const std::vector<glm::vec3>& vertexPositionsIn,
+        const MeshSimplificationSettings& settings) : settings(settings), vertexPositions(vertexPositionsIn) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositions.size();
+    triangleIndices.reserve(triangleIndicesIn.size());
+    for (size_t i = 0; i + 2 < triangleIndicesIn.size(); i += 3) {
+        if (triangleIndicesIn[i] < numVertices && triangleIndicesIn[i + 1] < numVertices
+                && triangleIndicesIn[i + 2] < numVertices) {
+            triangleIndices.insert(triangleIndices.end(), triangleIndicesIn.begin() + ptrdiff_t(i),
+                                   triangleIndicesIn.begin() + ptrdiff_t(i + 3));
+        }
+    }
+    removeDegenerateTriangles(triangleIndices);
+
+    // Gather the area-weighted plane quadrics of the adjacent triangles.
+    VertexTriangleAdjacency adjacency;
+    computeVertexTriangleAdjacency(triangleIndices, numVertices, adjacency);
+    quadrics.resize(numVertices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, adjacency) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        QemQuadric quadric;
+        for (uint32_t i = adjacency.offsets[vertexIdx]; i < adjacency.offsets[vertexIdx + 1]; i++) {
+            const uint32_t* indices = triangleIndices.data() + (adjacency.cornerIndices[i] / 3) * 3;
+            glm::dvec3 p0(vertexPositions[indices[0]]);
+            glm::dvec3 p1(vertexPositions[indices[1]]);
+            glm::dvec3 p2(vertexPositions[indices[2]]);
+            glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+            double normalLength = glm::length(normal);
+            if (normalLength > 0.0) {
+                normal /= normalLength;
+                quadric += QemQuadric(normal, -glm::dot(normal, p0), 0.5 * normalLength);
+            }
+        }
+        quadrics[vertexIdx] = quadric;
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    // Add quadrics of planes perpendicular to the boundary edges to preserve the boundaries.
+    QemEdgeList edges;
+    computeQemEdges(triangleIndices, numVertices, edges);
+    for (size_t edgeIdx = 0; edgeIdx < edges.numTriangles.size(); edgeIdx++) {
+        if (edges.numTriangles[edgeIdx] != 1) {
+            continue;
+        }
+        uint32_t vertexIdx0 = edges.vertexIndices0[edgeIdx];
+        uint32_t vertexIdx1 = edges.vertexIndices1[edgeIdx];
+        for (uint32_t i = adjacency.offsets[vertexIdx0]; i < adjacency.offsets[vertexIdx0 + 1]; i++) {
+            const uint32_t* indices = triangleIndices.data() + (adjacency.cornerIndices[i] / 3) * 3;
+            if (indices[0] != vertexIdx1 && indices[1] != vertexIdx1 && indices[2] != vertexIdx1) {
+                continue;
+            }
+            glm::dvec3 p0(vertexPositions[indices[0]]);
+            glm::dvec3 p1(vertexPositions[indices[1]]);
+            glm::dvec3 p2(vertexPositions[indices[2]]);
+            glm::dvec3 edgeStart(vertexPositions[vertexIdx0]);
+            glm::dvec3 edgeDirection = glm::dvec3(vertexPositions[vertexIdx1]) - edgeStart;
+            glm::dvec3 normal = glm::cross(edgeDirection, glm::cross(p1 - p0, p2 - p0));
+            double normalLength = glm::length(normal);
+            if (normalLength > 0.0) {
+                normal /= normalLength;
+                QemQuadric quadric(
+                        normal, -glm::dot(normal, edgeStart),
+                        double(settings.boundaryWeight) * glm::dot(edgeDirection, edgeDirection));
+                quadrics[vertexIdx0] += quadric;
+                quadrics[vertexIdx1] += quadric;
+            }
+            break;
+        }
+    }
+}
+
+void QemMeshSimplifier::collectRing(
+        uint32_t vertexIdx, const VertexTriangleAdjacency& adjacency, std::vector<uint32_t>& ring) const {
+    ring.clear();
+    for (uint32_t i = adjacency.offsets[vertexIdx]; i < adjacency.offsets[vertexIdx + 1]; i++) {
+        const uint32_t* indices = triangleIndices.data() + (adjacency.cornerIndices[i] / 3) * 3;
+        for (size_t j = 0; j < 3; j++) {
+            if (indices[j] != vertexIdx) {
+                ring.push_back(indices[j]);
+            }
+        }
+    }
+    std::sort(ring.begin(), ring.end());
+    ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+}
+
+bool QemMeshSimplifier::getIsCollapseFlippingTriangles(
+        uint32_t vertexIdx, uint32_t otherVertexIdx, const glm::vec3& position,
+        const VertexTriangleAdjacency& adjacency) const {
+    for (uint32_t i = adjacency.offsets[vertexIdx]; i < adjacency.offsets[vertexIdx + 1]; i++) {
+        uint32_t cornerIdx = adjacency.cornerIndices[i];
+        const uint32_t* indices = triangleIndices.data() + (cornerIdx / 3) * 3;
+        if (indices[0] == otherVertexIdx || indices[1] == otherVertexIdx || indices[2] == otherVertexIdx) {
+            // This triangle is removed by the collapse.
+            continue;
+        }
+        glm::vec3 p[3] = { vertexPositions[indices[0]], vertexPositions[indices[1]], vertexPositions[indices[2]] };
+        glm::vec3 normalOld = glm::cross(p[1] - p[0], p[2] - p[0]);
+        p[cornerIdx % 3] = position;
+        glm::vec3 normalNew = glm::cross(p[1] - p[0], p[2] - p[0]);
+        if (glm::dot(normalOld, normalNew) <= 0.0f) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool QemMeshSimplifier::getIsCollapseCreatingDuplicateTriangles(
+        uint32_t vertexIdx0, uint32_t vertexIdx1, const VertexTriangleAdjacency& adjacency) const {
+    // Returns the two vertices of the triangle other than vertexIdx in ascending order.
+    auto getOppositeEdge = [this](uint32_t triangleIdx, uint32_t vertexIdx) {
+        const uint32_t* indices = triangleIndices.data() + triangleIdx * 3;
+        uint32_t edge[2];
+        size_t numEdgeVertices = 0;
+        for (size_t j = 0; j < 3 && numEdgeVertices < 2; j++) {
+            if (indices[j] != vertexIdx) {
+                edge[numEdgeVertices++] = indices[j];
+            }
+        }
+        return std::make_pair(std::min(edge[0], edge[1]), std::max(edge[0], edge[1]));
+    };
+    auto getContainsVertex = [this](uint32_t triangleIdx, uint32_t vertexIdx) {
+        const uint32_t* indices = triangleIndices.data() + triangleIdx * 3;
+        return indices[0] == vertexIdx || indices[1] == vertexIdx || indices[2] == vertexIdx;
+    };
+
+    // The triangles of both vertices not containing the edge are merged into the fan of one vertex. Two of them
+    // sharing the opposite edge would become coincident (e.g., the remainder of a collapsed tetrahedron).
+    for (uint32_t i = adjacency.offsets[vertexIdx0]; i < adjacency.offsets[vertexIdx0 + 1]; i++) {
+        uint32_t triangleIdx0 = adjacency.cornerIndices[i] / 3;
+        if (getContainsVertex(triangleIdx0, vertexIdx1)) {
+            continue;
+        }
+        auto oppositeEdge0 = getOppositeEdge(triangleIdx0, vertexIdx0);
+        for (uint32_t k = adjacency.offsets[vertexIdx1]; k < adjacency.offsets[vertexIdx1 + 1]; k++) {
+            uint32_t triangleIdx1 = adjacency.cornerIndices[k] / 3;
+            if (!getContainsVertex(triangleIdx1, vertexIdx0)
+                    && getOppositeEdge(triangleIdx1, vertexIdx1) == oppositeEdge0) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void QemMeshSimplifier::evaluateCollapse(
+        uint32_t vertexIdx0, uint32_t vertexIdx1, uint32_t numEdgeTriangles,
+        const VertexTriangleAdjacency& adjacency, const std::vector<uint8_t>& vertexFlags,
+        std::vector<uint32_t>& ring0, std::vector<uint32_t>& ring1, QemCollapse& collapse) const {
+    collapse.isValid = false;
+    const uint8_t flags0 = vertexFlags[vertexIdx0];
+    const uint8_t flags1 = vertexFlags[vertexIdx1];
+    if (numEdgeTriangles > 2 || ((flags0 | flags1) & QEM_VERTEX_NON_MANIFOLD) != 0) {
+        return;
+    }
+    const bool isBoundary0 = (flags0 & QEM_VERTEX_BOUNDARY) != 0;
+    const bool isBoundary1 = (flags1 & QEM_VERTEX_BOUNDARY) != 0;
+    if (numEdgeTriangles == 2 && isBoundary0 && isBoundary1) {
+        // An interior edge connecting two boundary vertices would pinch the mesh.
+        return;
+    }
+
+    // Link condition: The only common neighbors are the opposite vertices of the triangles sharing the edge.
+    collectRing(vertexIdx0, adjacency, ring0);
+    collectRing(vertexIdx1, adjacency, ring1);
+    uint32_t numCommonNeighbors = 0;
+    auto it0 = ring0.begin(), it1 = ring1.begin();
+    while (it0 != ring0.end() && it1 != ring1.end()) {
+        if (*it0 < *it1) {
+            it0++;
+        } else if (*it1 < *it0) {
+            it1++;
+        } else {
+            numCommonNeighbors++;
+            it0++;
+            it1++;
+        }
+    }
+    if (numCommonNeighbors != numEdgeTriangles
+            || getIsCollapseCreatingDuplicateTriangles(vertexIdx0, vertexIdx1, adjacency)) {
+        return;
+    }
+
+    QemQuadric quadric = quadrics[vertexIdx0];
+    quadric += quadrics[vertexIdx1];
+    const glm::dvec3 p0(vertexPositions[vertexIdx0]);
+    const glm::dvec3 p1(vertexPositions[vertexIdx1]);
+    double minCost = std::numeric_limits<double>::max();
+    glm::dvec3 bestPosition = p0;
+    bool keepVertex0 = true;
+    auto checkCandidate = [&](const glm::dvec3& position, bool keep0) {
+        double cost = quadric.evaluate(position);
+        if (cost < minCost) {
+            minCost = cost;
+            bestPosition = position;
+            keepVertex0 = keep0;
+        }
+    };
+    if (settings.useOptimalPlacement) {
+        // With optimal placement, the vertex with the smaller index is kept.
+        glm::dvec3 optimum;
+        glm::dvec3 midpoint = 0.5 * (p0 + p1);
+        if (quadric.computeOptimum(optimum)
+                && glm::length(optimum - midpoint) <= 2.0 * glm::length(p1 - p0)) {
+            checkCandidate(optimum, true);
+        }
+        checkCandidate(p0, true);
+        checkCandidate(p1, true);
+        checkCandidate(midpoint, true);
+    } else {
+        // Boundary vertices must not move to the interior.
+        if (isBoundary0 || !isBoundary1) {
+            checkCandidate(p0, true);
+        }
+        if (isBoundary1 || !isBoundary0) {
+            checkCandidate(p1, false);
+        }
+    }
+
+    collapse.keptVertexIdx = keepVertex0 ? vertexIdx0 : vertexIdx1;
+    collapse.removedVertexIdx = keepVertex0 ? vertexIdx1 : vertexIdx0;
+    collapse.position = glm::vec3(bestPosition);
+    if (getIsCollapseFlippingTriangles(vertexIdx0, vertexIdx1, collapse.position, adjacency)
+            || getIsCollapseFlippingTriangles(vertexIdx1, vertexIdx0, collapse.position, adjacency)) {
+        return;
+    }
+    collapse.error = float(std::sqrt(std::max(minCost, 0.0) / std::max(quadric.weight, 1e-30)));
+    collapse.isValid = std::isfinite(collapse.error);
+}
+
+bool QemMeshSimplifier::performRound(size_t targetTriangleCount, float maxError) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositions.size();
+    const size_t numTriangles = getNumTriangles();
+    VertexTriangleAdjacency adjacency;
+    computeVertexTriangleAdjacency(triangleIndices, numVertices, adjacency);
+    QemEdgeList edges;
+    computeQemEdges(triangleIndices, numVertices, edges);
+    const size_t numEdges = edges.numTriangles.size();
+
+    std::vector<uint8_t> vertexFlags(numVertices, 0);
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+        uint32_t numEdgeTriangles = edges.numTriangles[edgeIdx];
+        if (numEdgeTriangles != 2) {
+            uint8_t flag = numEdgeTriangles == 1 ? QEM_VERTEX_BOUNDARY : QEM_VERTEX_NON_MANIFOLD;
+            vertexFlags[edges.vertexIndices0[edgeIdx]] |= flag;
+            vertexFlags[edges.vertexIndices1[edgeIdx]] |= flag;
+        }
+    }
+
+    // 1. Evaluate the collapses of all edges in parallel.
+    std::vector<QemCollapse> collapses(numEdges);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numEdges), [&](auto const& r) {
+        std::vector<uint32_t> ring0, ring1;
+        for (auto edgeIdx = r.begin(); edgeIdx != r.end(); edgeIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel default(none) shared(numEdges, edges, adjacency, vertexFlags, collapses)
+#endif
+    {
+    std::vector<uint32_t> ring0, ring1;
+#if _OPENMP >= 201107
+    #pragma omp for schedule(dynamic, 1024)
+#endif
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+#endif
+        evaluateCollapse(
+                edges.vertexIndices0[edgeIdx], edges.vertexIndices1[edgeIdx], edges.numTriangles[edgeIdx],
+                adjacency, vertexFlags, ring0, ring1, collapses[edgeIdx]);
+    }
+#ifdef USE_TBB
+    });
+#else
+    }
+#endif
+
+    // 2. Sort the valid collapses by their error. Non-negative floats have the same order as their bit patterns.
+    std::vector<uint32_t> sortKeys, sortedEdgeIndices;
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+        const QemCollapse& collapse = collapses[edgeIdx];
+        if (collapse.isValid && collapse.error <= maxError) {
+            uint32_t errorBits;
+            std::memcpy(&errorBits, &collapse.error, sizeof(uint32_t));
+            sortKeys.push_back(errorBits);
+            sortedEdgeIndices.push_back(uint32_t(edgeIdx));
+        }
+    }
+    if (sortKeys.empty()) {
+        return false;
+    }
+    radixSortKeyValuePairs(sortKeys, sortedEdgeIndices);
+
+    // 3. Greedily select an independent set of collapses with disjoint neighborhoods among the cheapest edges.
+    const size_t numCandidates = std::max(
+            size_t(std::ceil(double(sortKeys.size()) * double(settings.collapseFractionPerRound))), size_t(1));
+    const size_t numTrianglesToRemove = numTriangles - targetTriangleCount;
+    std::vector<uint8_t> isVertexLocked(numVertices, 0);
+    std::vector<uint32_t> selectedEdgeIndices;
+    size_t numTrianglesRemoved = 0;
+    auto lockNeighborhood = [&](uint32_t vertexIdx) {
+        isVertexLocked[vertexIdx] = 1;
+        for (uint32_t i = adjacency.offsets[vertexIdx]; i < adjacency.offsets[vertexIdx + 1]; i++) {
+            const uint32_t* indices = triangleIndices.data() + (adjacency.cornerIndices[i] / 3) * 3;
+            isVertexLocked[indices[0]] = 1;
+            isVertexLocked[indices[1]] = 1;
+            isVertexLocked[indices[2]] = 1;
+        }
+    };
+    for (size_t i = 0; i < std::min(numCandidates, sortedEdgeIndices.size()); i++) {
+        uint32_t edgeIdx = sortedEdgeIndices[i];
+        const QemCollapse& collapse = collapses[edgeIdx];
+        if (isVertexLocked[collapse.keptVertexIdx] || isVertexLocked[collapse.removedVertexIdx]) {
+            continue;
+        }
+        lockNeighborhood(collapse.keptVertexIdx);
+        lockNeighborhood(collapse.removedVertexIdx);
+        selectedEdgeIndices.push_back(edgeIdx);
+        numTrianglesRemoved += edges.numTriangles[edgeIdx];
+        if (numTrianglesRemoved >= numTrianglesToRemove) {
+            break;
+        }
+    }
+
+    // 4. Apply the collapses. As the neighborhoods are disjoint, every triangle is modified by at most one collapse.
+    const size_t numSelectedEdges = selectedEdgeIndices.size();
+    float roundError = 0.0f;
+    for (uint32_t edgeIdx : selectedEdgeIndices) {
+        roundError = std::max(roundError, collapses[edgeIdx].error);
+    }
+    maxCollapseError = std::max(maxCollapseError, roundError);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numSelectedEdges), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) shared(numSelectedEdges, selectedEdgeIndices, collapses, adjacency)
+#endif
+    for (size_t i = 0; i < numSelectedEdges; i++) {
+#endif
+        const QemCollapse& collapse = collapses[selectedEdgeIndices[i]];
+        vertexPositions[collapse.keptVertexIdx] = collapse.position;
+        quadrics[collapse.keptVertexIdx] += quadrics[collapse.removedVertexIdx];
+        uint32_t removedVertexIdx = collapse.removedVertexIdx;
+        for (uint32_t j = adjacency.offsets[removedVertexIdx]; j < adjacency.offsets[removedVertexIdx + 1]; j++) {
+            triangleIndices[adjacency.cornerIndices[j]] = collapse.keptVertexIdx;
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    removeDegenerateTriangles(triangleIndices);
+    return true;
+}
+
+void QemMeshSimplifier::simplify(size_t targetTriangleCount, float maxError) {
+    ZoneScoped;
+
+    while (getNumTriangles() > targetTriangleCount) {
+        if (!performRound(targetTriangleCount, maxError)) {
+            break;
+        }
+    }
+}
+
+void QemMeshSimplifier::getMesh(
+        std::vector<uint32_t>& triangleIndicesOut, std::vector<glm::vec3>& vertexPositionsOut) const {
+    ZoneScoped;
+
+    // Remove unreferenced vertices (keeping the order of the remaining vertices).
+    const size_t numVertices = vertexPositions.size();
+    std::vector<uint32_t> vertexRemap(numVertices, 0);
+    for (uint32_t vertexIdx : triangleIndices) {
+        vertexRemap[vertexIdx] = 1;
+    }
+    std::vector<uint8_t> isVertexUsed(numVertices);
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+        isVertexUsed[vertexIdx] = uint8_t(vertexRemap[vertexIdx]);
+    }
+    const uint32_t numVerticesNew = exclusivePrefixSum(vertexRemap);
+
+    vertexPositionsOut.resize(numVerticesNew);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) shared(numVertices, isVertexUsed, vertexRemap, vertexPositionsOut)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        if (isVertexUsed[vertexIdx]) {
+            vertexPositionsOut[vertexRemap[vertexIdx]] = vertexPositions[vertexIdx];
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    const size_t numIndices = triangleIndices.size();
+    triangleIndicesOut.resize(numIndices);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numIndices), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) shared(numIndices, vertexRemap, triangleIndicesOut)
+#endif
+    for (size_t i = 0; i < numIndices; i++) {
+#endif
+        triangleIndicesOut[i] = vertexRemap[triangleIndices[i]];
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+float simplifyMesh(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        const MeshSimplificationSettings& settings) {
+    ZoneScoped;
+
+    QemMeshSimplifier simplifier(triangleIndices, vertexPositions, settings);
+    simplifier.simplify(settings.targetTriangleCount, settings.maxError);
+    simplifier.getMesh(triangleIndices, vertexPositions);
+    return simplifier.getError();
+}
+
+void generateMeshLods(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        std::vector<MeshLod>& lods, int maxNumLods, float reductionFactor,
+        const MeshSimplificationSettings& settings) {
+    ZoneScoped;
+
+    lods.clear();
+    QemMeshSimplifier simplifier(triangleIndices, vertexPositions, settings);
+    lods.emplace_back();
+    simplifier.getMesh(lods.back().triangleIndices, lods.back().vertexPositions);
+
+    for (int lodIdx = 1; lodIdx < maxNumLods; lodIdx++) {
+        size_t numTrianglesPrev = simplifier.getNumTriangles();
+        size_t targetTriangleCount = std::max(
+                size_t(double(numTrianglesPrev) * double(reductionFactor)), settings.targetTriangleCount);
+        if (targetTriangleCount >= numTrianglesPrev) {
+            break;
+        }
+        simplifier.simplify(targetTriangleCount, settings.maxError);
+        if (simplifier.getNumTriangles() == numTrianglesPrev) {
+            break;
+        }
+        lods.emplace_back();
+        MeshLod& lod = lods.back();
+        simplifier.getMesh(lod.triangleIndices, lod.vertexPositions);
+        lod.error = simplifier.getError();
+        if (simplifier.getNumTriangles() > targetTriangleCount) {
+            // The error bound was reached.
+            break;
+        }
+    }
+}
+
+float computeScreenSpaceError(float error, float distance, float fovy, float viewportHeight) {
+    if (distance <= 0.0f) {
+        return std::numeric_limits<float>::max();
+    }
+    return error * viewportHeight / (2.0f * distance * std::tan(0.5f * fovy));
+}
+
+size_t selectMeshLod(
+        const std::vector<MeshLod>& lods, float distance, float fovy, float viewportHeight, float maxPixelError) {
+    for (size_t lodIdx = lods.size(); lodIdx > 1; lodIdx--) {
+        if (computeScreenSpaceError(lods[lodIdx - 1].error, distance, fovy, viewportHeight) <= maxPixelError) {
+            return lodIdx - 1;
+        }
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,126 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_MESHSIMPLIFICATION_HPP
+#define SGL_MESHSIMPLIFICATION_HPP
+
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+#include <glm/vec3.hpp>
+
+namespace sgl {
+
+/**
+ * Settings for the quadric error metric (QEM) edge collapse simplifier (@see simplifyMesh).
+ * For more details on QEM see: M. Garland, P. S. Heckbert, "Surface simplification using quadric error metrics",
+ * SIGGRAPH 1997.
+ */
+struct DLL_OBJECT MeshSimplificationSettings {
+    /// The simplification stops when the number of triangles is at most this value.
+    size_t targetTriangleCount = 0;
+    /**
+     * Edges are only collapsed if the resulting error is at most this value. The error is the root of the
+     * area-weighted mean squared distance to the planes of the merged original triangles, i.e., it is in object space
+     * units and can be converted to a screen-space error (@see computeScreenSpaceError).
+     */
+    float maxError = std::numeric_limits<float>::max();
+    /**
+     * The collapses are performed in rounds. In every round, the costs of all edges are evaluated in parallel, and an
+     * independent set of collapses (with disjoint neighborhoods) is chosen from the given fraction of the edges with
+     * the lowest cost. Smaller values give a better quality, larger values need less rounds.
+     */
+    float collapseFractionPerRound = 0.2f;
+    /// Weight of the quadrics preserving the mesh boundaries.
+    float boundaryWeight = 10.0f;
+    /// If true, the collapsed vertex is placed at the position of minimal error, otherwise on one of the two vertices.
+    bool useOptimalPlacement = true;
+};
+
+/**
+ * Simplifies a mesh in shared index representation (@see computeSharedIndexRepresentation) using parallel rounds of
+ * quadric error metric edge collapses. The result is deterministic and independent of the number of threads.
+ * Collapses changing the topology (violating the link condition or creating coincident triangles, e.g., when
+ * collapsing a tetrahedron) or flipping triangles are rejected.
+ * Unreferenced vertices are removed from the output.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle (input and output).
+ * @param vertexPositions The vertex positions (input and output).
+ * @param settings The simplification settings.
+ * @return The maximum error of the performed collapses.
+ */
+DLL_OBJECT float simplifyMesh(
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        const MeshSimplificationSettings& settings);
+
+/**
+ * One level of detail (LOD) of a mesh.
+ */
+struct DLL_OBJECT MeshLod {
+    std::vector<uint32_t> triangleIndices;
+    std::vector<glm::vec3> vertexPositions;
+    /// The maximum object space error compared to the original mesh (@see MeshSimplificationSettings::maxError).
+    float error = 0.0f;
+};
+
+/**
+ * Generates a chain of levels of detail. Level 0 is the original mesh (without unreferenced vertices), and every
+ * further level has at most reductionFactor times the number of triangles of the previous one. The levels are
+ * computed by one continuous simplification, so the error of every level is measured against the original mesh.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param vertexPositions The vertex positions.
+ * @param lods The generated levels of detail (output).
+ * @param maxNumLods The maximum number of levels (including the original mesh).
+ * @param reductionFactor The ratio of the triangle counts of two consecutive levels.
+ * @param settings targetTriangleCount is the minimum number of triangles; maxError stops the generation of levels.
+ */
+DLL_OBJECT void generateMeshLods(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        std::vector<MeshLod>& lods, int maxNumLods = 8, float reductionFactor = 0.5f,
+        const MeshSimplificationSettings& settings = MeshSimplificationSettings());
+
+/**
+ * Projects an object space error at the passed distance to the camera to pixels.
+ * @param error The object space error.
+ * @param distance The distance to the camera.
+ * @param fovy The vertical field of view of the camera (in radians).
+ * @param viewportHeight The height of the viewport in pixels.
+ */
+DLL_OBJECT float computeScreenSpaceError(float error, float distance, float fovy, float viewportHeight);
+
+/**
+ * Selects the coarsest level of detail whose screen-space error is at most maxPixelError.
+ */
+DLL_OBJECT size_t selectMeshLod(
+        const std::vector<MeshLod>& lods, float distance, float fovy, float viewportHeight,
+        float maxPixelError = 1.0f);
+
+}
+
+#endif //SGL_MESHSIMPLIFICATION_HPP
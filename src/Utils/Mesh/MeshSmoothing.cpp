@@ -26,8 +26,28 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SGL_MESH_SMOOTHING_SSE
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SGL_MESH_SMOOTHING_NEON
+#endif
+
 #include <glm/glm.hpp>
 #include <tracy/Tracy.hpp>
+
+#include <Utils/File/Logfile.hpp>
+#include <Utils/Parallel/RadixSort.hpp>
 #include "MeshSmoothing.hpp"
 
 namespace sgl {
@@ -76,26 +96,380 @@ void laplacianSmoothing(
         int numIterations, float lambda) {
     ZoneScoped;
 
-    std::unordered_map<uint32_t, std::unordered_set<uint32_t>> neighborsMap;
-    createNeighborMap(triangleIndices, neighborsMap);
-
-    std::vector<glm::vec3> pointsTmp;
-    pointsTmp.resize(vertexPositions.size());
-    for (int i = 0; i < 4; i++) {
-        std::vector<glm::vec3>* pointsIn;
-        std::vector<glm::vec3>* pointsOut;
-        if (i % 2 == 0) {
-            pointsIn = &vertexPositions;
-            pointsOut = &pointsTmp;
-        } else {
-            pointsIn = &pointsTmp;
-            pointsOut = &vertexPositions;
+    VertexAdjacency adjacency;
+    computeVertexAdjacency(triangleIndices, vertexPositions.size(), adjacency);
+    laplacianSmoothing(adjacency, vertexPositions, numIterations, lambda);
+}
+
+void laplacianSmoothing(
+        const std::vector<glm::vec3>& pointsIn, std::vector<glm::vec3>& pointsOut,
+        const VertexAdjacency& adjacency, float lambda) {
+    ZoneScoped;
+
+    const size_t numVertices = pointsIn.size();
+    const uint32_t* offsets = adjacency.offsets.data();
+    const uint32_t* neighborIndices = adjacency.neighborIndices.data();
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, pointsIn, pointsOut, offsets, neighborIndices, lambda) default(none)
+#endif
+    for (size_t i = 0; i < numVertices; i++) {
+#endif
+        const glm::vec3& point = pointsIn[i];
+        float weightSum = 0.0f;
+        glm::vec3 pointSum(0.0f);
+        for (uint32_t neighborIdx = offsets[i]; neighborIdx < offsets[i + 1]; neighborIdx++) {
+            const glm::vec3& neighborPoint = pointsIn[neighborIndices[neighborIdx]];
+            float distance = glm::length(point - neighborPoint);
+            // Coincident neighbors would lead to an infinite weight.
+            if (distance > 0.0f) {
+                float w_ij = 1.0f / distance;
+                weightSum += w_ij;
+                pointSum += w_ij * neighborPoint;
+            }
         }
-        laplacianSmoothing(*pointsIn, *pointsOut, neighborsMap, lambda);
+        pointsOut[i] = weightSum > 0.0f ? point + lambda * (1.0f / weightSum * pointSum - point) : point;
     }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+void laplacianSmoothing(
+        const VertexAdjacency& adjacency, std::vector<glm::vec3>& vertexPositions,
+        int numIterations, float lambda) {
+    MeshSmoothingSettings settings;
+    settings.numIterations = numIterations;
+    settings.lambda = lambda;
+    smoothMesh(adjacency, vertexPositions, settings);
+}
+
+void computeLockedVertices(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        bool lockBoundaryVertices, float featureAngle, std::vector<uint8_t>& isVertexLocked) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositions.size();
+    const size_t numTriangles = triangleIndices.size() / 3;
+    isVertexLocked.clear();
+    isVertexLocked.resize(numVertices, 0);
+    const bool lockFeatureVertices = featureAngle > 0.0f;
+    if (!lockBoundaryVertices && !lockFeatureVertices) {
+        return;
+    }
+    const float cosFeatureAngle = std::cos(featureAngle);
+
+    std::vector<glm::vec3> faceNormals;
+    if (lockFeatureVertices) {
+        faceNormals.resize(numTriangles);
+    }
+    int numVertexBits = 1;
+    while (numVertexBits < 32 && (size_t(1) << numVertexBits) < numVertices) {
+        numVertexBits++;
+    }
+    const uint64_t invalidKey =
+            numVertexBits == 32 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << (2 * numVertexBits)) - 1;
+
+    // Sort the undirected edges of all triangles, so all triangles sharing an edge are consecutive.
+    std::vector<uint64_t> edgeKeys(numTriangles * 3);
+    std::vector<uint32_t> edgeTriangles(numTriangles * 3);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numTriangles), [&](auto const& r) {
+        for (auto triangleIdx = r.begin(); triangleIdx != r.end(); triangleIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numTriangles, numVertices, triangleIndices, vertexPositions, faceNormals) \
+    shared(lockFeatureVertices, numVertexBits, invalidKey, edgeKeys, edgeTriangles) default(none)
+#endif
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+#endif
+        bool isTriangleValid = true;
+        for (size_t i = 0; i < 3; i++) {
+            uint32_t idx0 = triangleIndices[triangleIdx * 3 + i];
+            uint32_t idx1 = triangleIndices[triangleIdx * 3 + (i + 1) % 3];
+            bool isValid = idx0 != idx1 && idx0 < numVertices && idx1 < numVertices;
+            isTriangleValid = isTriangleValid && isValid;
+            edgeKeys[triangleIdx * 3 + i] = isValid
+                    ? (uint64_t(std::min(idx0, idx1)) << numVertexBits) | uint64_t(std::max(idx0, idx1))
+                    : invalidKey;
+            edgeTriangles[triangleIdx * 3 + i] = uint32_t(triangleIdx);
+        }
+        if (lockFeatureVertices && isTriangleValid) {
+            const glm::vec3& p0 = vertexPositions[triangleIndices[triangleIdx * 3]];
+            const glm::vec3& p1 = vertexPositions[triangleIndices[triangleIdx * 3 + 1]];
+            const glm::vec3& p2 = vertexPositions[triangleIndices[triangleIdx * 3 + 2]];
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float normalLength = glm::length(normal);
+            faceNormals[triangleIdx] = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    radixSortKeyValuePairs(edgeKeys, edgeTriangles, 2 * numVertexBits);
+    const size_t numEdges = size_t(
+            std::lower_bound(edgeKeys.begin(), edgeKeys.end(), invalidKey) - edgeKeys.begin());
+
+    // Classify the edges; the flag is stored at the first occurrence of every edge.
+    std::vector<uint8_t> isEdgeLocked(numEdges, 0);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numEdges), [&](auto const& r) {
+        for (auto edgeIdx = r.begin(); edgeIdx != r.end(); edgeIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numEdges, edgeKeys, edgeTriangles, faceNormals, isEdgeLocked) \
+    shared(lockBoundaryVertices, lockFeatureVertices, cosFeatureAngle) default(none)
+#endif
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+#endif
+        if (edgeIdx != 0 && edgeKeys[edgeIdx] == edgeKeys[edgeIdx - 1]) {
+            continue;
+        }
+        size_t numEdgeTriangles = 1;
+        while (edgeIdx + numEdgeTriangles < numEdges && edgeKeys[edgeIdx + numEdgeTriangles] == edgeKeys[edgeIdx]) {
+            numEdgeTriangles++;
+        }
+        if (numEdgeTriangles == 1) {
+            isEdgeLocked[edgeIdx] = lockBoundaryVertices ? 1 : 0;
+        } else if (lockFeatureVertices) {
+            if (numEdgeTriangles > 2) {
+                isEdgeLocked[edgeIdx] = 1;
+            } else {
+                float cosAngle = glm::dot(
+                        faceNormals[edgeTriangles[edgeIdx]], faceNormals[edgeTriangles[edgeIdx + 1]]);
+                isEdgeLocked[edgeIdx] = cosAngle < cosFeatureAngle ? 1 : 0;
+            }
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    const uint64_t vertexMask = (uint64_t(1) << numVertexBits) - 1;
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+        if (isEdgeLocked[edgeIdx]) {
+            isVertexLocked[edgeKeys[edgeIdx] >> numVertexBits] = 1;
+            isVertexLocked[edgeKeys[edgeIdx] & vertexMask] = 1;
+        }
+    }
+}
+
+/**
+ * Computes the weighted sum of the neighbors of a vertex. Four neighbors are processed at once using SIMD
+ * instructions, the remaining ones serially. Coincident neighbors are skipped when using inverse distance weights.
+ */
+static void computeNeighborSum(
+        const float* pointsX, const float* pointsY, const float* pointsZ, size_t vertexIdx,
+        const uint32_t* neighborIndices, uint32_t numNeighbors, bool useInverseDistanceWeights,
+        glm::vec3& pointSum, float& weightSum) {
+    const float px = pointsX[vertexIdx];
+    const float py = pointsY[vertexIdx];
+    const float pz = pointsZ[vertexIdx];
+    uint32_t i = 0;
+    pointSum = glm::vec3(0.0f);
+    weightSum = 0.0f;
+
+#if defined(SGL_MESH_SMOOTHING_SSE)
+    if (numNeighbors >= 4) {
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 pxs = _mm_set1_ps(px), pys = _mm_set1_ps(py), pzs = _mm_set1_ps(pz);
+        __m128 sumX = zero, sumY = zero, sumZ = zero, sumW = zero;
+        for (; i + 4 <= numNeighbors; i += 4) {
+            const uint32_t* n = neighborIndices + i;
+            __m128 nx = _mm_setr_ps(pointsX[n[0]], pointsX[n[1]], pointsX[n[2]], pointsX[n[3]]);
+            __m128 ny = _mm_setr_ps(pointsY[n[0]], pointsY[n[1]], pointsY[n[2]], pointsY[n[3]]);
+            __m128 nz = _mm_setr_ps(pointsZ[n[0]], pointsZ[n[1]], pointsZ[n[2]], pointsZ[n[3]]);
+            __m128 w = one;
+            if (useInverseDistanceWeights) {
+                __m128 dx = _mm_sub_ps(nx, pxs), dy = _mm_sub_ps(ny, pys), dz = _mm_sub_ps(nz, pzs);
+                __m128 squaredDistance = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                w = _mm_and_ps(
+                        _mm_cmpgt_ps(squaredDistance, zero), _mm_div_ps(one, _mm_sqrt_ps(squaredDistance)));
+            }
+            sumX = _mm_add_ps(sumX, _mm_mul_ps(w, nx));
+            sumY = _mm_add_ps(sumY, _mm_mul_ps(w, ny));
+            sumZ = _mm_add_ps(sumZ, _mm_mul_ps(w, nz));
+            sumW = _mm_add_ps(sumW, w);
+        }
+        alignas(16) float sums[4][4];
+        _mm_store_ps(sums[0], sumX);
+        _mm_store_ps(sums[1], sumY);
+        _mm_store_ps(sums[2], sumZ);
+        _mm_store_ps(sums[3], sumW);
+        pointSum = glm::vec3(
+                (sums[0][0] + sums[0][1]) + (sums[0][2] + sums[0][3]),
+                (sums[1][0] + sums[1][1]) + (sums[1][2] + sums[1][3]),
+                (sums[2][0] + sums[2][1]) + (sums[2][2] + sums[2][3]));
+        weightSum = (sums[3][0] + sums[3][1]) + (sums[3][2] + sums[3][3]);
+    }
+#elif defined(SGL_MESH_SMOOTHING_NEON)
+    if (numNeighbors >= 4) {
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float32x4_t one = vdupq_n_f32(1.0f);
+        const float32x4_t pxs = vdupq_n_f32(px), pys = vdupq_n_f32(py), pzs = vdupq_n_f32(pz);
+        float32x4_t sumX = zero, sumY = zero, sumZ = zero, sumW = zero;
+        alignas(16) float nxArray[4], nyArray[4], nzArray[4];
+        for (; i + 4 <= numNeighbors; i += 4) {
+            const uint32_t* n = neighborIndices + i;
+            for (int j = 0; j < 4; j++) {
+                nxArray[j] = pointsX[n[j]];
+                nyArray[j] = pointsY[n[j]];
+                nzArray[j] = pointsZ[n[j]];
+            }
+            float32x4_t nx = vld1q_f32(nxArray), ny = vld1q_f32(nyArray), nz = vld1q_f32(nzArray);
+            float32x4_t w = one;
+            if (useInverseDistanceWeights) {
+                float32x4_t dx = vsubq_f32(nx, pxs), dy = vsubq_f32(ny, pys), dz = vsubq_f32(nz, pzs);
+                float32x4_t squaredDistance = vaddq_f32(
+                        vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)), vmulq_f32(dz, dz));
+                uint32x4_t mask = vcgtq_f32(squaredDistance, zero);
+                float32x4_t distance = vsqrtq_f32(vbslq_f32(mask, squaredDistance, one));
+                w = vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(vdivq_f32(one, distance))));
+            }
+            sumX = vmlaq_f32(sumX, w, nx);
+            sumY = vmlaq_f32(sumY, w, ny);
+            sumZ = vmlaq_f32(sumZ, w, nz);
+            sumW = vaddq_f32(sumW, w);
+        }
+        pointSum = glm::vec3(vaddvq_f32(sumX), vaddvq_f32(sumY), vaddvq_f32(sumZ));
+        weightSum = vaddvq_f32(sumW);
+    }
+#endif
+
+    for (; i < numNeighbors; i++) {
+        uint32_t neighborIdx = neighborIndices[i];
+        glm::vec3 neighborPoint(pointsX[neighborIdx], pointsY[neighborIdx], pointsZ[neighborIdx]);
+        float w = 1.0f;
+        if (useInverseDistanceWeights) {
+            float dx = neighborPoint.x - px, dy = neighborPoint.y - py, dz = neighborPoint.z - pz;
+            float squaredDistance = dx * dx + dy * dy + dz * dz;
+            if (squaredDistance <= 0.0f) {
+                continue;
+            }
+            w = 1.0f / std::sqrt(squaredDistance);
+        }
+        pointSum += w * neighborPoint;
+        weightSum += w;
+    }
+}
+
+void smoothMesh(
+        const VertexAdjacency& adjacency, std::vector<glm::vec3>& vertexPositions,
+        const MeshSmoothingSettings& settings, const std::vector<uint8_t>* isVertexLockedVector) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositions.size();
+    if (adjacency.getNumVertices() != numVertices) {
+        sgl::Logfile::get()->writeError("Error in smoothMesh: The adjacency does not match the number of vertices.");
+        return;
+    }
+    if (isVertexLockedVector && isVertexLockedVector->size() != numVertices) {
+        sgl::Logfile::get()->writeError("Error in smoothMesh: The locked vertex list does not match the vertices.");
+        return;
+    }
+
+    // Structure of arrays (SoA) layout with double buffering.
+    std::vector<float> pointsArray(numVertices * 6);
+    float* pointsIn[3], *pointsOut[3];
+    for (size_t c = 0; c < 3; c++) {
+        pointsIn[c] = pointsArray.data() + c * numVertices;
+        pointsOut[c] = pointsArray.data() + (c + 3) * numVertices;
+    }
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, vertexPositions, pointsIn) default(none)
+#endif
+    for (size_t i = 0; i < numVertices; i++) {
+#endif
+        const glm::vec3& point = vertexPositions[i];
+        pointsIn[0][i] = point.x;
+        pointsIn[1][i] = point.y;
+        pointsIn[2][i] = point.z;
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    const uint32_t* offsets = adjacency.offsets.data();
+    const uint32_t* neighborIndices = adjacency.neighborIndices.data();
+    const uint8_t* isVertexLocked = isVertexLockedVector ? isVertexLockedVector->data() : nullptr;
+    const bool useInverseDistanceWeights = settings.useInverseDistanceWeights;
+    const bool isTaubin = settings.mu != 0.0f;
+    const int numPasses = isTaubin ? settings.numIterations * 2 : settings.numIterations;
+    for (int pass = 0; pass < numPasses; pass++) {
+        const float factor = isTaubin && pass % 2 == 1 ? settings.mu : settings.lambda;
+        float* const* in = pointsIn;
+        float* const* out = pointsOut;
+#ifdef USE_TBB
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+            for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+        #pragma omp parallel for shared(numVertices, in, out, offsets, neighborIndices, isVertexLocked) \
+        shared(useInverseDistanceWeights, factor) default(none)
+#endif
+        for (size_t i = 0; i < numVertices; i++) {
+#endif
+            glm::vec3 point(in[0][i], in[1][i], in[2][i]);
+            glm::vec3 pointSum;
+            float weightSum;
+            if (!isVertexLocked || !isVertexLocked[i]) {
+                computeNeighborSum(
+                        in[0], in[1], in[2], i, neighborIndices + offsets[i], offsets[i + 1] - offsets[i],
+                        useInverseDistanceWeights, pointSum, weightSum);
+                if (weightSum > 0.0f) {
+                    point += factor * (pointSum / weightSum - point);
+                }
+            }
+            out[0][i] = point.x;
+            out[1][i] = point.y;
+            out[2][i] = point.z;
+        }
+#ifdef USE_TBB
+        });
+#endif
+        std::swap(pointsIn, pointsOut);
+    }
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto i = r.begin(); i != r.end(); i++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, vertexPositions, pointsIn) default(none)
+#endif
+    for (size_t i = 0; i < numVertices; i++) {
+#endif
+        vertexPositions[i] = glm::vec3(pointsIn[0][i], pointsIn[1][i], pointsIn[2][i]);
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+void smoothMesh(
+        const std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        const MeshSmoothingSettings& settings) {
+    ZoneScoped;
 
-    if (numIterations % 2 == 1) {
-        vertexPositions = pointsTmp;
+    VertexAdjacency adjacency;
+    computeVertexAdjacency(triangleIndices, vertexPositions.size(), adjacency);
+    if (settings.lockBoundaryVertices || settings.featureAngle > 0.0f) {
+        std::vector<uint8_t> isVertexLocked;
+        computeLockedVertices(
+                triangleIndices, vertexPositions, settings.lockBoundaryVertices, settings.featureAngle,
+                isVertexLocked);
+        smoothMesh(adjacency, vertexPositions, settings, &isVertexLocked);
+    } else {
+        smoothMesh(adjacency, vertexPositions, settings);
     }
 }
 
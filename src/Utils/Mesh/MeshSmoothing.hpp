@@ -30,10 +30,13 @@
 #define SGL_MESHSMOOTHING_HPP
 
 #include <vector>
+#include <cstdint>
 #include <unordered_map>
 #include <unordered_set>
 #include <glm/vec3.hpp>
 
+#include "VertexAdjacency.hpp"
+
 namespace sgl {
 
 /**
@@ -41,6 +44,11 @@ namespace sgl {
  * https://graphics.stanford.edu/courses/cs468-12-spring/LectureSlides/06_smoothing.pdf
  */
 
+/*
+ * The overloads using a hash map of hash sets are kept for compatibility. For large meshes, the overloads using the
+ * compact CSR adjacency (@see computeVertexAdjacency) need an order of magnitude less memory and are parallelized.
+ */
+
 DLL_OBJECT void createNeighborMap(
         const std::vector<uint32_t>& triangleIndices,
         std::unordered_map<uint32_t, std::unordered_set<uint32_t>>& neighborsMap);
@@ -53,6 +61,66 @@ DLL_OBJECT void laplacianSmoothing(
         const std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
         int numIterations = 4, float lambda = 0.8f);
 
+DLL_OBJECT void laplacianSmoothing(
+        const std::vector<glm::vec3>& pointsIn, std::vector<glm::vec3>& pointsOut,
+        const VertexAdjacency& adjacency, float lambda = 0.8f);
+
+DLL_OBJECT void laplacianSmoothing(
+        const VertexAdjacency& adjacency, std::vector<glm::vec3>& vertexPositions,
+        int numIterations = 4, float lambda = 0.8f);
+
+/**
+ * Settings for the parallel smoothing engine (@see smoothMesh).
+ */
+struct DLL_OBJECT MeshSmoothingSettings {
+    int numIterations = 4;
+    /// Step size of the Laplacian smoothing pass (0 < lambda < 1).
+    float lambda = 0.8f;
+    /**
+     * If mu != 0, Taubin smoothing is used, i.e., every iteration consists of a shrinking pass with lambda followed by
+     * an inflating pass with mu < -lambda (e.g., lambda = 0.5, mu = -0.53). This avoids the shrinkage of the mesh.
+     * For more details see: G. Taubin, "A signal processing approach to fair surface design", SIGGRAPH 1995.
+     */
+    float mu = 0.0f;
+    /// Whether the neighbors are weighted by their inverse distance (like laplacianSmoothing) or uniformly.
+    bool useInverseDistanceWeights = true;
+    /// Whether to lock vertices on boundary edges. Only used by the overload of smoothMesh with triangle indices.
+    bool lockBoundaryVertices = false;
+    /// Vertices on edges with a dihedral angle above this angle (in radians) are locked if > 0. See above.
+    float featureAngle = 0.0f;
+};
+
+/**
+ * Marks vertices that should not be moved by smoothing (in parallel).
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param vertexPositions The vertex positions.
+ * @param lockBoundaryVertices Whether to lock vertices on edges used by only one triangle.
+ * @param featureAngle If > 0, vertices on edges with a dihedral angle above this angle (in radians) and on non-manifold
+ * edges are locked.
+ * @param isVertexLocked 1 for locked vertices, 0 otherwise (output).
+ */
+DLL_OBJECT void computeLockedVertices(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        bool lockBoundaryVertices, float featureAngle, std::vector<uint8_t>& isVertexLocked);
+
+/**
+ * Parallel Laplacian or Taubin smoothing engine. The positions are converted to a structure of arrays (SoA) layout,
+ * so the weights of four neighbors can be computed at once using SIMD instructions (SSE or NEON). Every vertex is
+ * updated independently from the positions of the previous pass, so the result does not depend on the number of
+ * threads.
+ * @param adjacency The vertex adjacency (@see computeVertexAdjacency).
+ * @param vertexPositions The vertex positions to smooth (input and output).
+ * @param settings The smoothing settings. lockBoundaryVertices and featureAngle are ignored by this overload.
+ * @param isVertexLocked Optional list of locked vertices (@see computeLockedVertices).
+ */
+DLL_OBJECT void smoothMesh(
+        const VertexAdjacency& adjacency, std::vector<glm::vec3>& vertexPositions,
+        const MeshSmoothingSettings& settings, const std::vector<uint8_t>* isVertexLocked = nullptr);
+
+DLL_OBJECT void smoothMesh(
+        const std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions,
+        const MeshSmoothingSettings& settings);
+
 }
 
 #endif //SGL_MESHSMOOTHING_HPP
@@ -0,0 +1,297 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include <glm/glm.hpp>
+#include <tracy/Tracy.hpp>
+
+#include "TriangleNormals.hpp"
+#include "Meshlets.hpp"
+
+namespace sgl {
+
+static const uint32_t INVALID_LOCAL_VERTEX_INDEX = 0xFFFFFFFFu;
+
+/**
+ * Computes an approximate bounding sphere using Ritter's algorithm.
+ */
+static void computeMeshletBoundingSphere(
+        const uint32_t* vertexIndices, uint32_t numVertices, const std::vector<glm::vec3>& vertexPositions,
+        glm::vec3& center, float& radius) {
+    // Start with the most distant pair of the points with minimal and maximal coordinates along the axes.
+    uint32_t minIndices[3] = { 0, 0, 0 }, maxIndices[3] = { 0, 0, 0 };
+    for (uint32_t i = 1; i < numVertices; i++) {
+        const glm::vec3& p = vertexPositions[vertexIndices[i]];
+        for (int c = 0; c < 3; c++) {
+            if (p[c] < vertexPositions[vertexIndices[minIndices[c]]][c]) {
+                minIndices[c] = i;
+            }
+            if (p[c] > vertexPositions[vertexIndices[maxIndices[c]]][c]) {
+                maxIndices[c] = i;
+            }
+        }
+    }
+    int bestAxis = 0;
+    float bestDistance = -1.0f;
+    for (int c = 0; c < 3; c++) {
+        float distance = glm::length(
+                vertexPositions[vertexIndices[maxIndices[c]]] - vertexPositions[vertexIndices[minIndices[c]]]);
+        if (distance > bestDistance) {
+            bestDistance = distance;
+            bestAxis = c;
+        }
+    }
+    const glm::vec3& p0 = vertexPositions[vertexIndices[minIndices[bestAxis]]];
+    const glm::vec3& p1 = vertexPositions[vertexIndices[maxIndices[bestAxis]]];
+    center = (p0 + p1) * 0.5f;
+    radius = bestDistance * 0.5f;
+
+    // Grow the sphere to contain all points.
+    for (uint32_t i = 0; i < numVertices; i++) {
+        const glm::vec3& p = vertexPositions[vertexIndices[i]];
+        float distance = glm::length(p - center);
+        if (distance > radius) {
+            float radiusNew = (radius + distance) * 0.5f;
+            center += (p - center) * ((radiusNew - radius) / distance);
+            radius = radiusNew;
+        }
+    }
+}
+
+static void computeMeshletBounds(
+        const Meshlet& meshlet, const MeshletData& meshletData, const std::vector<glm::vec3>& vertexPositions,
+        bool isFrontFaceCcw, MeshletBounds& bounds) {
+    const uint32_t* vertexIndices = meshletData.vertexIndices.data() + meshlet.vertexOffset;
+    const uint32_t* primitiveIndices = meshletData.primitiveIndices.data() + meshlet.primitiveOffset;
+    computeMeshletBoundingSphere(
+            vertexIndices, meshlet.numVertices, vertexPositions,
+            bounds.boundingSphereCenter, bounds.boundingSphereRadius);
+
+    // The normal cone axis is the normalized average of the triangle normals.
+    auto getTriangleVertex = [&](uint32_t primitiveIdx, int corner) -> const glm::vec3& {
+        return vertexPositions[vertexIndices[(primitiveIndices[primitiveIdx] >> (corner * 8)) & 0xFFu]];
+    };
+    auto getTriangleNormal = [&](uint32_t primitiveIdx) {
+        const glm::vec3& p0 = getTriangleVertex(primitiveIdx, 0);
+        glm::vec3 normal = glm::cross(getTriangleVertex(primitiveIdx, 1) - p0, getTriangleVertex(primitiveIdx, 2) - p0);
+        float normalLength = glm::length(normal);
+        normal = normalLength > 0.0f ? normal / normalLength : glm::vec3(0.0f);
+        return isFrontFaceCcw ? normal : -normal;
+    };
+    glm::vec3 normalSum(0.0f);
+    for (uint32_t primitiveIdx = 0; primitiveIdx < meshlet.numPrimitives; primitiveIdx++) {
+        normalSum += getTriangleNormal(primitiveIdx);
+    }
+    float normalSumLength = glm::length(normalSum);
+    if (normalSumLength <= 0.0f) {
+        bounds.coneApex = bounds.boundingSphereCenter;
+        bounds.coneAxis = glm::vec3(0.0f);
+        bounds.coneCutoff = 1.0f;
+        return;
+    }
+    glm::vec3 axis = normalSum / normalSumLength;
+
+    float minDot = 1.0f;
+    float maxApexOffset = 0.0f;
+    for (uint32_t primitiveIdx = 0; primitiveIdx < meshlet.numPrimitives; primitiveIdx++) {
+        glm::vec3 normal = getTriangleNormal(primitiveIdx);
+        if (normal == glm::vec3(0.0f)) {
+            continue;
+        }
+        float normalDotAxis = glm::dot(normal, axis);
+        minDot = std::min(minDot, normalDotAxis);
+        if (normalDotAxis > 0.0f) {
+            // Offset of the apex along the axis such that it lies behind the plane of the triangle.
+            float offset = glm::dot(bounds.boundingSphereCenter - getTriangleVertex(primitiveIdx, 0), normal);
+            maxApexOffset = std::max(maxApexOffset, offset / normalDotAxis);
+        }
+    }
+    bounds.coneAxis = axis;
+    if (minDot <= 0.1f) {
+        // The normals span more than a hemisphere (with some tolerance), so the meshlet can never be backface culled.
+        bounds.coneApex = bounds.boundingSphereCenter;
+        bounds.coneCutoff = 1.0f;
+    } else {
+        bounds.coneApex = bounds.boundingSphereCenter - axis * maxApexOffset;
+        bounds.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+
+void buildMeshlets(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const MeshletSettings& settings, MeshletData& meshletData) {
+    ZoneScoped;
+
+    meshletData.meshlets.clear();
+    meshletData.meshletBounds.clear();
+    meshletData.vertexIndices.clear();
+    meshletData.primitiveIndices.clear();
+    const uint32_t maxVertices = std::clamp(settings.maxVertices, 3u, 256u);
+    const uint32_t maxPrimitives = std::max(settings.maxPrimitives, 1u);
+    const size_t numTriangles = triangleIndices.size() / 3;
+    const size_t numVertices = vertexPositions.size();
+
+    VertexTriangleAdjacency adjacency;
+    computeVertexTriangleAdjacency(triangleIndices, numVertices, adjacency);
+    std::vector<uint8_t> isTriangleAssigned(numTriangles, 0);
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+        for (size_t j = 0; j < 3; j++) {
+            if (triangleIndices[triangleIdx * 3 + j] >= numVertices) {
+                isTriangleAssigned[triangleIdx] = 1;
+            }
+        }
+    }
+
+    std::vector<uint32_t> localVertexIndices(numVertices, INVALID_LOCAL_VERTEX_INDEX);
+    std::vector<uint32_t> candidateTriangles;
+    Meshlet meshlet;
+    auto flushMeshlet = [&]() {
+        if (meshlet.numPrimitives == 0) {
+            return;
+        }
+        for (uint32_t i = 0; i < meshlet.numVertices; i++) {
+            localVertexIndices[meshletData.vertexIndices[meshlet.vertexOffset + i]] = INVALID_LOCAL_VERTEX_INDEX;
+        }
+        meshletData.meshlets.push_back(meshlet);
+        meshlet = {};
+        meshlet.vertexOffset = uint32_t(meshletData.vertexIndices.size());
+        meshlet.primitiveOffset = uint32_t(meshletData.primitiveIndices.size());
+        candidateTriangles.clear();
+    };
+    auto getNumNewVertices = [&](size_t triangleIdx) {
+        uint32_t numNewVertices = 0;
+        for (size_t j = 0; j < 3; j++) {
+            uint32_t vertexIdx = triangleIndices[triangleIdx * 3 + j];
+            if (localVertexIndices[vertexIdx] == INVALID_LOCAL_VERTEX_INDEX) {
+                // Degenerate triangles may reference the same new vertex twice.
+                bool isDuplicate = false;
+                for (size_t k = 0; k < j; k++) {
+                    isDuplicate = isDuplicate || triangleIndices[triangleIdx * 3 + k] == vertexIdx;
+                }
+                numNewVertices += isDuplicate ? 0 : 1;
+            }
+        }
+        return numNewVertices;
+    };
+    auto addTriangle = [&](size_t triangleIdx) {
+        uint32_t packedIndices = 0;
+        for (size_t j = 0; j < 3; j++) {
+            uint32_t vertexIdx = triangleIndices[triangleIdx * 3 + j];
+            uint32_t& localVertexIdx = localVertexIndices[vertexIdx];
+            if (localVertexIdx == INVALID_LOCAL_VERTEX_INDEX) {
+                localVertexIdx = meshlet.numVertices++;
+                meshletData.vertexIndices.push_back(vertexIdx);
+                // The triangles adjacent to the new vertex become candidates.
+                for (uint32_t i = adjacency.offsets[vertexIdx]; i < adjacency.offsets[vertexIdx + 1]; i++) {
+                    uint32_t candidateIdx = adjacency.cornerIndices[i] / 3;
+                    if (!isTriangleAssigned[candidateIdx]) {
+                        candidateTriangles.push_back(candidateIdx);
+                    }
+                }
+            }
+            packedIndices |= localVertexIdx << (j * 8);
+        }
+        meshletData.primitiveIndices.push_back(packedIndices);
+        meshlet.numPrimitives++;
+        isTriangleAssigned[triangleIdx] = 1;
+    };
+
+    size_t seedCursor = 0;
+    while (true) {
+        if (meshlet.numPrimitives == 0) {
+            while (seedCursor < numTriangles && isTriangleAssigned[seedCursor]) {
+                seedCursor++;
+            }
+            if (seedCursor == numTriangles) {
+                break;
+            }
+            addTriangle(seedCursor);
+        } else {
+            // Select the adjacent triangle adding the least number of new vertices.
+            size_t bestTriangleIdx = numTriangles;
+            uint32_t bestNumNewVertices = 4;
+            size_t writeIdx = 0;
+            for (size_t readIdx = 0; readIdx < candidateTriangles.size(); readIdx++) {
+                uint32_t candidateIdx = candidateTriangles[readIdx];
+                if (isTriangleAssigned[candidateIdx]) {
+                    continue;
+                }
+                candidateTriangles[writeIdx++] = candidateIdx;
+                if (bestNumNewVertices == 0) {
+                    continue;
+                }
+                uint32_t numNewVertices = getNumNewVertices(candidateIdx);
+                if (numNewVertices < bestNumNewVertices) {
+                    bestNumNewVertices = numNewVertices;
+                    bestTriangleIdx = candidateIdx;
+                }
+            }
+            candidateTriangles.resize(writeIdx);
+            if (bestTriangleIdx == numTriangles || meshlet.numVertices + bestNumNewVertices > maxVertices) {
+                // The meshlet is full, or there are no more adjacent triangles.
+                flushMeshlet();
+                continue;
+            }
+            addTriangle(bestTriangleIdx);
+        }
+        if (meshlet.numPrimitives == maxPrimitives) {
+            flushMeshlet();
+        }
+    }
+    flushMeshlet();
+
+    const size_t numMeshlets = meshletData.meshlets.size();
+    meshletData.meshletBounds.resize(numMeshlets);
+    const bool isFrontFaceCcw = settings.isFrontFaceCcw;
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numMeshlets), [&](auto const& r) {
+        for (auto meshletIdx = r.begin(); meshletIdx != r.end(); meshletIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numMeshlets, meshletData, vertexPositions, isFrontFaceCcw) default(none)
+#endif
+    for (size_t meshletIdx = 0; meshletIdx < numMeshlets; meshletIdx++) {
+#endif
+        computeMeshletBounds(
+                meshletData.meshlets[meshletIdx], meshletData, vertexPositions, isFrontFaceCcw,
+                meshletData.meshletBounds[meshletIdx]);
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+}
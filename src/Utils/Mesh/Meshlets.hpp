@@ -0,0 +1,106 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_MESHLETS_HPP
+#define SGL_MESHLETS_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/vec3.hpp>
+
+namespace sgl {
+
+/**
+ * Settings for @see buildMeshlets. The limits can be queried from the device using sgl::vk::getMeshletSettings.
+ */
+struct DLL_OBJECT MeshletSettings {
+    /// Maximum number of vertices per meshlet (at most 256, as the local primitive indices use 8 bits).
+    uint32_t maxVertices = 64;
+    /// Maximum number of primitives (i.e., triangles) per meshlet.
+    uint32_t maxPrimitives = 126;
+    /// Whether front faces are counter-clockwise (like GraphicsPipelineInfo::setIsFrontFaceCcw) for the normal cones.
+    bool isFrontFaceCcw = true;
+};
+
+/**
+ * A meshlet references the ranges [vertexOffset, vertexOffset + numVertices) of MeshletData::vertexIndices and
+ * [primitiveOffset, primitiveOffset + numPrimitives) of MeshletData::primitiveIndices. The layout matches a std430
+ * struct of four uints.
+ */
+struct DLL_OBJECT Meshlet {
+    uint32_t vertexOffset = 0;
+    uint32_t numVertices = 0;
+    uint32_t primitiveOffset = 0;
+    uint32_t numPrimitives = 0;
+};
+
+/**
+ * Culling data of a meshlet. The layout matches a std430 struct of three vec4s.
+ * - Frustum/occlusion culling: The bounding sphere contains all vertices of the meshlet.
+ * - Backface culling: The meshlet is invisible if dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff.
+ *   For meshlets with normals spread too much, coneCutoff is 1 (i.e., the test never succeeds).
+ */
+struct DLL_OBJECT MeshletBounds {
+    glm::vec3 boundingSphereCenter{};
+    float boundingSphereRadius = 0.0f;
+    glm::vec3 coneApex{};
+    float coneCutoff = 1.0f;
+    glm::vec3 coneAxis{};
+    float padding = 0.0f;
+};
+
+/**
+ * The output of the meshlet builder, ready for upload to storage buffers (@see sgl::vk::MeshletBuffers).
+ */
+struct DLL_OBJECT MeshletData {
+    std::vector<Meshlet> meshlets;
+    std::vector<MeshletBounds> meshletBounds;
+    /// Global vertex indices of the local vertices of all meshlets.
+    std::vector<uint32_t> vertexIndices;
+    /// Local vertex indices of the triangles of all meshlets, packed as i0 | (i1 << 8) | (i2 << 16).
+    std::vector<uint32_t> primitiveIndices;
+};
+
+/**
+ * Builds meshlets for the passed triangle mesh. Meshlets are grown greedily from a seed triangle by adding adjacent
+ * triangles that introduce the least number of new vertices, until a limit is reached. It is recommended to
+ * optimize the triangle order for the vertex cache first (@see optimizeVertexCache), as the seeds are selected in the
+ * order of the triangles. The bounding spheres and normal cones are computed in parallel.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param vertexPositions The vertex positions.
+ * @param settings The meshlet size limits.
+ * @param meshletData The output meshlet data.
+ */
+DLL_OBJECT void buildMeshlets(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const MeshletSettings& settings, MeshletData& meshletData);
+
+}
+
+#endif //SGL_MESHLETS_HPP
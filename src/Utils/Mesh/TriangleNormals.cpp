@@ -26,36 +26,254 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SGL_TRIANGLE_NORMALS_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SGL_TRIANGLE_NORMALS_NEON
+#endif
+
 #include <glm/glm.hpp>
+#include <tracy/Tracy.hpp>
 
+#include <Utils/Parallel/RadixSort.hpp>
 #include "TriangleNormals.hpp"
 
 namespace sgl {
 
-void computeSmoothTriangleNormals(
-        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
-        std::vector<glm::vec3>& vertexNormals) {
-    vertexNormals.resize(vertexPositions.size(), glm::vec3(0.0f));
+void computeVertexTriangleAdjacency(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, VertexTriangleAdjacency& adjacency) {
+    ZoneScoped;
+
+    // Corners of triangles with invalid indices get the key numVertices, so they are sorted to the end and dropped.
+    // Otherwise, they would alias valid vertices, as only the lower numKeyBits bits of the keys are sorted.
+    const size_t numTriangles = triangleIndices.size() / 3;
+    const size_t numCorners = numTriangles * 3;
+    const uint32_t invalidKey = uint32_t(std::min(numVertices, size_t(std::numeric_limits<uint32_t>::max())));
+    std::vector<uint32_t> sortedVertexIndices(numCorners);
+    std::vector<uint32_t>& cornerIndices = adjacency.cornerIndices;
+    cornerIndices.resize(numCorners);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numTriangles), [&](auto const& r) {
+        for (auto triangleIdx = r.begin(); triangleIdx != r.end(); triangleIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numTriangles, triangleIndices, numVertices, invalidKey) \
+    shared(sortedVertexIndices, cornerIndices) default(none)
+#endif
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+#endif
+        const size_t triangleStart = triangleIdx * 3;
+        bool isValid =
+                triangleIndices[triangleStart] < numVertices && triangleIndices[triangleStart + 1] < numVertices
+                && triangleIndices[triangleStart + 2] < numVertices;
+        for (size_t i = triangleStart; i < triangleStart + 3; i++) {
+            sortedVertexIndices[i] = isValid ? triangleIndices[i] : invalidKey;
+            cornerIndices[i] = uint32_t(i);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    // The radix sort is stable, so the corners of every vertex stay in ascending order.
+    int numKeyBits = 1;
+    while (numKeyBits < 32 && (size_t(1) << numKeyBits) <= size_t(invalidKey)) {
+        numKeyBits++;
+    }
+    radixSortKeyValuePairs(sortedVertexIndices, cornerIndices, numKeyBits);
+    const size_t numValidCorners = size_t(
+            std::lower_bound(sortedVertexIndices.begin(), sortedVertexIndices.end(), invalidKey)
+            - sortedVertexIndices.begin());
+    sortedVertexIndices.resize(numValidCorners);
+    cornerIndices.resize(numValidCorners);
 
-    for (size_t i = 0; i < triangleIndices.size(); i += 3) {
-        uint32_t vertexIndex0 = triangleIndices.at(i);
-        uint32_t vertexIndex1 = triangleIndices.at(i+1);
-        uint32_t vertexIndex2 = triangleIndices.at(i+2);
+    std::vector<uint32_t>& offsets = adjacency.offsets;
+    offsets.resize(numVertices + 1);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices + 1), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, sortedVertexIndices, offsets) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx <= numVertices; vertexIdx++) {
+#endif
+        offsets[vertexIdx] = uint32_t(std::lower_bound(
+                sortedVertexIndices.begin(), sortedVertexIndices.end(), uint32_t(vertexIdx))
+                - sortedVertexIndices.begin());
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
 
-        const glm::vec3& vertexPosition0 = vertexPositions.at(vertexIndex0);
-        const glm::vec3& vertexPosition1 = vertexPositions.at(vertexIndex1);
-        const glm::vec3& vertexPosition2 = vertexPositions.at(vertexIndex2);
+/**
+ * Computes the (unnormalized) face normals of the triangles [triangleStart, triangleStart + 4) using SIMD, i.e., the
+ * positions are transposed to a structure of arrays (SoA) layout and four cross products are computed at once.
+ */
+static void computeFaceNormalsBatch(
+        const uint32_t* triangleIndices, const glm::vec3* vertexPositions, size_t triangleStart,
+        glm::vec3* faceNormals) {
+    alignas(16) float edge0[3][4];
+    alignas(16) float edge1[3][4];
+    for (size_t i = 0; i < 4; i++) {
+        const uint32_t* indices = triangleIndices + (triangleStart + i) * 3;
+        const glm::vec3& p0 = vertexPositions[indices[0]];
+        const glm::vec3& p1 = vertexPositions[indices[1]];
+        const glm::vec3& p2 = vertexPositions[indices[2]];
+        for (int c = 0; c < 3; c++) {
+            edge0[c][i] = p2[c] - p0[c];
+            edge1[c][i] = p1[c] - p0[c];
+        }
+    }
 
-        glm::vec3 triangleNormal = glm::cross(vertexPosition2 - vertexPosition0, vertexPosition1 - vertexPosition0);
-        vertexNormals.at(vertexIndex0) += triangleNormal;
-        vertexNormals.at(vertexIndex1) += triangleNormal;
-        vertexNormals.at(vertexIndex2) += triangleNormal;
+    alignas(16) float normal[3][4];
+#if defined(SGL_TRIANGLE_NORMALS_SSE)
+    __m128 e0x = _mm_load_ps(edge0[0]), e0y = _mm_load_ps(edge0[1]), e0z = _mm_load_ps(edge0[2]);
+    __m128 e1x = _mm_load_ps(edge1[0]), e1y = _mm_load_ps(edge1[1]), e1z = _mm_load_ps(edge1[2]);
+    _mm_store_ps(normal[0], _mm_sub_ps(_mm_mul_ps(e0y, e1z), _mm_mul_ps(e0z, e1y)));
+    _mm_store_ps(normal[1], _mm_sub_ps(_mm_mul_ps(e0z, e1x), _mm_mul_ps(e0x, e1z)));
+    _mm_store_ps(normal[2], _mm_sub_ps(_mm_mul_ps(e0x, e1y), _mm_mul_ps(e0y, e1x)));
+#elif defined(SGL_TRIANGLE_NORMALS_NEON)
+    float32x4_t e0x = vld1q_f32(edge0[0]), e0y = vld1q_f32(edge0[1]), e0z = vld1q_f32(edge0[2]);
+    float32x4_t e1x = vld1q_f32(edge1[0]), e1y = vld1q_f32(edge1[1]), e1z = vld1q_f32(edge1[2]);
+    vst1q_f32(normal[0], vsubq_f32(vmulq_f32(e0y, e1z), vmulq_f32(e0z, e1y)));
+    vst1q_f32(normal[1], vsubq_f32(vmulq_f32(e0z, e1x), vmulq_f32(e0x, e1z)));
+    vst1q_f32(normal[2], vsubq_f32(vmulq_f32(e0x, e1y), vmulq_f32(e0y, e1x)));
+#else
+    for (size_t i = 0; i < 4; i++) {
+        normal[0][i] = edge0[1][i] * edge1[2][i] - edge0[2][i] * edge1[1][i];
+        normal[1][i] = edge0[2][i] * edge1[0][i] - edge0[0][i] * edge1[2][i];
+        normal[2][i] = edge0[0][i] * edge1[1][i] - edge0[1][i] * edge1[0][i];
     }
+#endif
 
-    for (size_t i = 0; i < vertexNormals.size(); i++) {
-        glm::vec3& vertexNormal = vertexNormals.at(i);
-        vertexNormal = glm::normalize(vertexNormal);
+    for (size_t i = 0; i < 4; i++) {
+        faceNormals[triangleStart + i] = glm::vec3(normal[0][i], normal[1][i], normal[2][i]);
     }
 }
 
+static inline float computeCornerAngle(
+        const uint32_t* triangleIndices, const glm::vec3* vertexPositions, uint32_t cornerIdx) {
+    uint32_t triangleStart = cornerIdx - cornerIdx % 3;
+    const glm::vec3& p = vertexPositions[triangleIndices[cornerIdx]];
+    const glm::vec3& pNext = vertexPositions[triangleIndices[triangleStart + (cornerIdx + 1) % 3]];
+    const glm::vec3& pPrev = vertexPositions[triangleIndices[triangleStart + (cornerIdx + 2) % 3]];
+    glm::vec3 edge0 = pNext - p;
+    glm::vec3 edge1 = pPrev - p;
+    float lengthProduct = std::sqrt(glm::dot(edge0, edge0) * glm::dot(edge1, edge1));
+    if (lengthProduct <= 0.0f) {
+        return 0.0f;
+    }
+    return std::acos(glm::clamp(glm::dot(edge0, edge1) / lengthProduct, -1.0f, 1.0f));
+}
+
+void computeSmoothTriangleNormals(
+        const std::vector<uint32_t>& triangleIndicesVector, const std::vector<glm::vec3>& vertexPositionsVector,
+        const VertexTriangleAdjacency& adjacency, std::vector<glm::vec3>& vertexNormals,
+        NormalWeighting weighting) {
+    ZoneScoped;
+
+    const size_t numVertices = vertexPositionsVector.size();
+    const size_t numTriangles = triangleIndicesVector.size() / 3;
+    const uint32_t* triangleIndices = triangleIndicesVector.data();
+    const glm::vec3* vertexPositions = vertexPositionsVector.data();
+    vertexNormals.resize(numVertices);
+
+    // 1. Compute the face normals (four triangles at a time). For non-area weighting, the normals are normalized.
+    std::vector<glm::vec3> faceNormals(numTriangles);
+    const size_t numBatches = (numTriangles + 3) / 4;
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBatches), [&](auto const& r) {
+        for (auto batchIdx = r.begin(); batchIdx != r.end(); batchIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numBatches, numTriangles, numVertices, triangleIndices, vertexPositions) \
+    shared(faceNormals, weighting) default(none)
+#endif
+    for (size_t batchIdx = 0; batchIdx < numBatches; batchIdx++) {
+#endif
+        size_t triangleStart = batchIdx * 4;
+        size_t triangleEnd = std::min(triangleStart + 4, numTriangles);
+        bool isBatchValid = true;
+        for (size_t i = triangleStart * 3; i < triangleEnd * 3; i++) {
+            isBatchValid = isBatchValid && triangleIndices[i] < numVertices;
+        }
+        if (triangleEnd - triangleStart == 4 && isBatchValid) {
+            computeFaceNormalsBatch(triangleIndices, vertexPositions, triangleStart, faceNormals.data());
+        } else {
+            for (size_t triangleIdx = triangleStart; triangleIdx < triangleEnd; triangleIdx++) {
+                const uint32_t* indices = triangleIndices + triangleIdx * 3;
+                if (indices[0] >= numVertices || indices[1] >= numVertices || indices[2] >= numVertices) {
+                    // Not part of the adjacency, so the normal is never gathered.
+                    faceNormals[triangleIdx] = glm::vec3(0.0f);
+                    continue;
+                }
+                const glm::vec3& p0 = vertexPositions[triangleIndices[triangleIdx * 3]];
+                const glm::vec3& p1 = vertexPositions[triangleIndices[triangleIdx * 3 + 1]];
+                const glm::vec3& p2 = vertexPositions[triangleIndices[triangleIdx * 3 + 2]];
+                faceNormals[triangleIdx] = glm::cross(p2 - p0, p1 - p0);
+            }
+        }
+        if (weighting != NormalWeighting::AREA) {
+            for (size_t triangleIdx = triangleStart; triangleIdx < triangleEnd; triangleIdx++) {
+                glm::vec3& faceNormal = faceNormals[triangleIdx];
+                float normalLength = glm::length(faceNormal);
+                faceNormal = normalLength > 0.0f ? faceNormal / normalLength : glm::vec3(0.0f);
+            }
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    // 2. Gather the face normals per vertex.
+    const uint32_t* offsets = adjacency.offsets.data();
+    const uint32_t* cornerIndices = adjacency.cornerIndices.data();
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, triangleIndices, vertexPositions, offsets, cornerIndices) \
+    shared(faceNormals, vertexNormals, weighting) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+#endif
+        glm::vec3 vertexNormal(0.0f);
+        for (uint32_t i = offsets[vertexIdx]; i < offsets[vertexIdx + 1]; i++) {
+            uint32_t cornerIdx = cornerIndices[i];
+            const glm::vec3& faceNormal = faceNormals[cornerIdx / 3];
+            if (weighting == NormalWeighting::ANGLE) {
+                vertexNormal += computeCornerAngle(triangleIndices, vertexPositions, cornerIdx) * faceNormal;
+            } else {
+                vertexNormal += faceNormal;
+            }
+        }
+        float normalLength = glm::length(vertexNormal);
+        vertexNormals[vertexIdx] = normalLength > 0.0f ? vertexNormal / normalLength : glm::vec3(0.0f);
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+void computeSmoothTriangleNormals(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        std::vector<glm::vec3>& vertexNormals, NormalWeighting weighting) {
+    VertexTriangleAdjacency adjacency;
+    computeVertexTriangleAdjacency(triangleIndices, vertexPositions.size(), adjacency);
+    computeSmoothTriangleNormals(triangleIndices, vertexPositions, adjacency, vertexNormals, weighting);
+}
+
 }
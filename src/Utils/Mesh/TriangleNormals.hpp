@@ -30,20 +30,68 @@
 #define SGL_TRIANGLENORMALS_HPP
 
 #include <vector>
+#include <cstdint>
 
 #include <glm/vec3.hpp>
 
 namespace sgl {
 
+/**
+ * Weighting of the face normals of the triangles adjacent to a vertex when computing smooth vertex normals.
+ * - UNIFORM: All adjacent triangles contribute equally.
+ * - AREA: The contribution is proportional to the triangle area.
+ * - ANGLE: The contribution is proportional to the interior angle of the triangle at the vertex.
+ */
+enum class NormalWeighting {
+    UNIFORM, AREA, ANGLE
+};
+
+/**
+ * Vertex-to-triangle adjacency in compressed sparse row (CSR) format. The triangle corners adjacent to vertex i are
+ * stored in cornerIndices[offsets[i]] ... cornerIndices[offsets[i + 1] - 1] in ascending order. A corner index c
+ * refers to the entry c of the triangle index buffer, i.e., corner c % 3 of triangle c / 3.
+ * It only depends on the topology, so it can be reused for multiple calls, e.g., for animated meshes.
+ */
+struct DLL_OBJECT VertexTriangleAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> cornerIndices;
+};
+
+/**
+ * Computes the vertex-to-triangle adjacency for the passed triangle data (in parallel). Triangles with indices
+ * >= numVertices are not part of the adjacency.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param numVertices The number of vertices.
+ * @param adjacency The output adjacency.
+ */
+DLL_OBJECT void computeVertexTriangleAdjacency(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, VertexTriangleAdjacency& adjacency);
+
+/**
+ * Computes smooth normals for the passed triangle data (in parallel). The face normals of all adjacent triangles are
+ * gathered per vertex in a fixed order, so the result is deterministic and independent of the number of threads.
+ * Vertices not referenced by any triangle get a zero normal. Triangles with invalid indices are ignored.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param vertexPositions The vertex positions.
+ * @param adjacency The vertex-to-triangle adjacency (@see computeVertexTriangleAdjacency).
+ * @param vertexNormals The output vertex normals.
+ * @param weighting The weighting of the face normals.
+ */
+DLL_OBJECT void computeSmoothTriangleNormals(
+        const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
+        const VertexTriangleAdjacency& adjacency, std::vector<glm::vec3>& vertexNormals,
+        NormalWeighting weighting = NormalWeighting::AREA);
+
 /**
  * Computes smooth normals for the passed triangle data.
  * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
  * @param vertexPositions The vertex positions.
  * @param vertexNormals The output vertex normals.
+ * @param weighting The weighting of the face normals.
  */
 DLL_OBJECT void computeSmoothTriangleNormals(
         const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertexPositions,
-        std::vector<glm::vec3>& vertexNormals);
+        std::vector<glm::vec3>& vertexNormals, NormalWeighting weighting = NormalWeighting::AREA);
 
 }
 
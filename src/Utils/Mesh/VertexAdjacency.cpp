@@ -0,0 +1,149 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include <tracy/Tracy.hpp>
+
+#include <Utils/Parallel/RadixSort.hpp>
+#include <Utils/Parallel/PrefixSum.hpp>
+#include "VertexAdjacency.hpp"
+
+namespace sgl {
+
+void computeVertexAdjacency(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, VertexAdjacency& adjacency) {
+    ZoneScoped;
+
+    int numVertexBits = 1;
+    while (numVertexBits < 32 && (size_t(1) << numVertexBits) < numVertices) {
+        numVertexBits++;
+    }
+    const uint64_t vertexMask = (uint64_t(1) << numVertexBits) - 1;
+
+    // 1. Emit both directions of all three edges of every triangle as (source, target) keys.
+    // Self-loops of degenerate triangles and edges with invalid indices are mapped to an invalid key.
+    const size_t numTriangles = triangleIndices.size() / 3;
+    const uint64_t invalidKey =
+            numVertexBits == 32 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << (2 * numVertexBits)) - 1;
+    std::vector<uint64_t> edgeKeys(numTriangles * 6);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numTriangles), [&](auto const& r) {
+        for (auto triangleIdx = r.begin(); triangleIdx != r.end(); triangleIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numTriangles, triangleIndices, edgeKeys, numVertices, numVertexBits, invalidKey) \
+    default(none)
+#endif
+    for (size_t triangleIdx = 0; triangleIdx < numTriangles; triangleIdx++) {
+#endif
+        for (size_t i = 0; i < 3; i++) {
+            uint32_t idx0 = triangleIndices[triangleIdx * 3 + i];
+            uint32_t idx1 = triangleIndices[triangleIdx * 3 + (i + 1) % 3];
+            bool isValid = idx0 != idx1 && idx0 < numVertices && idx1 < numVertices;
+            edgeKeys[triangleIdx * 6 + i * 2] =
+                    isValid ? (uint64_t(idx0) << numVertexBits) | uint64_t(idx1) : invalidKey;
+            edgeKeys[triangleIdx * 6 + i * 2 + 1] =
+                    isValid ? (uint64_t(idx1) << numVertexBits) | uint64_t(idx0) : invalidKey;
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+    radixSortKeys(edgeKeys, 2 * numVertexBits);
+    // The invalid keys are sorted to the end.
+    const size_t numEdges = size_t(
+            std::lower_bound(edgeKeys.begin(), edgeKeys.end(), invalidKey) - edgeKeys.begin());
+
+    // 2. Remove duplicate edges; the output position of every unique edge is the number of unique edges before it.
+    std::vector<uint32_t> edgeOutputIndices(numEdges);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numEdges), [&](auto const& r) {
+        for (auto edgeIdx = r.begin(); edgeIdx != r.end(); edgeIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numEdges, edgeKeys, edgeOutputIndices) default(none)
+#endif
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+#endif
+        edgeOutputIndices[edgeIdx] = edgeIdx == 0 || edgeKeys[edgeIdx] != edgeKeys[edgeIdx - 1] ? 1 : 0;
+    }
+#ifdef USE_TBB
+    });
+#endif
+    uint32_t numUniqueEdges = exclusivePrefixSum(edgeOutputIndices);
+
+    std::vector<uint32_t>& neighborIndices = adjacency.neighborIndices;
+    neighborIndices.resize(numUniqueEdges);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numEdges), [&](auto const& r) {
+        for (auto edgeIdx = r.begin(); edgeIdx != r.end(); edgeIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numEdges, edgeKeys, edgeOutputIndices, neighborIndices, vertexMask) default(none)
+#endif
+    for (size_t edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+#endif
+        if (edgeIdx == 0 || edgeKeys[edgeIdx] != edgeKeys[edgeIdx - 1]) {
+            neighborIndices[edgeOutputIndices[edgeIdx]] = uint32_t(edgeKeys[edgeIdx] & vertexMask);
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    // 3. The neighbors of a vertex start at its first edge in the sorted edge list.
+    std::vector<uint32_t>& offsets = adjacency.offsets;
+    offsets.resize(numVertices + 1);
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numVertices + 1), [&](auto const& r) {
+        for (auto vertexIdx = r.begin(); vertexIdx != r.end(); vertexIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, numEdges, numVertexBits, edgeKeys, edgeOutputIndices, offsets) \
+    shared(numUniqueEdges) default(none)
+#endif
+    for (size_t vertexIdx = 0; vertexIdx <= numVertices; vertexIdx++) {
+#endif
+        auto it = std::lower_bound(
+                edgeKeys.begin(), edgeKeys.begin() + ptrdiff_t(numEdges), uint64_t(vertexIdx) << numVertexBits);
+        size_t edgeIdx = size_t(it - edgeKeys.begin());
+        offsets[vertexIdx] = edgeIdx < numEdges ? edgeOutputIndices[edgeIdx] : numUniqueEdges;
+    }
+#ifdef USE_TBB
+    });
+#endif
+}
+
+}
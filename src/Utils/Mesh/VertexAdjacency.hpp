@@ -0,0 +1,69 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_VERTEXADJACENCY_HPP
+#define SGL_VERTEXADJACENCY_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace sgl {
+
+/**
+ * Vertex-to-vertex adjacency (i.e., the one-ring neighborhood of the vertices) in compressed sparse row (CSR) format.
+ * The neighbors of vertex i are stored in neighborIndices[offsets[i]] ... neighborIndices[offsets[i + 1] - 1] in
+ * ascending order. Compared to a hash map of hash sets, this needs only 4 bytes per vertex and 4 bytes per directed
+ * edge, and neighboring vertices are stored contiguously.
+ */
+struct DLL_OBJECT VertexAdjacency {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> neighborIndices;
+
+    [[nodiscard]] inline size_t getNumVertices() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+    [[nodiscard]] inline uint32_t getNumNeighbors(size_t vertexIdx) const {
+        return offsets[vertexIdx + 1] - offsets[vertexIdx];
+    }
+    [[nodiscard]] inline const uint32_t* getNeighbors(size_t vertexIdx) const {
+        return neighborIndices.data() + offsets[vertexIdx];
+    }
+};
+
+/**
+ * Computes the vertex adjacency for the passed triangle data (in parallel). The edges of all triangles are sorted with
+ * a parallel radix sort, and duplicate edges are removed using a parallel prefix sum.
+ * @param triangleIndices A list of triangle indices. Three consecutive entries form one triangle.
+ * @param numVertices The number of vertices. Indices >= numVertices are ignored.
+ * @param adjacency The output adjacency.
+ */
+DLL_OBJECT void computeVertexAdjacency(
+        const std::vector<uint32_t>& triangleIndices, size_t numVertices, VertexAdjacency& adjacency);
+
+}
+
+#endif //SGL_VERTEXADJACENCY_HPP
@@ -0,0 +1,102 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_MPSCQUEUE_HPP
+#define SGL_MPSCQUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+namespace sgl {
+
+/**
+ * Unbounded lock-free multi-producer single-consumer queue (cf. D. Vyukov's intrusive MPSC node-based queue).
+ * push may be called concurrently by any number of threads, while tryPop may only be called by one consumer thread at
+ * a time. Producers never wait for each other or for the consumer; an element becomes visible to the consumer as soon
+ * as the producers that pushed before it have finished their push.
+ */
+template<class T>
+class MpscQueue {
+public:
+    MpscQueue() {
+        Node* stubNode = new Node;
+        head.store(stubNode, std::memory_order_relaxed);
+        tail = stubNode;
+    }
+
+    ~MpscQueue() {
+        while (tail) {
+            Node* next = tail->next.load(std::memory_order_relaxed);
+            delete tail;
+            tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    /// Can be called by multiple threads concurrently.
+    void push(T value) {
+        Node* node = new Node;
+        node->value = std::move(value);
+        Node* previousHead = head.exchange(node, std::memory_order_acq_rel);
+        previousHead->next.store(node, std::memory_order_release);
+    }
+
+    /// May only be called by the consumer thread. Returns false if the queue is empty.
+    bool tryPop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        // 'next' becomes the new stub node.
+        value = std::move(next->value);
+        next->value = T();
+        delete tail;
+        tail = next;
+        return true;
+    }
+
+    /// May only be called by the consumer thread.
+    [[nodiscard]] bool empty() const {
+        return tail->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        T value{};
+    };
+
+    alignas(64) std::atomic<Node*> head;
+    alignas(64) Node* tail;
+};
+
+}
+
+#endif //SGL_MPSCQUEUE_HPP
@@ -0,0 +1,120 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include "PrefixSum.hpp"
+
+namespace sgl {
+
+/// Below this number of elements, the prefix sum is computed serially.
+static const size_t PREFIX_SUM_BLOCK_SIZE = 1 << 16;
+
+template<class T>
+static T exclusivePrefixSumImpl(const T* input, T* output, size_t N) {
+    if (N <= PREFIX_SUM_BLOCK_SIZE) {
+        T sum = 0;
+        for (size_t i = 0; i < N; i++) {
+            T value = input[i];
+            output[i] = sum;
+            sum += value;
+        }
+        return sum;
+    }
+
+    // 1. Compute the sum of each block in parallel. 2. Scan the block sums. 3. Scan each block in parallel.
+    const size_t numBlocks = (N + PREFIX_SUM_BLOCK_SIZE - 1) / PREFIX_SUM_BLOCK_SIZE;
+    std::vector<T> blockSums(numBlocks);
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(input, N, numBlocks, blockSums) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t blockStart = blockIdx * PREFIX_SUM_BLOCK_SIZE;
+        size_t blockEnd = std::min(blockStart + PREFIX_SUM_BLOCK_SIZE, N);
+        T sum = 0;
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            sum += input[i];
+        }
+        blockSums[blockIdx] = sum;
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    T totalSum = 0;
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        T blockSum = blockSums[blockIdx];
+        blockSums[blockIdx] = totalSum;
+        totalSum += blockSum;
+    }
+
+#ifdef USE_TBB
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+        for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(input, output, N, numBlocks, blockSums) default(none)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+        size_t blockStart = blockIdx * PREFIX_SUM_BLOCK_SIZE;
+        size_t blockEnd = std::min(blockStart + PREFIX_SUM_BLOCK_SIZE, N);
+        T sum = blockSums[blockIdx];
+        for (size_t i = blockStart; i < blockEnd; i++) {
+            T value = input[i];
+            output[i] = sum;
+            sum += value;
+        }
+    }
+#ifdef USE_TBB
+    });
+#endif
+
+    return totalSum;
+}
+
+uint32_t exclusivePrefixSum(const uint32_t* input, uint32_t* output, size_t N) {
+    return exclusivePrefixSumImpl(input, output, N);
+}
+
+uint64_t exclusivePrefixSum(const uint64_t* input, uint64_t* output, size_t N) {
+    return exclusivePrefixSumImpl(input, output, N);
+}
+
+}
@@ -0,0 +1,164 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <array>
+
+#ifdef USE_TBB
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#endif
+
+#include "RadixSort.hpp"
+
+namespace sgl {
+
+static const int RADIX_BITS = 8;
+static const size_t RADIX_NUM_BUCKETS = size_t(1) << RADIX_BITS;
+/// Number of elements per block; every block has its own histogram.
+static const size_t RADIX_SORT_BLOCK_SIZE = 1 << 16;
+
+/// If HasValues is false, values is ignored and only the keys are sorted.
+template<class KeyType, bool HasValues>
+static void radixSortKeyValuePairsImpl(std::vector<KeyType>& keys, std::vector<uint32_t>& values, int numKeyBits) {
+    const size_t N = keys.size();
+    if (N <= 1) {
+        return;
+    }
+    numKeyBits = std::min(numKeyBits, int(sizeof(KeyType) * 8));
+    const int numPasses = (numKeyBits + RADIX_BITS - 1) / RADIX_BITS;
+    const size_t numBlocks = (N + RADIX_SORT_BLOCK_SIZE - 1) / RADIX_SORT_BLOCK_SIZE;
+
+    std::vector<KeyType> keysTmp(N);
+    std::vector<uint32_t> valuesTmp(HasValues ? N : 0);
+    KeyType* keysSrc = keys.data();
+    KeyType* keysDst = keysTmp.data();
+    uint32_t* valuesSrc = values.data();
+    uint32_t* valuesDst = valuesTmp.data();
+    std::vector<std::array<size_t, RADIX_NUM_BUCKETS>> blockOffsets(numBlocks);
+
+    for (int pass = 0; pass < numPasses; pass++) {
+        const int shift = pass * RADIX_BITS;
+
+        // Count the digits of each block.
+#ifdef USE_TBB
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+            for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+        #pragma omp parallel for shared(keysSrc, N, numBlocks, blockOffsets, shift) default(none)
+#endif
+        for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+            std::array<size_t, RADIX_NUM_BUCKETS>& histogram = blockOffsets[blockIdx];
+            histogram.fill(0);
+            size_t blockStart = blockIdx * RADIX_SORT_BLOCK_SIZE;
+            size_t blockEnd = std::min(blockStart + RADIX_SORT_BLOCK_SIZE, N);
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                histogram[(keysSrc[i] >> shift) & (RADIX_NUM_BUCKETS - 1)]++;
+            }
+        }
+#ifdef USE_TBB
+        });
+#endif
+
+        // Compute the output offsets of the digits of each block (digit-major, then block order for stability).
+        size_t offset = 0;
+        bool isPassTrivial = false;
+        for (size_t digit = 0; digit < RADIX_NUM_BUCKETS; digit++) {
+            size_t digitCount = 0;
+            for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+                size_t count = blockOffsets[blockIdx][digit];
+                blockOffsets[blockIdx][digit] = offset;
+                offset += count;
+                digitCount += count;
+            }
+            if (digitCount == N) {
+                isPassTrivial = true;
+            }
+        }
+        if (isPassTrivial) {
+            // All keys have the same digit, so the pass would not change the order.
+            continue;
+        }
+
+        // Scatter the pairs.
+#ifdef USE_TBB
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, numBlocks, 1), [&](auto const& r) {
+            for (auto blockIdx = r.begin(); blockIdx != r.end(); blockIdx++) {
+#else
+#if _OPENMP >= 201107
+        #pragma omp parallel for shared(keysSrc, keysDst, valuesSrc, valuesDst, N, numBlocks, blockOffsets, shift) \
+        default(none)
+#endif
+        for (size_t blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+#endif
+            std::array<size_t, RADIX_NUM_BUCKETS>& offsets = blockOffsets[blockIdx];
+            size_t blockStart = blockIdx * RADIX_SORT_BLOCK_SIZE;
+            size_t blockEnd = std::min(blockStart + RADIX_SORT_BLOCK_SIZE, N);
+            for (size_t i = blockStart; i < blockEnd; i++) {
+                size_t outputIdx = offsets[(keysSrc[i] >> shift) & (RADIX_NUM_BUCKETS - 1)]++;
+                keysDst[outputIdx] = keysSrc[i];
+                if (HasValues) {
+                    valuesDst[outputIdx] = valuesSrc[i];
+                }
+            }
+        }
+#ifdef USE_TBB
+        });
+#endif
+
+        std::swap(keysSrc, keysDst);
+        std::swap(valuesSrc, valuesDst);
+    }
+
+    if (keysSrc != keys.data()) {
+        keys.swap(keysTmp);
+        values.swap(valuesTmp);
+    }
+}
+
+void radixSortKeyValuePairs(std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int numKeyBits) {
+    radixSortKeyValuePairsImpl<uint64_t, true>(keys, values, numKeyBits);
+}
+
+void radixSortKeyValuePairs(std::vector<uint32_t>& keys, std::vector<uint32_t>& values, int numKeyBits) {
+    radixSortKeyValuePairsImpl<uint32_t, true>(keys, values, numKeyBits);
+}
+
+void radixSortKeys(std::vector<uint64_t>& keys, int numKeyBits) {
+    std::vector<uint32_t> values;
+    radixSortKeyValuePairsImpl<uint64_t, false>(keys, values, numKeyBits);
+}
+
+void radixSortKeys(std::vector<uint32_t>& keys, int numKeyBits) {
+    std::vector<uint32_t> values;
+    radixSortKeyValuePairsImpl<uint32_t, false>(keys, values, numKeyBits);
+}
+
+}
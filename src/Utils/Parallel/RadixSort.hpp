@@ -0,0 +1,59 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_RADIXSORT_HPP
+#define SGL_RADIXSORT_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace sgl {
+
+/**
+ * Parallel, stable LSD radix sort of key-value pairs (8 bits per pass). As the sort is stable, the result is identical
+ * regardless of the number of threads, and pairs with equal keys keep their relative order (e.g., the values can be
+ * the original indices of the keys).
+ * @param keys The keys to sort by.
+ * @param values The values to reorder together with the keys. Must have the same size as keys.
+ * @param numKeyBits Only the lower numKeyBits bits of the keys are considered (fewer passes for smaller key ranges).
+ */
+DLL_OBJECT void radixSortKeyValuePairs(
+        std::vector<uint64_t>& keys, std::vector<uint32_t>& values, int numKeyBits = 64);
+DLL_OBJECT void radixSortKeyValuePairs(
+        std::vector<uint32_t>& keys, std::vector<uint32_t>& values, int numKeyBits = 32);
+
+/**
+ * Parallel LSD radix sort of keys only (@see radixSortKeyValuePairs).
+ */
+DLL_OBJECT void radixSortKeys(std::vector<uint64_t>& keys, int numKeyBits = 64);
+DLL_OBJECT void radixSortKeys(std::vector<uint32_t>& keys, int numKeyBits = 32);
+
+}
+
+#endif //SGL_RADIXSORT_HPP
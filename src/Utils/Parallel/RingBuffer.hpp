@@ -0,0 +1,370 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_RINGBUFFER_HPP
+#define SGL_RINGBUFFER_HPP
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <new>
+#include <utility>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace sgl {
+
+/*
+ * Lock-free ring buffers with a power-of-two capacity for producer/consumer pipelines between threads.
+ * In contrast to CircularQueue (Utils/CircularQueue.hpp), which is not thread-safe, elements are moved instead of
+ * copied, can be constructed in place, and the indices of producers and consumers are kept on separate cache lines to
+ * avoid false sharing.
+ * - SpscRingBuffer: Exactly one producer thread and one consumer thread.
+ * - MpmcRingBuffer: Any number of producer and consumer threads (cf. D. Vyukov's bounded MPMC queue).
+ */
+
+static constexpr size_t RING_BUFFER_CACHE_LINE_SIZE = 64;
+
+/// How to wait in the blocking push/pop functions if the ring buffer is full/empty.
+enum class RingBufferWaitStrategy {
+    /// Busy waiting; lowest latency, but occupies a core.
+    SPIN,
+    /// Spins for a short time, then yields the time slice to other threads.
+    SPIN_THEN_YIELD,
+    /// Spins for a short time, then sleeps for increasing durations (up to 1ms).
+    SPIN_THEN_SLEEP
+};
+
+namespace detail {
+
+inline size_t roundUpToPowerOfTwo(size_t value) {
+    size_t powerOfTwo = 2;
+    while (powerOfTwo < value) {
+        powerOfTwo *= 2;
+    }
+    return powerOfTwo;
+}
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+class RingBufferWaiter {
+public:
+    explicit RingBufferWaiter(RingBufferWaitStrategy waitStrategy) : waitStrategy(waitStrategy) {}
+    void wait() {
+        if (waitStrategy == RingBufferWaitStrategy::SPIN || numIterations < 64) {
+            cpuRelax();
+        } else if (waitStrategy == RingBufferWaitStrategy::SPIN_THEN_YIELD || numIterations < 128) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(sleepTimeUs));
+            sleepTimeUs = std::min(sleepTimeUs * 2, 1000);
+        }
+        numIterations++;
+    }
+
+private:
+    RingBufferWaitStrategy waitStrategy;
+    int numIterations = 0;
+    int sleepTimeUs = 10;
+};
+
+}
+
+/**
+ * Lock-free single-producer single-consumer ring buffer. The producer functions (tryPush, tryEmplace, push) may only
+ * be called by one thread at a time, and the same holds for the consumer functions (tryPop, pop).
+ */
+template<class T>
+class SpscRingBuffer {
+public:
+    /// The capacity is rounded up to the next power of two.
+    explicit SpscRingBuffer(size_t capacity) {
+        ringCapacity = detail::roundUpToPowerOfTwo(capacity);
+        mask = ringCapacity - 1;
+        storage = static_cast<T*>(::operator new(sizeof(T) * ringCapacity, std::align_val_t(alignof(T))));
+    }
+
+    ~SpscRingBuffer() {
+        size_t readIdx = readIndex.load(std::memory_order_relaxed);
+        size_t writeIdx = writeIndex.load(std::memory_order_relaxed);
+        for (; readIdx != writeIdx; readIdx++) {
+            storage[readIdx & mask].~T();
+        }
+        ::operator delete(storage, std::align_val_t(alignof(T)));
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    /// Constructs an element in place. Returns false if the ring buffer is full.
+    template<class... Args>
+    bool tryEmplace(Args&&... args) {
+        const size_t writeIdx = writeIndex.load(std::memory_order_relaxed);
+        if (writeIdx - readIndexCached == ringCapacity) {
+            readIndexCached = readIndex.load(std::memory_order_acquire);
+            if (writeIdx - readIndexCached == ringCapacity) {
+                return false;
+            }
+        }
+        new(&storage[writeIdx & mask]) T(std::forward<Args>(args)...);
+        writeIndex.store(writeIdx + 1, std::memory_order_release);
+        return true;
+    }
+    bool tryPush(const T& value) { return tryEmplace(value); }
+    bool tryPush(T&& value) { return tryEmplace(std::move(value)); }
+
+    /// Waits until there is space in the ring buffer.
+    template<class... Args>
+    void emplace(Args&&... args) {
+        detail::RingBufferWaiter waiter(RingBufferWaitStrategy::SPIN_THEN_YIELD);
+        while (!tryEmplace(std::forward<Args>(args)...)) {
+            waiter.wait();
+        }
+    }
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    /// Returns false if the ring buffer is empty.
+    bool tryPop(T& value) {
+        const size_t readIdx = readIndex.load(std::memory_order_relaxed);
+        if (readIdx == writeIndexCached) {
+            writeIndexCached = writeIndex.load(std::memory_order_acquire);
+            if (readIdx == writeIndexCached) {
+                return false;
+            }
+        }
+        T& element = storage[readIdx & mask];
+        value = std::move(element);
+        element.~T();
+        readIndex.store(readIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Waits until an element is available.
+    void pop(T& value, RingBufferWaitStrategy waitStrategy = RingBufferWaitStrategy::SPIN_THEN_YIELD) {
+        detail::RingBufferWaiter waiter(waitStrategy);
+        while (!tryPop(value)) {
+            waiter.wait();
+        }
+    }
+
+    /// Waits until an element is available or the timeout has passed.
+    template<class Rep, class Period>
+    bool tryPopFor(
+            T& value, const std::chrono::duration<Rep, Period>& timeout,
+            RingBufferWaitStrategy waitStrategy = RingBufferWaitStrategy::SPIN_THEN_SLEEP) {
+        auto endTime = std::chrono::steady_clock::now() + timeout;
+        detail::RingBufferWaiter waiter(waitStrategy);
+        while (!tryPop(value)) {
+            if (std::chrono::steady_clock::now() >= endTime) {
+                return false;
+            }
+            waiter.wait();
+        }
+        return true;
+    }
+
+    /// Only approximate if the producer or consumer are active concurrently.
+    [[nodiscard]] size_t size() const {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] inline size_t capacity() const { return ringCapacity; }
+
+private:
+    T* storage = nullptr;
+    size_t ringCapacity = 0;
+    size_t mask = 0;
+
+    // Written by the producer.
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<size_t> writeIndex{0};
+    size_t readIndexCached = 0;
+    // Written by the consumer.
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<size_t> readIndex{0};
+    size_t writeIndexCached = 0;
+    uint8_t padding[RING_BUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) - sizeof(size_t)]{};
+};
+
+/**
+ * Lock-free multi-producer multi-consumer ring buffer. Every slot stores a sequence number that tells producers and
+ * consumers whether the slot is free or filled in the current round, so producers (and consumers) only contend on a
+ * single atomic index.
+ */
+template<class T>
+class MpmcRingBuffer {
+public:
+    /// The capacity is rounded up to the next power of two.
+    explicit MpmcRingBuffer(size_t capacity) {
+        ringCapacity = detail::roundUpToPowerOfTwo(capacity);
+        mask = ringCapacity - 1;
+        slots = new Slot[ringCapacity];
+        for (size_t i = 0; i < ringCapacity; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcRingBuffer() {
+        size_t dequeuePos = dequeuePosition.load(std::memory_order_relaxed);
+        size_t enqueuePos = enqueuePosition.load(std::memory_order_relaxed);
+        for (; dequeuePos != enqueuePos; dequeuePos++) {
+            Slot& slot = slots[dequeuePos & mask];
+            if (slot.sequence.load(std::memory_order_relaxed) == dequeuePos + 1) {
+                slot.getElement().~T();
+            }
+        }
+        delete[] slots;
+    }
+
+    MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+    MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+    /// Constructs an element in place. Returns false if the ring buffer is full.
+    template<class... Args>
+    bool tryEmplace(Args&&... args) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = intptr_t(sequence) - intptr_t(position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        new(slot->data) T(std::forward<Args>(args)...);
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    bool tryPush(const T& value) { return tryEmplace(value); }
+    bool tryPush(T&& value) { return tryEmplace(std::move(value)); }
+
+    /// Waits until there is space in the ring buffer.
+    template<class... Args>
+    void emplace(Args&&... args) {
+        detail::RingBufferWaiter waiter(RingBufferWaitStrategy::SPIN_THEN_YIELD);
+        while (!tryEmplace(std::forward<Args>(args)...)) {
+            waiter.wait();
+        }
+    }
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    /// Returns false if the ring buffer is empty.
+    bool tryPop(T& value) {
+        size_t position = dequeuePosition.load(std::memory_order_relaxed);
+        Slot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            auto difference = intptr_t(sequence) - intptr_t(position + 1);
+            if (difference == 0) {
+                if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        T& element = slot->getElement();
+        value = std::move(element);
+        element.~T();
+        slot->sequence.store(position + ringCapacity, std::memory_order_release);
+        return true;
+    }
+
+    /// Waits until an element is available.
+    void pop(T& value, RingBufferWaitStrategy waitStrategy = RingBufferWaitStrategy::SPIN_THEN_YIELD) {
+        detail::RingBufferWaiter waiter(waitStrategy);
+        while (!tryPop(value)) {
+            waiter.wait();
+        }
+    }
+
+    /// Waits until an element is available or the timeout has passed.
+    template<class Rep, class Period>
+    bool tryPopFor(
+            T& value, const std::chrono::duration<Rep, Period>& timeout,
+            RingBufferWaitStrategy waitStrategy = RingBufferWaitStrategy::SPIN_THEN_SLEEP) {
+        auto endTime = std::chrono::steady_clock::now() + timeout;
+        detail::RingBufferWaiter waiter(waitStrategy);
+        while (!tryPop(value)) {
+            if (std::chrono::steady_clock::now() >= endTime) {
+                return false;
+            }
+            waiter.wait();
+        }
+        return true;
+    }
+
+    /// Only approximate if producers or consumers are active concurrently.
+    [[nodiscard]] size_t size() const {
+        size_t enqueuePos = enqueuePosition.load(std::memory_order_acquire);
+        size_t dequeuePos = dequeuePosition.load(std::memory_order_acquire);
+        return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+    }
+    [[nodiscard]] bool empty() const { return size() == 0; }
+    [[nodiscard]] inline size_t capacity() const { return ringCapacity; }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        alignas(T) uint8_t data[sizeof(T)];
+        inline T& getElement() { return *std::launder(reinterpret_cast<T*>(data)); }
+    };
+    Slot* slots = nullptr;
+    size_t ringCapacity = 0;
+    size_t mask = 0;
+
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<size_t> enqueuePosition{0};
+    alignas(RING_BUFFER_CACHE_LINE_SIZE) std::atomic<size_t> dequeuePosition{0};
+    uint8_t padding[RING_BUFFER_CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)]{};
+};
+
+}
+
+#endif //SGL_RINGBUFFER_HPP
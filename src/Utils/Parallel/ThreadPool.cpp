@@ -0,0 +1,102 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include <Utils/File/Logfile.hpp>
+#include "ThreadPool.hpp"
+
+namespace sgl {
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    if (numThreads == 0) {
+        numThreads = std::max(size_t(std::thread::hardware_concurrency()), size_t(1));
+    }
+    workerThreads.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; i++) {
+        workerThreads.emplace_back(&ThreadPool::workerFunction, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        isRunning = false;
+        taskQueue.clear();
+    }
+    hasTaskCondition.notify_all();
+    for (std::thread& workerThread : workerThreads) {
+        workerThread.join();
+    }
+}
+
+void ThreadPool::push(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        taskQueue.push_back(std::move(task));
+    }
+    hasTaskCondition.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    isIdleCondition.wait(lock, [this] { return taskQueue.empty() && numTasksRunning == 0; });
+}
+
+void ThreadPool::workerFunction() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            hasTaskCondition.wait(lock, [this] { return !isRunning || !taskQueue.empty(); });
+            if (!isRunning) {
+                break;
+            }
+            task = std::move(taskQueue.front());
+            taskQueue.pop_front();
+            numTasksRunning++;
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            sgl::Logfile::get()->writeError(
+                    std::string() + "Error in ThreadPool::workerFunction: Uncaught exception: " + e.what(), false);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            numTasksRunning--;
+            if (taskQueue.empty() && numTasksRunning == 0) {
+                isIdleCondition.notify_all();
+            }
+        }
+    }
+}
+
+}
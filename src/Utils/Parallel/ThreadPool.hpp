@@ -0,0 +1,89 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2023, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SGL_THREADPOOL_HPP
+#define SGL_THREADPOOL_HPP
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+
+namespace sgl {
+
+/**
+ * A simple pool of worker threads executing tasks in FIFO order.
+ * In contrast to the TBB/OpenMP code paths used for data-parallel loops, this pool is meant for long-running or
+ * blocking background work, e.g., file I/O, which should not occupy the threads of the compute runtime.
+ */
+class DLL_OBJECT ThreadPool {
+public:
+    /// @param numThreads The number of worker threads. 0 means std::thread::hardware_concurrency().
+    explicit ThreadPool(size_t numThreads = 0);
+    /// Waits for running tasks to finish. Tasks that have not started yet are discarded.
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] inline size_t getNumThreads() const { return workerThreads.size(); }
+
+    /// Adds a task to the queue.
+    void push(std::function<void()> task);
+
+    /// Adds a task to the queue and returns a future for its result.
+    template<class Func>
+    auto submit(Func&& func) -> std::future<decltype(func())> {
+        using ReturnType = decltype(func());
+        auto task = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(func));
+        std::future<ReturnType> future = task->get_future();
+        push([task]() { (*task)(); });
+        return future;
+    }
+
+    /// Blocks until the task queue is empty and no task is running anymore.
+    void waitIdle();
+
+private:
+    void workerFunction();
+
+    std::vector<std::thread> workerThreads;
+    std::deque<std::function<void()>> taskQueue;
+    std::mutex queueMutex;
+    std::condition_variable hasTaskCondition;
+    std::condition_variable isIdleCondition;
+    size_t numTasksRunning = 0;
+    bool isRunning = true;
+};
+
+}
+
+#endif //SGL_THREADPOOL_HPP
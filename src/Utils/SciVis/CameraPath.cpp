@@ -106,7 +106,7 @@ bool CameraPath::fromBinaryFile(const std::string& filename) {
     file.read(buffer, size);
     file.close();
 
-    sgl::BinaryReadStream stream(buffer, size);
+    sgl::BinaryReadStream stream(buffer, size, sgl::StreamBufferOwnership::TAKE);
     uint32_t version;
     stream.read(version);
     if (version != CAMERA_PATH_FORMAT_VERSION) {
@@ -134,7 +134,9 @@ bool CameraPath::saveToBinaryFile(const std::string& filename) {
     sgl::BinaryWriteStream stream;
     stream.write((uint32_t)CAMERA_PATH_FORMAT_VERSION);
     stream.writeArray(controlPoints);
-    file.write((const char*)stream.getBuffer(), stream.getSize());
+    stream.forEachSegment([&file](const uint8_t* data, size_t size) {
+        file.write((const char*)data, std::streamsize(size));
+    });
     file.close();
 
     return true;